@@ -0,0 +1,35 @@
+#include <Argon2Engine.h>
+#include <Generator.h>
+
+#include "Benchmark.h"
+
+// The in-library Argon2id engine per kernel against libsodium, at the interactive cost (64 MiB) where allocating and
+// faulting fresh memory for every hash shows, and at the minimum cost where it doesn't.
+BENCHMARK_GROUP(argon2)
+{
+    const std::string password = "<PASSWORD1?2.3!4@hello>";
+    const std::pair<Generator::HashCost, const char*> costs[] = {
+        { Generator::HashCost{crypto_pwhash_OPSLIMIT_INTERACTIVE, crypto_pwhash_MEMLIMIT_INTERACTIVE}, "64MiB" },
+        { Generator::HashCost{crypto_pwhash_OPSLIMIT_MIN, crypto_pwhash_MEMLIMIT_MIN}, "8KiB" } };
+
+    const Generator::HashingBackend& libsodium = Generator::GetHashingBackend(Generator::HashAlgorithm::Argon2id);
+    for (const auto& [cost, costName] : costs)
+    {
+        results.push_back({ std::string("libsodium/") + costName, Benchmark::MeasureThroughput([&]() {
+            (void)libsodium.Hash(password, cost);
+            return 1;
+        }), "hash/s" });
+
+        for (const Generator::Argon2Kernel kernel : {Generator::Argon2Kernel::Portable, Generator::Argon2Kernel::Sse41, Generator::Argon2Kernel::Avx2})
+        {
+            if (!Generator::IsArgon2KernelSupported(kernel))
+                continue;
+            const Generator::Argon2Engine engine(kernel);
+            Generator::Argon2Arena arena;
+            results.push_back({ std::string("engine ") + Generator::Argon2KernelName(kernel) + "/" + costName, Benchmark::MeasureThroughput([&]() {
+                (void)engine.HashString(arena, password, Generator::Argon2Params::FromHashCost(cost));
+                return 1;
+            }), "hash/s" });
+        }
+    }
+}
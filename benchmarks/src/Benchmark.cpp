@@ -0,0 +1,210 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+std::vector<std::pair<std::string, Benchmark::Group>>& Benchmark::Groups()
+{
+    // function-local so registrars in other translation units never see it uninitialized
+    static std::vector<std::pair<std::string, Group>> s_Groups;
+    return s_Groups;
+}
+
+size_t Benchmark::PeakResidentBytes()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return counters.PeakWorkingSetSize;
+    return 0;
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss;         // bytes on macOS
+#else
+    return (size_t)usage.ru_maxrss * 1024;  // KiB on Linux
+#endif
+#endif
+}
+
+namespace
+{
+    std::string Escape(const std::string& text)
+    {
+        std::string escaped;
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')
+                escaped.push_back('\\');
+            escaped.push_back(c);
+        }
+        return escaped;
+    }
+
+    /// Just enough of a JSON reader for WriteJson()'s output: objects, arrays, strings and numbers.
+    class JsonScanner
+    {
+    public:
+        explicit JsonScanner(std::string text) : text(std::move(text)) {}
+
+        void Expect(char c)
+        {
+            SkipSpace();
+            if (position >= text.size() || text[position] != c)
+                throw std::runtime_error(std::string("Malformed benchmark JSON, expected '") + c + "'");
+            position++;
+        }
+
+        bool Consume(char c)
+        {
+            SkipSpace();
+            if (position < text.size() && text[position] == c)
+            {
+                position++;
+                return true;
+            }
+            return false;
+        }
+
+        std::string String()
+        {
+            Expect('"');
+            std::string value;
+            while (position < text.size() && text[position] != '"')
+            {
+                if (text[position] == '\\')
+                    position++;
+                if (position < text.size())
+                    value.push_back(text[position++]);
+            }
+            Expect('"');
+            return value;
+        }
+
+        double Number()
+        {
+            SkipSpace();
+            size_t used = 0;
+            const double value = std::stod(text.substr(position), &used);
+            position += used;
+            return value;
+        }
+
+        bool NextIsString()
+        {
+            SkipSpace();
+            return position < text.size() && text[position] == '"';
+        }
+
+    private:
+        void SkipSpace()
+        {
+            while (position < text.size() && std::isspace((unsigned char)text[position]))
+                position++;
+        }
+
+        std::string text;
+        size_t position = 0;
+    };
+}
+
+void Benchmark::WriteJson(std::ostream& out, const std::vector<Record>& records)
+{
+    out << "{\n  \"results\": [";
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        const Record& record = records[i];
+        out << (i == 0 ? "\n" : ",\n") << "    { \"group\": \"" << Escape(record.group) << "\", \"name\": \""
+            << Escape(record.result.name) << "\", \"value\": " << std::fixed << std::setprecision(2)
+            << record.result.value << ", \"unit\": \"" << Escape(record.result.unit) << "\" }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+std::vector<Benchmark::Record> Benchmark::ReadJson(std::istream& in)
+{
+    JsonScanner json(std::string(std::istreambuf_iterator<char>(in), {}));
+    std::vector<Record> records;
+
+    json.Expect('{');
+    if (json.String() != "results")
+        throw std::runtime_error("Malformed benchmark JSON, expected \"results\"");
+    json.Expect(':');
+    json.Expect('[');
+    while (!json.Consume(']'))
+    {
+        json.Consume(',');
+        json.Expect('{');
+        Record record;
+        while (!json.Consume('}'))
+        {
+            json.Consume(',');
+            const std::string key = json.String();
+            json.Expect(':');
+            if (key == "value")
+                record.result.value = json.Number();
+            else if (!json.NextIsString())
+                throw std::runtime_error("Malformed benchmark JSON, unexpected value for " + key);
+            else if (key == "group")
+                record.group = json.String();
+            else if (key == "name")
+                record.result.name = json.String();
+            else if (key == "unit")
+                record.result.unit = json.String();
+            else
+                (void)json.String();
+        }
+        records.push_back(std::move(record));
+    }
+    json.Expect('}');
+    return records;
+}
+
+std::vector<std::string> Benchmark::FindRegressions(const std::vector<Record>& current,
+                                                    const std::vector<Record>& baseline, double tolerance)
+{
+    std::vector<std::string> regressions;
+    for (const Record& expected : baseline)
+    {
+        const std::string& unit = expected.result.unit;
+        if (unit.size() < 2 || unit.compare(unit.size() - 2, 2, "/s") != 0)
+            continue;
+
+        const std::string label = expected.group + "/" + expected.result.name;
+        const auto found = std::find_if(current.begin(), current.end(), [&](const Record& record) {
+            return record.group == expected.group && record.result.name == expected.result.name;
+        });
+        if (found == current.end())
+        {
+            regressions.push_back(label + ": missing from this run");
+            continue;
+        }
+
+        const double floor = expected.result.value * (1.0 - tolerance);
+        if (found->result.value < floor)
+        {
+            std::ostringstream line;
+            line << label << ": " << std::fixed << std::setprecision(2) << found->result.value << " " << unit
+                 << " is below " << floor << " (baseline " << expected.result.value << ", tolerance "
+                 << tolerance * 100 << "%)";
+            regressions.push_back(line.str());
+        }
+    }
+    return regressions;
+}
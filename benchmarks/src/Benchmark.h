@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+
+/// A tiny benchmark harness, no dependencies beyond the standard library. Each benchmark group is a function that
+/// appends named results. Groups register themselves with BENCHMARK_GROUP and are picked by name on the command line.
+namespace Benchmark
+{
+    struct Result
+    {
+        std::string name;
+        double value = 0.0;
+        std::string unit;
+    };
+
+    /// A result tagged with the group that produced it, as written to and read from JSON reports.
+    struct Record
+    {
+        std::string group;
+        Result result;
+    };
+
+    using Group = std::function<void(std::vector<Result>&)>;
+
+    [[nodiscard]] std::vector<std::pair<std::string, Group>>& Groups();
+
+    struct Registrar
+    {
+        Registrar(std::string name, Group group) { Groups().emplace_back(std::move(name), std::move(group)); }
+    };
+
+    /**
+     * Calls work repeatedly until at least minTime has passed.
+     * @param work Does one round of work and returns how many operations it performed.
+     * @returns Operations per second.
+     */
+    template<typename F>
+    double MeasureThroughput(F&& work, std::chrono::duration<double> minTime = std::chrono::milliseconds(500))
+    {
+        using Clock = std::chrono::steady_clock;
+        double operations = 0.0;
+        const auto start = Clock::now();
+        auto elapsed = Clock::duration::zero();
+        do
+        {
+            operations += (double)work();
+            elapsed = Clock::now() - start;
+        } while (elapsed < minTime);
+        return operations / std::chrono::duration<double>(elapsed).count();
+    }
+
+    /// Peak resident set size of this process so far, in bytes. 0 where unsupported.
+    [[nodiscard]] size_t PeakResidentBytes();
+
+    /// Writes records as {"results": [{"group", "name", "value", "unit"}, ...]}.
+    void WriteJson(std::ostream& out, const std::vector<Record>& records);
+
+    /// Reads what WriteJson() writes. Only understands that layout.
+    /// @throws std::runtime_error on malformed input.
+    [[nodiscard]] std::vector<Record> ReadJson(std::istream& in);
+
+    /**
+     * Compares rates (units ending in "/s") against a baseline. Results the baseline doesn't list are ignored, baseline
+     * entries missing from the current run count as failures.
+     * @param tolerance Allowed drop as a fraction of the baseline, e.g. 0.2 fails anything more than 20% slower.
+     * @returns One line per regression; empty if there is none.
+     */
+    [[nodiscard]] std::vector<std::string> FindRegressions(const std::vector<Record>& current,
+                                                           const std::vector<Record>& baseline, double tolerance);
+}
+
+#define BENCHMARK_GROUP(name) \
+    static void name##_Run(std::vector<Benchmark::Result>& results); \
+    static const Benchmark::Registrar name##_Registrar(#name, &name##_Run); \
+    static void name##_Run(std::vector<Benchmark::Result>& results)
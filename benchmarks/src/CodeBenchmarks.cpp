@@ -0,0 +1,30 @@
+#include <CodeGenerator.h>
+
+#include "Benchmark.h"
+
+// Numeric PIN throughput: the general policy path against the dedicated code generator, counted in digits.
+BENCHMARK_GROUP(codes)
+{
+    constexpr size_t batch = 1'000'000;
+    constexpr size_t length = 6;
+
+    const Generator::PasswordGenerator policyGenerator(Generator::PasswordPolicy{length, false, false, true, false});
+    results.push_back({ "policy pins", Benchmark::MeasureThroughput([&]() {
+        const auto pins = policyGenerator.GenerateAdvancedPasswords((int)batch);
+        return pins.size() * length;
+    }), "digits/s" });
+
+    const Generator::CodeGenerator codeGenerator(length);
+    std::vector<char> packed(batch * length);
+    results.push_back({ "code generator pins", Benchmark::MeasureThroughput([&]() {
+        codeGenerator.Fill(packed.data(), batch);
+        return batch * length;
+    }), "digits/s" });
+
+    const Generator::CodeGenerator luhnGenerator(length, Generator::s_NumbersChars, Generator::CheckDigit::Luhn);
+    std::vector<char> packedLuhn(batch * luhnGenerator.CodeLength());
+    results.push_back({ "code generator pins + luhn", Benchmark::MeasureThroughput([&]() {
+        luhnGenerator.Fill(packedLuhn.data(), batch);
+        return batch * length;
+    }), "digits/s" });
+}
@@ -0,0 +1,23 @@
+#include <PasswordFile.h>
+
+#include <filesystem>
+
+#include "Benchmark.h"
+
+#if !defined(_WIN32)
+// Provisioning-file throughput: generation straight into a preallocated, memory mapped file on all hardware threads.
+BENCHMARK_GROUP(file)
+{
+    constexpr uint64_t batch = 2'000'000;
+    const Generator::PasswordGenerator generator(Generator::PasswordPolicy{16});
+    const std::filesystem::path path = std::filesystem::temp_directory_path() / "passwordgen-benchmark.txt";
+
+    Generator::PasswordFileOptions options;
+    options.overwrite = true;
+    results.push_back({ "mmap file length 16", Benchmark::MeasureThroughput([&]() {
+        Generator::WritePasswordFile(generator, path.string(), batch, options);
+        return batch;
+    }), "pw/s" });
+    std::filesystem::remove(path);
+}
+#endif
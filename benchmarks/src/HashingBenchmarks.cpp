@@ -0,0 +1,43 @@
+#include <Generator.h>
+
+#include "Benchmark.h"
+
+// Throughput and memory of every hashing backend at Low and Medium strength. High is left out on purpose: at ~1 GiB
+// and seconds per hash it measures the machine's RAM more than the backend.
+BENCHMARK_GROUP(hashing)
+{
+    const Generator::HashAlgorithm algorithms[] = {
+        Generator::HashAlgorithm::Argon2id, Generator::HashAlgorithm::Argon2i, Generator::HashAlgorithm::Scrypt };
+    const std::pair<Generator::EncryptionStrength, const char*> strengths[] = {
+        { Generator::EncryptionStrength::Low, "low" }, { Generator::EncryptionStrength::Medium, "medium" } };
+
+    const std::string password = "<PASSWORD1?2.3!4@hello>";
+
+    for (const auto algorithm : algorithms)
+    {
+        const auto& backend = Generator::GetHashingBackend(algorithm);
+        for (const auto& [strength, strengthName] : strengths)
+        {
+            Generator::PasswordPolicy policy;
+            policy.hashAlgorithm = algorithm;
+            policy.encryptionStrength = strength;
+            const Generator::PasswordGenerator generator(policy);
+            const std::string prefix = std::string(backend.Name()) + "/" + strengthName;
+
+            std::string hash;
+            const double hashRate = Benchmark::MeasureThroughput([&]() {
+                hash = generator.HashPassword(password);
+                return 1;
+            });
+            const double verifyRate = Benchmark::MeasureThroughput([&]() {
+                return generator.VerifyPassword(password, hash) ? 1 : 0;
+            });
+
+            results.push_back({ prefix + " hash", hashRate, "hash/s" });
+            results.push_back({ prefix + " verify", verifyRate, "verify/s" });
+            results.push_back({ prefix + " memory", (double)Generator::MemoryCostOfHash(hash) / (1024.0 * 1024.0), "MiB/hash" });
+        }
+    }
+
+    results.push_back({ "peak resident", (double)Benchmark::PeakResidentBytes() / (1024.0 * 1024.0), "MiB" });
+}
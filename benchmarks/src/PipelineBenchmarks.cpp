@@ -0,0 +1,21 @@
+#include <HashPipeline.h>
+
+#include "Benchmark.h"
+
+// End-to-end generate+hash throughput: the two-step vector composition against the overlapped pipeline.
+BENCHMARK_GROUP(pipeline)
+{
+    constexpr int batch = 2000;
+    const Generator::PasswordGenerator generator(Generator::PasswordPolicy{16, true, true, true, true, "", Generator::EncryptionStrength::Low});
+
+    results.push_back({ "generate then hash", Benchmark::MeasureThroughput([&]() {
+        const auto hashes = generator.HashPasswordsSafe(generator.GenerateAdvancedPasswords(batch));
+        return hashes.size();
+    }), "pw/s" });
+
+    const Generator::HashPipeline pipeline(generator);
+    results.push_back({ "pipelined", Benchmark::MeasureThroughput([&]() {
+        const auto hashes = pipeline.GenerateHashes(batch);
+        return hashes.size();
+    }), "pw/s" });
+}
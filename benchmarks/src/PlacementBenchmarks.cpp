@@ -0,0 +1,20 @@
+#include <WorkerPlacement.h>
+
+#include "Benchmark.h"
+
+// Hashes/sec against worker count at Medium strength (64 MiB per hash), where memory bandwidth rather than core count
+// decides how far hashing scales. Also reports the worker count CalibrateWorkers() would pick.
+BENCHMARK_GROUP(placement)
+{
+    const Generator::PasswordGenerator generator(Generator::PasswordPolicy{16, true, true, true, true, "", Generator::EncryptionStrength::Medium});
+    const Generator::WorkerPlacement placement;
+    const unsigned maxWorkers = (unsigned)placement.Topology().cpus.size();
+
+    const auto calibration = placement.CalibrateWorkers(generator, maxWorkers);
+    for (const auto& [workers, rate] : calibration.samples)
+        results.push_back({ "pinned workers=" + std::to_string(workers), rate, "hash/s" });
+
+    results.push_back({ "physical cores", (double)placement.Topology().PhysicalCores(), "cores" });
+    results.push_back({ "numa nodes", (double)placement.Topology().nodeCount, "nodes" });
+    results.push_back({ "recommended workers", (double)calibration.recommendedWorkers, "workers" });
+}
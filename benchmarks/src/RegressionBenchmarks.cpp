@@ -0,0 +1,36 @@
+#include <Generator.h>
+
+#include "Benchmark.h"
+
+// Fixed workloads checked against benchmarks/baselines/regression.json by the benchmark_regression CTest. Renaming a
+// result or changing its workload means regenerating the baseline.
+BENCHMARK_GROUP(regression)
+{
+    constexpr int batch = 10000;
+
+    for (const uint64_t length : { 8u, 16u, 64u })
+    {
+        const Generator::PasswordGenerator generator(Generator::PasswordPolicy{length});
+        results.push_back({ "generate length " + std::to_string(length), Benchmark::MeasureThroughput([&]() {
+            return generator.GenerateAdvancedPasswords(batch).size();
+        }), "pw/s" });
+    }
+
+    const Generator::PasswordGenerator generator(Generator::PasswordPolicy{16, true, true, true, true, "", Generator::EncryptionStrength::Low});
+    results.push_back({ "generate async length 16", Benchmark::MeasureThroughput([&]() {
+        auto first = generator.GenerateAdvancedPasswordsAsync(batch / 2);
+        auto second = generator.GenerateAdvancedPasswordsAsync(batch / 2);
+        return first.get().size() + second.get().size();
+    }), "pw/s" });
+
+    const std::string password = "<PASSWORD1?2.3!4@hello>";
+    std::string hash;
+    results.push_back({ "hash low", Benchmark::MeasureThroughput([&]() {
+        hash = generator.HashPassword(password);
+        return 1;
+    }), "hash/s" });
+
+    results.push_back({ "verify low", Benchmark::MeasureThroughput([&]() {
+        return generator.VerifyPassword(password, hash) ? 1 : 0;
+    }), "verify/s" });
+}
@@ -0,0 +1,41 @@
+#include <TenantRegistry.h>
+
+#include <thread>
+
+#include "Benchmark.h"
+
+// Generation through the tenant registry with a few thousand tenants against a generator used directly, to show the
+// lookup costs next to nothing and doesn't serialize threads.
+BENCHMARK_GROUP(tenants)
+{
+    constexpr int tenants = 5000;
+    constexpr int perThread = 200000;
+
+    Generator::TenantRegistry registry;
+    std::vector<std::pair<std::string, Generator::PasswordPolicy>> policies;
+    for (int i = 0; i < tenants; i++)
+        policies.emplace_back("tenant-" + std::to_string(i), Generator::PasswordPolicy{12, true, true, true, true, std::string(1, (char)('a' + i % 26))});
+    registry.SetTenantPolicies(policies);
+
+    const Generator::PasswordGenerator direct(Generator::PasswordPolicy{12});
+    results.push_back({ "direct", Benchmark::MeasureThroughput([&]() {
+        for (int i = 0; i < perThread; i++)
+            (void)direct.GenerateAdvancedPassword();
+        return (size_t)perThread;
+    }), "pw/s" });
+
+    const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    results.push_back({ "registry x" + std::to_string(threads) + " threads", Benchmark::MeasureThroughput([&]() {
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; t++)
+        {
+            workers.emplace_back([&, t]() {
+                for (int i = 0; i < perThread; i++)
+                    (void)registry.GenerateAdvancedPassword(policies[(t * 7919 + (unsigned)i) % tenants].first);
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+        return (size_t)perThread * threads;
+    }), "pw/s" });
+}
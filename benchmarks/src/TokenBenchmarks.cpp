@@ -0,0 +1,48 @@
+#include <algorithm>
+
+#include <HashingBackend.h>
+#include <TokenService.h>
+
+#include "Benchmark.h"
+
+// API token issue/verify rates on one core, with a plain keyed crypto_generichash() call and the cheapest argon2id hash
+// for scale.
+BENCHMARK_GROUP(tokens)
+{
+    constexpr size_t batch = 200000;
+
+    const Generator::TokenService service(Generator::TokenService::GeneratePepper());
+    std::vector<char> packed(batch * Generator::TokenService::s_TokenLength);
+    results.push_back({ "generate", Benchmark::MeasureThroughput([&]() {
+        service.FillTokens(packed.data(), batch);
+        return batch;
+    }), "tokens/s" });
+
+    const std::vector<std::string> tokens = service.GenerateTokens(batch);
+    std::vector<Generator::TokenDigest> digests;
+    results.push_back({ "hash", Benchmark::MeasureThroughput([&]() {
+        digests = service.HashTokens(tokens);
+        return batch;
+    }), "tokens/s" });
+
+    const std::vector<uint8_t> pepper = Generator::TokenService::GeneratePepper();
+    results.push_back({ "crypto_generichash", Benchmark::MeasureThroughput([&]() {
+        Generator::TokenDigest digest;
+        for (const std::string& token : tokens)
+            crypto_generichash(digest.data(), digest.size(), (const unsigned char*)token.data(), token.size(), pepper.data(), pepper.size());
+        return batch;
+    }), "tokens/s" });
+
+    results.push_back({ "verify", Benchmark::MeasureThroughput([&]() {
+        const std::vector<bool> verified = service.VerifyTokens(tokens, digests);
+        return (size_t)std::count(verified.begin(), verified.end(), true);
+    }), "tokens/s" });
+
+    const Generator::HashingBackend& argon2 = Generator::GetHashingBackend(Generator::HashAlgorithm::Argon2id);
+    const Generator::HashCost minimum{crypto_pwhash_argon2id_OPSLIMIT_MIN, crypto_pwhash_argon2id_MEMLIMIT_MIN};
+    results.push_back({ "argon2id minimum cost", Benchmark::MeasureThroughput([&]() {
+        for (size_t i = 0; i < 100; i++)
+            (void)argon2.Hash(tokens[i], minimum);
+        return (size_t)100;
+    }), "tokens/s" });
+}
@@ -0,0 +1,41 @@
+#include <Generator.h>
+#include <Trace.h>
+
+#include "Benchmark.h"
+
+// What a trace span costs while tracing is off and on, and what tracing costs the cheapest hash.
+BENCHMARK_GROUP(trace)
+{
+    constexpr size_t batch = 1000000;
+
+    Generator::Trace::Disable();
+    results.push_back({ "span disabled", Benchmark::MeasureThroughput([&]() {
+        for (size_t i = 0; i < batch; i++)
+            const Generator::Trace::Span span("benchmark", "span");
+        return batch;
+    }), "spans/s" });
+
+    Generator::Trace::Enable();
+    results.push_back({ "span enabled", Benchmark::MeasureThroughput([&]() {
+        for (size_t i = 0; i < batch; i++)
+            const Generator::Trace::Span span("benchmark", "span");
+        return batch;
+    }), "spans/s" });
+
+    const Generator::PasswordGenerator generator(
+        Generator::PasswordPolicy{16, true, true, true, true, "", Generator::EncryptionStrength::Low});
+    const std::string password = generator.GenerateAdvancedPassword();
+    results.push_back({ "argon2id minimum cost, traced", Benchmark::MeasureThroughput([&]() {
+        for (size_t i = 0; i < 100; i++)
+            (void)generator.HashPassword(password);
+        return (size_t)100;
+    }), "hashes/s" });
+
+    Generator::Trace::Disable();
+    Generator::Trace::Clear();
+    results.push_back({ "argon2id minimum cost", Benchmark::MeasureThroughput([&]() {
+        for (size_t i = 0; i < 100; i++)
+            (void)generator.HashPassword(password);
+        return (size_t)100;
+    }), "hashes/s" });
+}
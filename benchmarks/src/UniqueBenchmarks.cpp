@@ -0,0 +1,21 @@
+#include <Generator.h>
+
+#include "Benchmark.h"
+
+// Cost of the uniqueness guarantee: plain bulk generation against duplicate-free generation of the same codes.
+BENCHMARK_GROUP(unique)
+{
+    constexpr size_t batch = 1'000'000;
+    const Generator::PasswordGenerator generator(Generator::PasswordPolicy{10, false, false, true, false});
+
+    results.push_back({ "plain", Benchmark::MeasureThroughput([&]() {
+        const auto codes = generator.GenerateAdvancedPasswords((int)batch);
+        return codes.size();
+    }), "pw/s" });
+
+    std::vector<char> packed(batch * generator.GetPolicy().passwordLength);
+    results.push_back({ "unique packed", Benchmark::MeasureThroughput([&]() {
+        generator.GenerateUniqueAdvancedPasswordsInto(packed.data(), batch);
+        return batch;
+    }), "pw/s" });
+}
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sodium.h>
+
+#include "Benchmark.h"
+
+// usage: benchmarks [group...] [--json <file>] [--baseline <file>] [--tolerance <fraction>]
+// Runs every registered group, or only the named ones. --json writes the results, --baseline fails the run (exit code
+// 1) if any rate in the baseline dropped by more than the tolerance (default 0.2).
+int main(int argc, char** argv)
+{
+    if (sodium_init() == -1)
+    {
+        std::cerr << "Failed to initialize libsodium" << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> selected;
+    std::string jsonPath, baselinePath;
+    double tolerance = 0.2;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--json" && hasValue)
+            jsonPath = argv[++i];
+        else if (arg == "--baseline" && hasValue)
+            baselinePath = argv[++i];
+        else if (arg == "--tolerance" && hasValue)
+            tolerance = std::stod(argv[++i]);
+        else if (arg.starts_with("--"))
+        {
+            std::cerr << "Unknown or incomplete option " << arg << std::endl;
+            return -1;
+        }
+        else
+            selected.push_back(arg);
+    }
+
+    std::vector<Benchmark::Record> records;
+    for (const auto& [name, group] : Benchmark::Groups())
+    {
+        if (!selected.empty() && std::ranges::find(selected, name) == selected.end())
+            continue;
+
+        std::cout << "== " << name << " ==" << std::endl;
+        std::vector<Benchmark::Result> results;
+        group(results);
+        for (const auto& result : results)
+        {
+            std::cout << "  " << std::left << std::setw(44) << result.name << std::right << std::setw(16) << std::fixed
+                      << std::setprecision(2) << result.value << " " << result.unit << std::endl;
+            records.push_back({ name, result });
+        }
+    }
+
+    if (!jsonPath.empty())
+    {
+        std::ofstream json(jsonPath);
+        Benchmark::WriteJson(json, records);
+        if (!json)
+        {
+            std::cerr << "Failed to write " << jsonPath << std::endl;
+            return -1;
+        }
+    }
+
+    if (!baselinePath.empty())
+    {
+        std::ifstream baselineFile(baselinePath);
+        if (!baselineFile)
+        {
+            std::cerr << "Failed to read baseline " << baselinePath << std::endl;
+            return -1;
+        }
+
+        std::vector<Benchmark::Record> baseline;
+        try
+        {
+            baseline = Benchmark::ReadJson(baselineFile);
+        }
+        catch (const std::exception& ex)
+        {
+            std::cerr << "Failed to read baseline " << baselinePath << ": " << ex.what() << std::endl;
+            return -1;
+        }
+
+        const auto regressions = Benchmark::FindRegressions(records, baseline, tolerance);
+        for (const auto& regression : regressions)
+            std::cerr << "REGRESSION " << regression << std::endl;
+        if (!regressions.empty())
+            return 1;
+        std::cout << "No regressions against " << baselinePath << std::endl;
+    }
+    return 0;
+}
@@ -1,8 +1,9 @@
 #include <iostream>
 #include "Generator.h"
+#include "Trace.h"
 #include <sodium.h>
 
-int main()
+int main(int argc, char** argv)
 {
     if (sodium_init() == -1)
     {
@@ -10,6 +11,25 @@ int main()
         return -1;
     }
 
+    // --trace <file>: record generate/hash spans for the whole session and write them as a Chrome trace on exit
+    std::string tracePath;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else
+        {
+            std::cout << "usage: cli [--trace trace.json]" << std::endl;
+            return arg == "--help" ? 0 : -1;
+        }
+    }
+    if (!tracePath.empty())
+    {
+        Generator::Trace::Enable();
+        Generator::Trace::SetThreadName("cli");
+    }
+
     Generator::PasswordPolicy policy;
     Generator::PasswordGenerator pwdGen(policy);
 
@@ -20,7 +40,8 @@ int main()
     {
         pwdGen.SetPolicy(policy);
         std::cout << "0. Exit\n1. Set length\n2. Set use lowercase\n3. Set use uppercase\n4. Set use numbers"
-                     "\n5. Set use symbols\n6. Generate password\n7. Hash password\n\nEnter your choice: " << std::flush;
+                     "\n5. Set use symbols\n6. Generate password\n7. Hash password"
+                     "\n8. Generate pronounceable password\n\nEnter your choice: " << std::flush;
 
         int choice = 0;
         std::cin >> choice;
@@ -63,10 +84,32 @@ int main()
                 }
                 std::cout << pwdGen.HashPasswordSafe(std::move(password)) << std::endl;
                 break;
+            case 8:
+            {
+                double entropy = 0;
+                std::tie(password, entropy) = pwdGen.GeneratePronounceablePassword();
+                std::cout << password << " (" << entropy << " bits)" << std::endl;
+                break;
+            }
 
             default:
                 std::cout << "Invalid choice" << std::endl;
         }
     }
+
+    if (!tracePath.empty())
+    {
+        try
+        {
+            const size_t events = Generator::Trace::WriteChromeTrace(tracePath);
+            std::cout << "Wrote " << events << " trace events to " << tracePath
+                      << " (open it in chrome://tracing or ui.perfetto.dev)" << std::endl;
+        }
+        catch (const std::exception& ex)
+        {
+            std::cerr << ex.what() << std::endl;
+            return -1;
+        }
+    }
     return 0;
 }
\ No newline at end of file
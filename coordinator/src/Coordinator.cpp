@@ -0,0 +1,369 @@
+#include "Coordinator.h"
+
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ShardProtocol.h"
+
+using ShardProtocol::Opcode;
+using ShardProtocol::Status;
+namespace Wire = Generator::Wire;
+
+Coordinator::Coordinator(CoordinatorOptions options)
+    :
+    options(std::move(options))
+{
+    if (this->options.workers == 0)
+        throw std::invalid_argument("At least one worker is needed");
+    if (this->options.shardSize == 0 || this->options.shardSize > ShardProtocol::MaxShardSize)
+        throw std::invalid_argument("Shard size must be between 1 and " + std::to_string(ShardProtocol::MaxShardSize));
+    if (this->options.maxAttempts == 0)
+        throw std::invalid_argument("At least one attempt per shard is needed");
+}
+
+Coordinator::~Coordinator()
+{
+    for (Worker& worker : workers)
+        Reap(worker);
+}
+
+void Coordinator::Run(const std::vector<std::string>& passwords, const std::function<void(const std::string& hash)>& emit)
+{
+    shards.clear();
+    pending.clear();
+    finished.clear();
+    nextToEmit = 0;
+    doneShards = 0;
+    retries = 0;
+    killedWorker = false;
+
+    for (size_t first = 0; first < passwords.size(); first += options.shardSize)
+    {
+        const auto count = (uint32_t)std::min<size_t>(options.shardSize, passwords.size() - first);
+        pending.push_back(shards.size());
+        shards.push_back(Shard{shards.size(), first, count, 0});
+    }
+    if (shards.empty())
+        return;
+
+    workers.resize(std::min<size_t>(options.workers, shards.size()));
+    try
+    {
+        for (Worker& worker : workers)
+            Spawn(worker);
+
+        std::vector<pollfd> fds;
+        while (doneShards < shards.size())
+        {
+            for (Worker& worker : workers)
+            {
+                if (worker.busyWith < 0)
+                    Dispatch(worker, passwords);
+            }
+
+            // idle workers are polled too, so one that dies between shards is replaced right away
+            fds.clear();
+            int timeout = -1;
+            const auto now = std::chrono::steady_clock::now();
+            for (const Worker& worker : workers)
+            {
+                fds.push_back(pollfd{worker.fd, POLLIN, 0});
+                if (worker.busyWith >= 0 && options.shardTimeout.count() > 0)
+                {
+                    const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        worker.startedAt + options.shardTimeout - now).count();
+                    const int leftMs = (int)std::clamp<int64_t>(left, 0, 1000000);
+                    timeout = timeout < 0 ? leftMs : std::min(timeout, leftMs);
+                }
+            }
+
+            if (::poll(fds.data(), fds.size(), timeout) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("poll() failed");
+            }
+
+            for (size_t i = 0; i < workers.size(); i++)
+            {
+                Worker& worker = workers[i];
+                if (fds[i].revents != 0)
+                {
+                    // a worker may answer and exit right after; read what's there before calling a hangup a crash
+                    if (worker.busyWith >= 0 && (fds[i].revents & POLLIN))
+                        Receive(worker, emit);
+                    else
+                    {
+                        Fail(worker, "worker exited");
+                        continue;
+                    }
+                }
+
+                // checked after reading too: a worker trickling out a frame byte by byte keeps the socket readable
+                if (worker.busyWith >= 0 && options.shardTimeout.count() > 0 &&
+                    std::chrono::steady_clock::now() - worker.startedAt >= options.shardTimeout)
+                    Fail(worker, "timed out");
+            }
+
+            if (options.killWorkerAfter > 0 && !killedWorker && doneShards >= options.killWorkerAfter &&
+                doneShards < shards.size())
+            {
+                ::kill(workers.front().pid, SIGKILL);
+                killedWorker = true;
+            }
+        }
+    }
+    catch (...)
+    {
+        // a failed run mustn't leave live workers behind for the next Run() to spawn over
+        for (Worker& worker : workers)
+            Reap(worker);
+        workers.clear();
+        throw;
+    }
+
+    for (Worker& worker : workers)
+        Reap(worker);
+    workers.clear();
+}
+
+void Coordinator::Spawn(Worker& worker)
+{
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0)
+        throw std::runtime_error("Failed to create a socket pair for a worker");
+
+    const pid_t pid = ::fork();
+    if (pid < 0)
+    {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        throw std::runtime_error("Failed to fork a worker");
+    }
+
+    if (pid == 0)
+    {
+        // the worker only talks to its own end; _exit skips the coordinator's atexit handlers and stdio buffers
+        ::close(fds[0]);
+        for (const Worker& other : workers)
+        {
+            if (other.fd >= 0)
+                ::close(other.fd);
+        }
+        try
+        {
+            ServeWorker(fds[1], options.policy);
+        }
+        catch (...)
+        {
+            ::_exit(1);
+        }
+        ::_exit(0);
+    }
+
+    ::close(fds[1]);
+    worker.pid = pid;
+    worker.fd = fds[0];
+    worker.busyWith = -1;
+    worker.inbox.clear();
+}
+
+void Coordinator::Reap(Worker& worker)
+{
+    if (worker.fd >= 0)
+    {
+        // a healthy worker exits on its own when it reads EOF
+        ::close(worker.fd);
+        worker.fd = -1;
+    }
+    if (worker.pid > 0)
+    {
+        if (worker.busyWith >= 0)
+            ::kill(worker.pid, SIGKILL);
+        while (::waitpid(worker.pid, nullptr, 0) < 0 && errno == EINTR)
+        {
+        }
+        worker.pid = -1;
+    }
+    worker.busyWith = -1;
+}
+
+void Coordinator::Dispatch(Worker& worker, const std::vector<std::string>& passwords)
+{
+    if (pending.empty())
+        return;
+
+    const size_t index = pending.front();
+    pending.pop_front();
+    Shard& shard = shards[index];
+    shard.attempts++;
+
+    Wire::Writer frame;
+    frame.U8((uint8_t)Opcode::HashShard);
+    frame.U64(shard.id);
+    frame.U32(shard.count);
+    for (size_t i = shard.first; i < shard.first + shard.count; i++)
+        frame.String(passwords[i]);
+
+    worker.busyWith = (int64_t)index;
+    worker.startedAt = std::chrono::steady_clock::now();
+    const bool sent = Wire::WriteFrame(worker.fd, frame);
+    frame.Wipe();
+    if (!sent)
+        Fail(worker, "worker exited");
+}
+
+void Coordinator::Fail(Worker& worker, const std::string& reason)
+{
+    if (worker.busyWith >= 0)
+    {
+        const Shard& shard = shards[(size_t)worker.busyWith];
+        if (shard.attempts >= options.maxAttempts)
+            throw std::runtime_error("Shard " + std::to_string(shard.id) + " failed " + std::to_string(shard.attempts) +
+                                     " times, last: " + reason);
+        pending.push_front((size_t)worker.busyWith);
+        retries++;
+    }
+
+    // SIGKILL first: a worker that hung or sent garbage can't be trusted to exit on EOF
+    if (worker.pid > 0)
+        ::kill(worker.pid, SIGKILL);
+    Reap(worker);
+    Spawn(worker);
+}
+
+void Coordinator::Receive(Worker& worker, const std::function<void(const std::string& hash)>& emit)
+{
+    Shard& shard = shards[(size_t)worker.busyWith];
+
+    // take whatever has arrived without waiting for the rest; poll() says when there is more
+    bool closed = false;
+    uint8_t buffer[64 * 1024];
+    while (true)
+    {
+        const ssize_t received = ::recv(worker.fd, buffer, sizeof(buffer), MSG_DONTWAIT);
+        if (received > 0)
+        {
+            worker.inbox.insert(worker.inbox.end(), buffer, buffer + received);
+            continue;
+        }
+        if (received < 0 && errno == EINTR)
+            continue;
+        closed = received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+        break;
+    }
+
+    uint32_t payloadBytes = 0;
+    if (worker.inbox.size() >= Wire::FrameHeaderBytes)
+        std::memcpy(&payloadBytes, worker.inbox.data(), sizeof(payloadBytes));
+    if (payloadBytes > Wire::MaxFrameBytes)
+    {
+        Fail(worker, "malformed response: oversized frame");
+        return;
+    }
+    const size_t frameBytes = Wire::FrameHeaderBytes + payloadBytes;
+    if (worker.inbox.size() < frameBytes)
+    {
+        if (closed)
+            Fail(worker, "worker exited");
+        return;
+    }
+    if (worker.inbox.size() > frameBytes)
+    {
+        // one request, one response: anything after it means the worker is confused
+        Fail(worker, "malformed response: trailing bytes");
+        return;
+    }
+    const std::vector<uint8_t> payload(worker.inbox.begin() + Wire::FrameHeaderBytes, worker.inbox.end());
+    worker.inbox.clear();
+
+    std::vector<std::string> hashes;
+    std::string error;
+    try
+    {
+        Wire::Reader reader(payload);
+        const auto status = (Status)reader.U8();
+        if (reader.U64() != shard.id)
+            throw std::runtime_error("response for the wrong shard");
+        if (status != Status::Ok)
+            error = reader.String();
+        else
+        {
+            if (reader.U32() != shard.count)
+                throw std::runtime_error("wrong number of hashes");
+            hashes.reserve(shard.count);
+            for (uint32_t i = 0; i < shard.count; i++)
+                hashes.push_back(reader.String());
+        }
+    }
+    catch (const std::runtime_error& ex)
+    {
+        // includes a truncated frame from Wire::Reader
+        error = std::string("malformed response: ") + ex.what();
+    }
+    if (!error.empty())
+    {
+        // a worker that failed gets replaced, in case its state is what's broken
+        Fail(worker, error);
+        return;
+    }
+
+    worker.busyWith = -1;
+    finished.emplace(shard.id, std::move(hashes));
+    doneShards++;
+
+    for (auto next = finished.find(nextToEmit); next != finished.end(); next = finished.find(++nextToEmit))
+    {
+        for (const std::string& hash : next->second)
+            emit(hash);
+        finished.erase(next);
+    }
+}
+
+void Coordinator::ServeWorker(int fd, const Generator::PasswordPolicy& policy)
+{
+    const Generator::PasswordGenerator generator(policy);
+    std::vector<uint8_t> payload;
+    Wire::Writer frame;
+    while (Wire::ReadFrame(fd, payload))
+    {
+        uint64_t shardId = 0;
+        try
+        {
+            Wire::Reader reader(payload);
+            if ((Opcode)reader.U8() != Opcode::HashShard)
+                throw std::invalid_argument("Unknown opcode");
+            shardId = reader.U64();
+            const uint32_t count = reader.U32();
+            if (count > ShardProtocol::MaxShardSize)
+                throw std::invalid_argument("Shard is too large");
+
+            frame.U8((uint8_t)Status::Ok);
+            frame.U64(shardId);
+            frame.U32(count);
+            for (uint32_t i = 0; i < count; i++)
+                frame.String(generator.HashPasswordSafe(reader.String()));
+        }
+        catch (const std::exception& ex)
+        {
+            frame.Wipe();
+            frame.U8((uint8_t)Status::Error);
+            frame.U64(shardId);
+            frame.String(ex.what());
+        }
+
+        // the payload held plaintext passwords
+        sodium_memzero(payload.data(), payload.size());
+        const bool sent = Wire::WriteFrame(fd, frame);
+        frame.Wipe();
+        if (!sent)
+            return;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <Generator.h>
+
+struct CoordinatorOptions
+{
+    /// Worker processes. Each hashes one shard at a time with its own copy of the generator.
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    /// Passwords per shard, at most ShardProtocol::MaxShardSize.
+    uint32_t shardSize = 256;
+    /// A shard is tried this many times (a worker crash, hang or error counts as an attempt) before the run fails.
+    unsigned maxAttempts = 3;
+    /// A worker that spends longer than this on one shard is killed and the shard retried. 0 waits forever.
+    std::chrono::milliseconds shardTimeout{0};
+    /// Test hook: SIGKILL the first worker once this many shards are done, to exercise the retry path. 0 disables it.
+    size_t killWorkerAfter = 0;
+    Generator::PasswordPolicy policy;
+};
+
+/// Splits a bulk hashing job into shards and farms them out to forked worker processes over Unix socket pairs.
+/// Separate processes keep Argon2's large per-hash memory and the allocator out of each other's way, which threads in
+/// one process don't, and the framed protocol is the same one a remote worker would speak.
+/// Failed shards go back on the queue, dead workers are replaced, and hashes come out in input order.
+class Coordinator
+{
+public:
+    explicit Coordinator(CoordinatorOptions options);
+    ~Coordinator();
+    Coordinator(const Coordinator&) = delete;
+    Coordinator& operator=(const Coordinator&) = delete;
+
+    /**
+     * Hashes every password.
+     * @param emit Receives the hashes in input order, as soon as every earlier shard is done too.
+     * @throws std::runtime_error if a shard fails maxAttempts times or a worker can't be started.
+     */
+    void Run(const std::vector<std::string>& passwords, const std::function<void(const std::string& hash)>& emit);
+
+    /// Shards that had to be retried during the last Run.
+    [[nodiscard]] size_t Retries() const { return retries; }
+
+    /// The worker side: serves ShardProtocol requests on fd until the coordinator closes it.
+    static void ServeWorker(int fd, const Generator::PasswordPolicy& policy);
+
+private:
+    struct Shard
+    {
+        uint64_t id = 0;
+        size_t first = 0;
+        uint32_t count = 0;
+        unsigned attempts = 0;
+    };
+
+    struct Worker
+    {
+        pid_t pid = -1;
+        int fd = -1;
+        /// Index into shards of the shard being hashed, or -1 when idle.
+        int64_t busyWith = -1;
+        std::chrono::steady_clock::time_point startedAt;
+        /// Response bytes received so far. Reads never block, so a worker that stops mid-frame still times out.
+        std::vector<uint8_t> inbox;
+    };
+
+    void Spawn(Worker& worker);
+    void Reap(Worker& worker);
+    void Dispatch(Worker& worker, const std::vector<std::string>& passwords);
+    void Fail(Worker& worker, const std::string& reason);
+    void Receive(Worker& worker, const std::function<void(const std::string& hash)>& emit);
+
+    CoordinatorOptions options;
+    std::vector<Worker> workers;
+    std::vector<Shard> shards;
+    std::deque<size_t> pending;
+    /// Finished shards that can't be emitted yet because an earlier one isn't done.
+    std::map<uint64_t, std::vector<std::string>> finished;
+    uint64_t nextToEmit = 0;
+    size_t doneShards = 0;
+    size_t retries = 0;
+    bool killedWorker = false;
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+#include <WireFormat.h>
+
+/// What the coordinator and its worker processes say to each other, layered on Generator::Wire frames over a Unix
+/// socket pair. A worker handles one shard at a time and answers each request before reading the next.
+///
+/// request:  u8 opcode, u64 shardId, body
+///     HashShard: u32 count, count * string password
+/// response: u8 status, u64 shardId, body
+///     Ok:    u32 count, count * string hash (same order as the request)
+///     Error: string message
+namespace ShardProtocol
+{
+    /// Keeps a shard's request and response well inside Wire::MaxFrameBytes.
+    constexpr uint32_t MaxShardSize = 16384;
+
+    enum class Opcode : uint8_t
+    {
+        HashShard = 1
+    };
+
+    enum class Status : uint8_t
+    {
+        Ok = 0,
+        Error = 1
+    };
+}
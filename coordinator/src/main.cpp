@@ -0,0 +1,147 @@
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sodium.h>
+
+#include "Coordinator.h"
+
+namespace
+{
+    Generator::EncryptionStrength ParseStrength(const std::string& value)
+    {
+        if (value == "low")
+            return Generator::EncryptionStrength::Low;
+        if (value == "high")
+            return Generator::EncryptionStrength::High;
+        return Generator::EncryptionStrength::Medium;
+    }
+
+    void PrintUsage()
+    {
+        std::cout << "usage: coordinator [--input file | --generate n] [--output file] [--workers n] [--shard-size n]\n"
+                     "                   [--attempts n] [--timeout-ms n] [--strength low|medium|high] [--verify 1]\n"
+                     "                   [--kill-worker-after n]\n"
+                     "Hashes one password per input line (stdin by default) across worker processes and writes one\n"
+                     "hash per line, in input order." << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (sodium_init() == -1)
+    {
+        std::cerr << "Failed to initialize libsodium" << std::endl;
+        return -1;
+    }
+
+    CoordinatorOptions options;
+    std::string inputPath;
+    std::string outputPath;
+    size_t generateCount = 0;
+    bool verify = false;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc)
+        {
+            PrintUsage();
+            return arg == "--help" ? 0 : -1;
+        }
+
+        const std::string value = argv[++i];
+        if (arg == "--input")
+            inputPath = value;
+        else if (arg == "--output")
+            outputPath = value;
+        else if (arg == "--generate")
+            generateCount = std::stoull(value);
+        else if (arg == "--workers")
+            options.workers = std::max(1, std::stoi(value));
+        else if (arg == "--shard-size")
+            options.shardSize = (uint32_t)std::stoul(value);
+        else if (arg == "--attempts")
+            options.maxAttempts = std::max(1, std::stoi(value));
+        else if (arg == "--timeout-ms")
+            options.shardTimeout = std::chrono::milliseconds(std::stoll(value));
+        else if (arg == "--strength")
+            options.policy.encryptionStrength = ParseStrength(value);
+        else if (arg == "--verify")
+            verify = value != "0";
+        else if (arg == "--kill-worker-after")
+            options.killWorkerAfter = std::stoull(value);
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    // a worker dying mid-request must surface as a failed write, not kill the coordinator
+    std::signal(SIGPIPE, SIG_IGN);
+
+    try
+    {
+        const Generator::PasswordGenerator generator(options.policy);
+        std::vector<std::string> passwords;
+        if (generateCount > 0)
+            passwords = generator.GenerateAdvancedPasswords((int)generateCount);
+        else
+        {
+            std::ifstream file;
+            if (!inputPath.empty())
+            {
+                file.open(inputPath);
+                if (!file)
+                    throw std::runtime_error("Failed to open " + inputPath);
+            }
+            std::istream& input = inputPath.empty() ? std::cin : file;
+            for (std::string line; std::getline(input, line);)
+                passwords.push_back(std::move(line));
+        }
+
+        std::ofstream file;
+        if (!outputPath.empty())
+        {
+            file.open(outputPath, std::ios::trunc);
+            if (!file)
+                throw std::runtime_error("Failed to open " + outputPath);
+        }
+        std::ostream& output = outputPath.empty() ? std::cout : file;
+
+        size_t emitted = 0;
+        size_t mismatches = 0;
+        const auto start = std::chrono::steady_clock::now();
+        Coordinator coordinator(options);
+        coordinator.Run(passwords, [&](const std::string& hash)
+        {
+            if (verify && !generator.VerifyPassword(passwords[emitted], hash))
+                mismatches++;
+            emitted++;
+            output << hash << '\n';
+        });
+        output.flush();
+        if (!output)
+            throw std::runtime_error("Failed to write the hashes");
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cerr << "Hashed " << emitted << " passwords with " << options.workers << " workers in " << seconds
+                  << " s (" << (seconds > 0 ? emitted / seconds : 0) << "/s), " << coordinator.Retries()
+                  << " shard retries" << std::endl;
+        if (emitted != passwords.size() || mismatches > 0)
+        {
+            std::cerr << "Verification failed: " << mismatches << " mismatched hashes, " << emitted << " of "
+                      << passwords.size() << " emitted" << std::endl;
+            return -1;
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Coordinator error: " << ex.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace Generator
+{
+    template <size_t N>
+    class AliasTable;
+}
+
+/// Vose's alias method over N outcomes with integer weights: one uniform draw in [0, Range()) picks an outcome in O(1).
+/// Everything is integer arithmetic, so outcome i comes up with probability exactly Weight(i) / Total(), and the table
+/// can be built at compile time for constexpr models.
+template <size_t N>
+class Generator::AliasTable
+{
+public:
+    constexpr AliasTable() = default;
+
+    /// @throws std::invalid_argument if every weight is zero (or, in a constant expression, fails to compile).
+    constexpr explicit AliasTable(const std::array<uint32_t, N>& weights)
+        :
+        weights(weights)
+    {
+        for (const uint32_t weight : weights)
+            total += weight;
+        if (total == 0)
+            throw std::invalid_argument("Alias table needs a positive weight");
+
+        // Each column holds 'total' units: its own scaled weight, topped up from one larger outcome.
+        std::array<uint64_t, N> scaled{};
+        std::array<size_t, N> small{};
+        std::array<size_t, N> large{};
+        size_t smallCount = 0, largeCount = 0;
+        for (size_t i = 0; i < N; i++)
+        {
+            scaled[i] = (uint64_t)weights[i] * N;
+            if (scaled[i] < total)
+                small[smallCount++] = i;
+            else
+                large[largeCount++] = i;
+        }
+
+        while (smallCount > 0 && largeCount > 0)
+        {
+            const size_t s = small[--smallCount];
+            const size_t l = large[--largeCount];
+            threshold[s] = scaled[s];
+            alias[s] = l;
+            scaled[l] -= total - scaled[s];
+            if (scaled[l] < total)
+                small[smallCount++] = l;
+            else
+                large[largeCount++] = l;
+        }
+
+        // whatever is left holds exactly 'total' units and never needs its alias
+        while (largeCount > 0)
+        {
+            const size_t l = large[--largeCount];
+            threshold[l] = total;
+            alias[l] = l;
+        }
+        while (smallCount > 0)
+        {
+            const size_t s = small[--smallCount];
+            threshold[s] = total;
+            alias[s] = s;
+        }
+    }
+
+    /// Size of the uniform draw Sample() expects.
+    [[nodiscard]] constexpr uint64_t Range() const { return total * N; }
+
+    /// Maps a uniform draw in [0, Range()) to an outcome.
+    [[nodiscard]] constexpr size_t Sample(uint64_t draw) const
+    {
+        const size_t column = (size_t)(draw / total);
+        return draw % total < threshold[column] ? column : alias[column];
+    }
+
+    [[nodiscard]] constexpr uint32_t Weight(size_t outcome) const { return weights[outcome]; }
+    [[nodiscard]] constexpr uint64_t Total() const { return total; }
+
+private:
+    std::array<uint32_t, N> weights{};
+    uint64_t total = 0;
+    std::array<uint64_t, N> threshold{};
+    std::array<size_t, N> alias{};
+};
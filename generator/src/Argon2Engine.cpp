@@ -0,0 +1,508 @@
+#include "Argon2Engine.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "PackedHash.h"
+
+namespace
+{
+    using Generator::Argon2Block;
+
+    constexpr uint32_t s_Version = 0x13;
+    constexpr uint32_t s_TypeArgon2id = 2;
+    constexpr uint32_t s_SyncPoints = 4;
+    constexpr size_t s_BlockBytes = sizeof(Argon2Block);
+    constexpr size_t s_AddressesPerBlock = Argon2Block::s_Words;
+    constexpr size_t s_SaltBytes = 16;
+    constexpr size_t s_TagBytes = 32;
+    constexpr size_t s_HugePageBytes = 2 * 1024 * 1024;
+
+    void StoreLe32(uint8_t* out, uint32_t value)
+    {
+        for (int i = 0; i < 4; i++)
+            out[i] = (uint8_t)(value >> (8 * i));
+    }
+
+    void UpdateLe32(crypto_generichash_state& state, uint32_t value)
+    {
+        uint8_t bytes[4];
+        StoreLe32(bytes, value);
+        crypto_generichash_update(&state, bytes, sizeof(bytes));
+    }
+
+    void UpdateWithLength(crypto_generichash_state& state, const uint8_t* data, size_t length)
+    {
+        UpdateLe32(state, (uint32_t)length);
+        crypto_generichash_update(&state, data, length);
+    }
+
+    /// H': BLAKE2b stretched to any output length by chaining 64 byte hashes and keeping half of each.
+    void Blake2bLong(uint8_t* out, size_t outLength, const uint8_t* in, size_t inLength)
+    {
+        crypto_generichash_state state;
+        uint8_t lengthBytes[4];
+        StoreLe32(lengthBytes, (uint32_t)outLength);
+
+        if (outLength <= crypto_generichash_BYTES_MAX)
+        {
+            crypto_generichash_init(&state, nullptr, 0, outLength);
+            crypto_generichash_update(&state, lengthBytes, sizeof(lengthBytes));
+            crypto_generichash_update(&state, in, inLength);
+            crypto_generichash_final(&state, out, outLength);
+            return;
+        }
+
+        uint8_t chain[crypto_generichash_BYTES_MAX];
+        uint8_t next[crypto_generichash_BYTES_MAX];
+        crypto_generichash_init(&state, nullptr, 0, sizeof(chain));
+        crypto_generichash_update(&state, lengthBytes, sizeof(lengthBytes));
+        crypto_generichash_update(&state, in, inLength);
+        crypto_generichash_final(&state, chain, sizeof(chain));
+
+        size_t remaining = outLength;
+        while (remaining > crypto_generichash_BYTES_MAX)
+        {
+            std::memcpy(out, chain, crypto_generichash_BYTES_MAX / 2);
+            out += crypto_generichash_BYTES_MAX / 2;
+            remaining -= crypto_generichash_BYTES_MAX / 2;
+            crypto_generichash(next, remaining > crypto_generichash_BYTES_MAX ? sizeof(next) : remaining,
+                               chain, sizeof(chain), nullptr, 0);
+            std::memcpy(chain, next, sizeof(next));
+        }
+        std::memcpy(out, chain, remaining);
+        sodium_memzero(chain, sizeof(chain));
+        sodium_memzero(next, sizeof(next));
+    }
+
+    void LoadBlock(Argon2Block& block, const uint8_t* bytes)
+    {
+        for (size_t i = 0; i < Argon2Block::s_Words; i++)
+        {
+            uint64_t word = 0;
+            for (int b = 7; b >= 0; b--)
+                word = (word << 8) | bytes[8 * i + b];
+            block.v[i] = word;
+        }
+    }
+
+    void StoreBlock(uint8_t* bytes, const Argon2Block& block)
+    {
+        for (size_t i = 0; i < Argon2Block::s_Words; i++)
+            for (int b = 0; b < 8; b++)
+                bytes[8 * i + b] = (uint8_t)(block.v[i] >> (8 * b));
+    }
+
+    /// Layout and state of one Argon2 run.
+    struct Instance
+    {
+        Argon2Block* memory;
+        Generator::Argon2FillBlock fillBlock;
+        uint32_t passes;
+        uint32_t lanes;
+        uint32_t laneLength;
+        uint32_t segmentLength;
+        uint32_t totalBlocks;
+    };
+
+    /// Maps a pseudo-random value onto the blocks a new block may reference: everything already computed in the
+    /// current pass (or the last three segments of the previous one), minus the block just before it.
+    uint32_t ReferenceIndex(const Instance& instance, uint32_t pass, uint32_t slice, uint32_t index, uint32_t pseudoRandom, bool sameLane)
+    {
+        uint32_t area;
+        if (pass == 0)
+        {
+            if (slice == 0)
+                area = index - 1;
+            else if (sameLane)
+                area = slice * instance.segmentLength + index - 1;
+            else
+                area = slice * instance.segmentLength - (index == 0 ? 1 : 0);
+        }
+        else
+        {
+            if (sameLane)
+                area = instance.laneLength - instance.segmentLength + index - 1;
+            else
+                area = instance.laneLength - instance.segmentLength - (index == 0 ? 1 : 0);
+        }
+
+        // squaring biases the choice towards recent blocks
+        uint64_t relative = pseudoRandom;
+        relative = (relative * relative) >> 32;
+        relative = area - 1 - (((uint64_t)area * relative) >> 32);
+
+        const uint32_t start = pass != 0 && slice != s_SyncPoints - 1 ? (slice + 1) * instance.segmentLength : 0;
+        return (uint32_t)((start + relative) % instance.laneLength);
+    }
+
+    void FillSegment(const Instance& instance, uint32_t pass, uint32_t lane, uint32_t slice)
+    {
+        // argon2id: data-independent addressing in the first half of the first pass, data-dependent afterwards
+        const bool independent = pass == 0 && slice < s_SyncPoints / 2;
+
+        Argon2Block addresses{};
+        Argon2Block input{};
+        const Argon2Block zero{};
+        auto nextAddresses = [&]()
+        {
+            input.v[6]++;
+            instance.fillBlock(zero, input, addresses, false);
+            instance.fillBlock(zero, addresses, addresses, false);
+        };
+
+        if (independent)
+        {
+            input.v[0] = pass;
+            input.v[1] = lane;
+            input.v[2] = slice;
+            input.v[3] = instance.totalBlocks;
+            input.v[4] = instance.passes;
+            input.v[5] = s_TypeArgon2id;
+        }
+
+        // the first two blocks of every lane come from H0
+        uint32_t startIndex = 0;
+        if (pass == 0 && slice == 0)
+        {
+            startIndex = 2;
+            if (independent)
+                nextAddresses();
+        }
+
+        size_t current = (size_t)lane * instance.laneLength + slice * instance.segmentLength + startIndex;
+        size_t previous = current % instance.laneLength == 0 ? current + instance.laneLength - 1 : current - 1;
+
+        for (uint32_t index = startIndex; index < instance.segmentLength; index++, current++, previous++)
+        {
+            if (current % instance.laneLength == 1)
+                previous = current - 1;
+
+            uint64_t pseudoRandom;
+            if (independent)
+            {
+                if (index % s_AddressesPerBlock == 0)
+                    nextAddresses();
+                pseudoRandom = addresses.v[index % s_AddressesPerBlock];
+            }
+            else
+            {
+                pseudoRandom = instance.memory[previous].v[0];
+            }
+
+            uint32_t referenceLane = (uint32_t)((pseudoRandom >> 32) % instance.lanes);
+            if (pass == 0 && slice == 0)
+                referenceLane = lane;
+            const uint32_t referenceIndex = ReferenceIndex(instance, pass, slice, index, (uint32_t)pseudoRandom, referenceLane == lane);
+
+            instance.fillBlock(instance.memory[previous],
+                               instance.memory[(size_t)referenceLane * instance.laneLength + referenceIndex],
+                               instance.memory[current], pass != 0);
+        }
+    }
+
+#if defined(_WIN32)
+    void* MapMemory(size_t bytes, bool /*hugePages*/, bool& reservedHugePages)
+    {
+        // large pages need SeLockMemoryPrivilege, which normal accounts don't have
+        reservedHugePages = false;
+        return VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    }
+
+    void UnmapMemory(void* memory, size_t /*bytes*/)
+    {
+        VirtualFree(memory, 0, MEM_RELEASE);
+    }
+
+    size_t PageSize()
+    {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwPageSize;
+    }
+#else
+    void* MapMemory(size_t bytes, bool hugePages, bool& reservedHugePages)
+    {
+        reservedHugePages = false;
+#if defined(MAP_HUGETLB) && defined(MAP_POPULATE)
+        if (hugePages)
+        {
+            void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+            if (memory != MAP_FAILED)
+            {
+                reservedHugePages = true;
+                return memory;
+            }
+        }
+#endif
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED)
+            return nullptr;
+#if defined(MADV_HUGEPAGE)
+        // has to come before the pages are touched to get transparent huge pages
+        if (hugePages)
+            madvise(memory, bytes, MADV_HUGEPAGE);
+#endif
+#if defined(MADV_DONTDUMP)
+        madvise(memory, bytes, MADV_DONTDUMP);
+#endif
+        return memory;
+    }
+
+    void UnmapMemory(void* memory, size_t bytes)
+    {
+        munmap(memory, bytes);
+    }
+
+    size_t PageSize()
+    {
+        return (size_t)sysconf(_SC_PAGESIZE);
+    }
+#endif
+
+    void Validate(const Generator::Argon2Params& params, size_t saltLength, size_t tagLength)
+    {
+        if (params.timeCost < 1)
+            throw std::invalid_argument("Argon2 needs at least one pass");
+        if (params.parallelism < 1 || params.parallelism > 0xFFFFFF)
+            throw std::invalid_argument("Argon2 lanes must be between 1 and 2^24 - 1");
+        if (params.memoryKiB < 8 * params.parallelism)
+            throw std::invalid_argument("Argon2 needs at least 8 KiB of memory per lane");
+        if (saltLength < 8)
+            throw std::invalid_argument("Argon2 salts must be at least 8 bytes");
+        if (tagLength < crypto_generichash_BYTES_MIN || tagLength > UINT32_MAX)
+            throw std::invalid_argument("Argon2 tags must be at least 16 bytes");
+    }
+}
+
+Generator::Argon2Params Generator::Argon2Params::FromHashCost(const HashCost& cost)
+{
+    if (cost.opsLimit > UINT32_MAX || cost.memLimit / 1024 > UINT32_MAX)
+        throw std::invalid_argument("Hash cost out of range for Argon2");
+    return Argon2Params{(uint32_t)cost.opsLimit, (uint32_t)(cost.memLimit / 1024), cost.parallelism};
+}
+
+Generator::Argon2Arena::Argon2Arena(bool hugePages) : hugePages(hugePages) {}
+
+Generator::Argon2Arena::~Argon2Arena()
+{
+    Release();
+}
+
+void Generator::Argon2Arena::Reserve(size_t bytes)
+{
+    if (bytes <= capacity)
+        return;
+    Release();
+
+    const size_t rounded = hugePages ? (bytes + s_HugePageBytes - 1) / s_HugePageBytes * s_HugePageBytes : bytes;
+    memory = MapMemory(rounded, hugePages, reservedHugePages);
+    if (!memory)
+        throw std::runtime_error("Failed to map " + std::to_string(rounded) + " bytes for Argon2");
+    capacity = rounded;
+
+    // fault every page in now rather than during the first hash
+    if (!reservedHugePages)
+    {
+        const size_t pageSize = PageSize();
+        auto* bytesPtr = (volatile uint8_t*)memory;
+        for (size_t offset = 0; offset < capacity; offset += pageSize)
+            bytesPtr[offset] = 0;
+    }
+}
+
+void Generator::Argon2Arena::Release()
+{
+    if (memory)
+        UnmapMemory(memory, capacity);
+    memory = nullptr;
+    capacity = 0;
+    reservedHugePages = false;
+}
+
+Generator::Argon2Engine::Argon2Engine(Argon2Kernel kernel)
+    :
+    kernel(kernel),
+    fillBlock(GetArgon2FillBlock(kernel))
+{}
+
+std::vector<uint8_t> Generator::Argon2Engine::Hash(Argon2Arena& arena, std::string_view password, const std::vector<uint8_t>& salt,
+                                                   const Argon2Params& params, size_t tagLength,
+                                                   const std::vector<uint8_t>& secret,
+                                                   const std::vector<uint8_t>& associatedData) const
+{
+    Validate(params, salt.size(), tagLength);
+
+    // memory is rounded down to a multiple of 4 * lanes blocks, so every segment has the same length
+    Instance instance{};
+    instance.fillBlock = fillBlock;
+    instance.passes = params.timeCost;
+    instance.lanes = params.parallelism;
+    instance.segmentLength = params.memoryKiB / (s_SyncPoints * params.parallelism);
+    instance.laneLength = instance.segmentLength * s_SyncPoints;
+    instance.totalBlocks = instance.laneLength * instance.lanes;
+
+    const size_t memoryBytes = (size_t)instance.totalBlocks * s_BlockBytes;
+    arena.Reserve(memoryBytes);
+    instance.memory = arena.Blocks();
+
+    // H0 = H(p, T, m, t, v, y, P, S, K, X)
+    uint8_t seed[crypto_generichash_BYTES_MAX + 8];
+    crypto_generichash_state state;
+    crypto_generichash_init(&state, nullptr, 0, crypto_generichash_BYTES_MAX);
+    UpdateLe32(state, params.parallelism);
+    UpdateLe32(state, (uint32_t)tagLength);
+    UpdateLe32(state, params.memoryKiB);
+    UpdateLe32(state, params.timeCost);
+    UpdateLe32(state, s_Version);
+    UpdateLe32(state, s_TypeArgon2id);
+    UpdateWithLength(state, (const uint8_t*)password.data(), password.size());
+    UpdateWithLength(state, salt.data(), salt.size());
+    UpdateWithLength(state, secret.data(), secret.size());
+    UpdateWithLength(state, associatedData.data(), associatedData.size());
+    crypto_generichash_final(&state, seed, crypto_generichash_BYTES_MAX);
+
+    uint8_t blockBytes[s_BlockBytes];
+    for (uint32_t lane = 0; lane < instance.lanes; lane++)
+    {
+        for (uint32_t column = 0; column < 2; column++)
+        {
+            StoreLe32(seed + crypto_generichash_BYTES_MAX, column);
+            StoreLe32(seed + crypto_generichash_BYTES_MAX + 4, lane);
+            Blake2bLong(blockBytes, sizeof(blockBytes), seed, sizeof(seed));
+            LoadBlock(instance.memory[(size_t)lane * instance.laneLength + column], blockBytes);
+        }
+    }
+
+    // lanes only synchronize at slice boundaries, so filling them one after another is equivalent
+    for (uint32_t pass = 0; pass < instance.passes; pass++)
+        for (uint32_t slice = 0; slice < s_SyncPoints; slice++)
+            for (uint32_t lane = 0; lane < instance.lanes; lane++)
+                FillSegment(instance, pass, lane, slice);
+
+    Argon2Block combined = instance.memory[instance.laneLength - 1];
+    for (uint32_t lane = 1; lane < instance.lanes; lane++)
+    {
+        const Argon2Block& last = instance.memory[(size_t)lane * instance.laneLength + instance.laneLength - 1];
+        for (size_t i = 0; i < Argon2Block::s_Words; i++)
+            combined.v[i] ^= last.v[i];
+    }
+    StoreBlock(blockBytes, combined);
+
+    std::vector<uint8_t> tag(tagLength);
+    Blake2bLong(tag.data(), tag.size(), blockBytes, sizeof(blockBytes));
+
+    // the arena outlives the hash, so it mustn't keep anything derived from the password
+    sodium_memzero(instance.memory, memoryBytes);
+    sodium_memzero(&combined, sizeof(combined));
+    sodium_memzero(blockBytes, sizeof(blockBytes));
+    sodium_memzero(seed, sizeof(seed));
+    return tag;
+}
+
+std::string Generator::Argon2Engine::HashString(Argon2Arena& arena, std::string_view password, const Argon2Params& params) const
+{
+    PackedHash hash;
+    hash.algorithm = HashAlgorithm::Argon2id;
+    hash.version = s_Version;
+    hash.timeCost = params.timeCost;
+    hash.memoryCost = params.memoryKiB;
+    hash.parallelism = params.parallelism;
+    hash.salt.resize(s_SaltBytes);
+    randombytes_buf(hash.salt.data(), hash.salt.size());
+    hash.tag = Hash(arena, password, hash.salt, params, s_TagBytes);
+    return hash.ToString();
+}
+
+bool Generator::Argon2Engine::VerifyString(Argon2Arena& arena, std::string_view password, std::string_view encoded) const
+{
+    PackedHash hash;
+    try
+    {
+        hash = PackedHash::FromString(encoded);
+    }
+    catch (const std::invalid_argument&)
+    {
+        return false;
+    }
+    if (hash.algorithm != HashAlgorithm::Argon2id || hash.version != s_Version || hash.timeCost > UINT32_MAX ||
+        hash.memoryCost > UINT32_MAX || hash.tag.size() < crypto_generichash_BYTES_MIN)
+        return false;
+
+    const Argon2Params params{(uint32_t)hash.timeCost, (uint32_t)hash.memoryCost, hash.parallelism};
+    std::vector<uint8_t> computed;
+    try
+    {
+        computed = Hash(arena, password, hash.salt, params, hash.tag.size());
+    }
+    catch (const std::invalid_argument&)
+    {
+        return false;
+    }
+    const bool matches = sodium_memcmp(computed.data(), hash.tag.data(), hash.tag.size()) == 0;
+    sodium_memzero(computed.data(), computed.size());
+    return matches;
+}
+
+Generator::Argon2Arena& Generator::Argon2Engine::ThreadArena()
+{
+    thread_local Argon2Arena arena;
+    return arena;
+}
+
+namespace
+{
+    class Argon2EngineBackend final : public Generator::HashingBackend
+    {
+    public:
+        [[nodiscard]] Generator::HashAlgorithm Algorithm() const override { return Generator::HashAlgorithm::Argon2id; }
+        [[nodiscard]] std::string_view Name() const override { return "argon2id-engine"; }
+        [[nodiscard]] std::string_view Prefix() const override { return crypto_pwhash_argon2id_STRPREFIX; }
+
+        [[nodiscard]] Generator::HashCost CostFor(Generator::EncryptionStrength strength) const override
+        {
+            return Libsodium().CostFor(strength);
+        }
+
+        [[nodiscard]] std::string Hash(const std::string& password, const Generator::HashCost& cost) const override
+        {
+            return engine.HashString(Generator::Argon2Engine::ThreadArena(), password, Generator::Argon2Params::FromHashCost(cost));
+        }
+
+        [[nodiscard]] bool Verify(const std::string& password, const std::string& hash) const override
+        {
+            return engine.VerifyString(Generator::Argon2Engine::ThreadArena(), password, hash);
+        }
+
+        [[nodiscard]] bool NeedsRehash(const std::string& hash, const Generator::HashCost& cost) const override
+        {
+            return Libsodium().NeedsRehash(hash, cost);
+        }
+
+        [[nodiscard]] size_t MemoryCost(std::string_view hash) const override
+        {
+            return Libsodium().MemoryCost(hash);
+        }
+
+    private:
+        static const Generator::HashingBackend& Libsodium()
+        {
+            return Generator::GetHashingBackend(Generator::HashAlgorithm::Argon2id);
+        }
+
+        const Generator::Argon2Engine engine;
+    };
+}
+
+const Generator::HashingBackend& Generator::GetArgon2EngineBackend()
+{
+    static const Argon2EngineBackend backend;
+    return backend;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Argon2Kernels.h"
+#include "HashingBackend.h"
+
+namespace Generator
+{
+    /// Argon2 cost parameters in the units of the encoded string.
+    struct Argon2Params
+    {
+        uint32_t timeCost = 1;
+        /// m, in KiB. Must be at least 8 * parallelism.
+        uint32_t memoryKiB = 8;
+        uint32_t parallelism = 1;
+
+        /// The parameters libsodium's argon2id backend would use for a HashCost (memLimit is in bytes there).
+        /// @throws std::invalid_argument if the cost doesn't fit Argon2's 32-bit fields.
+        [[nodiscard]] static Argon2Params FromHashCost(const HashCost& cost);
+    };
+
+    class Argon2Arena;
+    class Argon2Engine;
+
+    /// A HashingBackend for argon2id that runs on Argon2Engine with the calling thread's arena instead of libsodium.
+    /// Produces and accepts the same "$argon2id$" strings as the libsodium backend.
+    [[nodiscard]] const HashingBackend& GetArgon2EngineBackend();
+}
+
+/// Scratch memory for Argon2Engine. Mapped once, faulted in up front and reused by every hash that fits, so bulk
+/// hashing doesn't pay for mmap, page faults and the kernel zeroing fresh pages on every hash. Grows when a hash needs
+/// more. Not thread-safe: give each worker its own (Argon2Engine::ThreadArena() does).
+class Generator::Argon2Arena
+{
+public:
+    /**
+     * @param hugePages Try reserved huge pages (Linux MAP_HUGETLB) first, then fall back to normal pages with a
+     *                  transparent huge page hint. Reserved huge pages only exist if the admin set vm.nr_hugepages.
+     */
+    explicit Argon2Arena(bool hugePages = false);
+    ~Argon2Arena();
+
+    Argon2Arena(const Argon2Arena&) = delete;
+    Argon2Arena& operator=(const Argon2Arena&) = delete;
+
+    /// Makes sure at least bytes are mapped and faulted in. Keeps the current mapping if it's big enough.
+    /// @throws std::runtime_error if the memory can't be mapped.
+    void Reserve(size_t bytes);
+
+    [[nodiscard]] size_t Capacity() const { return capacity; }
+    /// True if the current mapping is backed by reserved huge pages.
+    [[nodiscard]] bool UsesHugePages() const { return reservedHugePages; }
+    [[nodiscard]] Argon2Block* Blocks() const { return (Argon2Block*)memory; }
+
+private:
+    void Release();
+
+    bool hugePages;
+    void* memory = nullptr;
+    size_t capacity = 0;
+    bool reservedHugePages = false;
+};
+
+/// Argon2id (version 1.3) implemented in the library, so its block compression can use the CPU's vector units and its
+/// memory can come from a reused Argon2Arena. Lanes are computed one after another, like libsodium does.
+/// Output is bit-for-bit the same as libsodium's crypto_pwhash() and crypto_pwhash_argon2id_str().
+/// Thread-safe: the engine holds no mutable state, the arena is passed in.
+class Generator::Argon2Engine
+{
+public:
+    /// @throws std::invalid_argument if the CPU can't run the kernel.
+    explicit Argon2Engine(Argon2Kernel kernel = BestArgon2Kernel());
+
+    [[nodiscard]] Argon2Kernel Kernel() const { return kernel; }
+
+    /**
+     * Raw Argon2id.
+     * @param salt At least 8 bytes.
+     * @param secret Optional key K, associatedData optional data X (RFC 9106). libsodium uses neither.
+     * @returns The tag, tagLength (at least 16) bytes.
+     * @throws std::invalid_argument for parameters outside what Argon2 allows.
+     */
+    [[nodiscard]] std::vector<uint8_t> Hash(Argon2Arena& arena, std::string_view password, const std::vector<uint8_t>& salt,
+                                            const Argon2Params& params, size_t tagLength = 32,
+                                            const std::vector<uint8_t>& secret = {},
+                                            const std::vector<uint8_t>& associatedData = {}) const;
+
+    /// Hashes with a random 16 byte salt into a 32 byte tag and encodes it like crypto_pwhash_argon2id_str().
+    [[nodiscard]] std::string HashString(Argon2Arena& arena, std::string_view password, const Argon2Params& params) const;
+    /// Verifies against a "$argon2id$" string. Anything else, or a malformed string, doesn't verify.
+    [[nodiscard]] bool VerifyString(Argon2Arena& arena, std::string_view password, std::string_view encoded) const;
+
+    /// The calling thread's arena. It keeps the largest size any hash on the thread needed until the thread exits.
+    [[nodiscard]] static Argon2Arena& ThreadArena();
+
+private:
+    Argon2Kernel kernel;
+    Argon2FillBlock fillBlock;
+};
@@ -0,0 +1,374 @@
+#include "Argon2Kernels.h"
+
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define GENERATOR_ARGON2_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC compiles intrinsics for any instruction set without per-function target attributes
+#define GENERATOR_TARGET(isa)
+#else
+#define GENERATOR_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace
+{
+    using Generator::Argon2Block;
+
+    // ---- portable ----
+
+    inline uint64_t Rotr(uint64_t x, int n)
+    {
+        return (x >> n) | (x << (64 - n));
+    }
+
+    /// BlaMka: BLAKE2b's addition with an added 32x32 bit multiplication, which is what makes Argon2 costly on ASICs.
+    inline uint64_t BlaMka(uint64_t x, uint64_t y)
+    {
+        return x + y + 2 * (uint64_t)(uint32_t)x * (uint32_t)y;
+    }
+
+    inline void GB(uint64_t& a, uint64_t& b, uint64_t& c, uint64_t& d)
+    {
+        a = BlaMka(a, b);
+        d = Rotr(d ^ a, 32);
+        c = BlaMka(c, d);
+        b = Rotr(b ^ c, 24);
+        a = BlaMka(a, b);
+        d = Rotr(d ^ a, 16);
+        c = BlaMka(c, d);
+        b = Rotr(b ^ c, 63);
+    }
+
+    /// The permutation P over 16 words of w, word k being w[first + offsets[k]].
+    inline void Permute(uint64_t* w, size_t first, const size_t (&offsets)[16])
+    {
+        uint64_t* v[16];
+        for (size_t k = 0; k < 16; k++)
+            v[k] = &w[first + offsets[k]];
+        GB(*v[0], *v[4], *v[8], *v[12]);
+        GB(*v[1], *v[5], *v[9], *v[13]);
+        GB(*v[2], *v[6], *v[10], *v[14]);
+        GB(*v[3], *v[7], *v[11], *v[15]);
+        GB(*v[0], *v[5], *v[10], *v[15]);
+        GB(*v[1], *v[6], *v[11], *v[12]);
+        GB(*v[2], *v[7], *v[8], *v[13]);
+        GB(*v[3], *v[4], *v[9], *v[14]);
+    }
+
+    void FillBlockPortable(const Argon2Block& prev, const Argon2Block& ref, Argon2Block& next, bool withXor)
+    {
+        // rows are 16 consecutive words; column i is words 2i and 2i+1 of every row
+        static constexpr size_t s_Row[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+        static constexpr size_t s_Column[16] = {0, 1, 16, 17, 32, 33, 48, 49, 64, 65, 80, 81, 96, 97, 112, 113};
+
+        Argon2Block r;
+        Argon2Block xy;
+        for (size_t i = 0; i < Argon2Block::s_Words; i++)
+        {
+            r.v[i] = prev.v[i] ^ ref.v[i];
+            xy.v[i] = withXor ? r.v[i] ^ next.v[i] : r.v[i];
+        }
+        for (size_t row = 0; row < 8; row++)
+            Permute(r.v, 16 * row, s_Row);
+        for (size_t column = 0; column < 8; column++)
+            Permute(r.v, 2 * column, s_Column);
+        for (size_t i = 0; i < Argon2Block::s_Words; i++)
+            next.v[i] = r.v[i] ^ xy.v[i];
+    }
+
+#if defined(GENERATOR_ARGON2_X86)
+    // ---- SSE4.1: two words per register, one P at a time ----
+
+    GENERATOR_TARGET("sse4.1") inline __m128i BlaMka128(__m128i x, __m128i y)
+    {
+        const __m128i product = _mm_mul_epu32(x, y);
+        return _mm_add_epi64(_mm_add_epi64(x, y), _mm_add_epi64(product, product));
+    }
+
+    GENERATOR_TARGET("sse4.1") inline void G128(__m128i& a0, __m128i& a1, __m128i& b0, __m128i& b1,
+                                                 __m128i& c0, __m128i& c1, __m128i& d0, __m128i& d1)
+    {
+        const __m128i rotr24 = _mm_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+        const __m128i rotr16 = _mm_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+
+        a0 = BlaMka128(a0, b0);
+        a1 = BlaMka128(a1, b1);
+        d0 = _mm_shuffle_epi32(_mm_xor_si128(d0, a0), _MM_SHUFFLE(2, 3, 0, 1));
+        d1 = _mm_shuffle_epi32(_mm_xor_si128(d1, a1), _MM_SHUFFLE(2, 3, 0, 1));
+        c0 = BlaMka128(c0, d0);
+        c1 = BlaMka128(c1, d1);
+        b0 = _mm_shuffle_epi8(_mm_xor_si128(b0, c0), rotr24);
+        b1 = _mm_shuffle_epi8(_mm_xor_si128(b1, c1), rotr24);
+
+        a0 = BlaMka128(a0, b0);
+        a1 = BlaMka128(a1, b1);
+        d0 = _mm_shuffle_epi8(_mm_xor_si128(d0, a0), rotr16);
+        d1 = _mm_shuffle_epi8(_mm_xor_si128(d1, a1), rotr16);
+        c0 = BlaMka128(c0, d0);
+        c1 = BlaMka128(c1, d1);
+        b0 = _mm_xor_si128(b0, c0);
+        b1 = _mm_xor_si128(b1, c1);
+        b0 = _mm_xor_si128(_mm_srli_epi64(b0, 63), _mm_add_epi64(b0, b0));
+        b1 = _mm_xor_si128(_mm_srli_epi64(b1, 63), _mm_add_epi64(b1, b1));
+    }
+
+    /// P over v0..v15 held as a0 = (v0, v1), a1 = (v2, v3), b0 = (v4, v5), ... d1 = (v14, v15). The diagonal step
+    /// rotates the b, c and d rows by one, two and three words so it can reuse the column step.
+    GENERATOR_TARGET("sse4.1") inline void Round128(__m128i& a0, __m128i& a1, __m128i& b0, __m128i& b1,
+                                                     __m128i& c0, __m128i& c1, __m128i& d0, __m128i& d1)
+    {
+        G128(a0, a1, b0, b1, c0, c1, d0, d1);
+
+        __m128i t0 = _mm_alignr_epi8(b1, b0, 8);
+        __m128i t1 = _mm_alignr_epi8(b0, b1, 8);
+        b0 = t0;
+        b1 = t1;
+        t0 = c0;
+        c0 = c1;
+        c1 = t0;
+        t0 = _mm_alignr_epi8(d0, d1, 8);
+        t1 = _mm_alignr_epi8(d1, d0, 8);
+        d0 = t0;
+        d1 = t1;
+
+        G128(a0, a1, b0, b1, c0, c1, d0, d1);
+
+        t0 = _mm_alignr_epi8(b0, b1, 8);
+        t1 = _mm_alignr_epi8(b1, b0, 8);
+        b0 = t0;
+        b1 = t1;
+        t0 = c0;
+        c0 = c1;
+        c1 = t0;
+        t0 = _mm_alignr_epi8(d1, d0, 8);
+        t1 = _mm_alignr_epi8(d0, d1, 8);
+        d0 = t0;
+        d1 = t1;
+    }
+
+    GENERATOR_TARGET("sse4.1") void FillBlockSse41(const Argon2Block& prev, const Argon2Block& ref, Argon2Block& next, bool withXor)
+    {
+        constexpr size_t registers = Argon2Block::s_Words / 2;
+        __m128i state[registers];
+        __m128i xy[registers];
+        const auto* prevWords = (const __m128i*)prev.v;
+        const auto* refWords = (const __m128i*)ref.v;
+        auto* nextWords = (__m128i*)next.v;
+
+        for (size_t i = 0; i < registers; i++)
+        {
+            state[i] = _mm_xor_si128(_mm_load_si128(prevWords + i), _mm_load_si128(refWords + i));
+            xy[i] = withXor ? _mm_xor_si128(state[i], _mm_load_si128(nextWords + i)) : state[i];
+        }
+        for (size_t row = 0; row < 8; row++)
+        {
+            __m128i* s = state + 8 * row;
+            Round128(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7]);
+        }
+        for (size_t column = 0; column < 8; column++)
+        {
+            __m128i* s = state + column;
+            Round128(s[0], s[8], s[16], s[24], s[32], s[40], s[48], s[56]);
+        }
+        for (size_t i = 0; i < registers; i++)
+            _mm_store_si128(nextWords + i, _mm_xor_si128(state[i], xy[i]));
+    }
+
+    // ---- AVX2: rows as four words per register, columns two at a time in the 128-bit halves ----
+
+    GENERATOR_TARGET("avx2") inline __m256i BlaMka256(__m256i x, __m256i y)
+    {
+        const __m256i product = _mm256_mul_epu32(x, y);
+        return _mm256_add_epi64(_mm256_add_epi64(x, y), _mm256_add_epi64(product, product));
+    }
+
+    GENERATOR_TARGET("avx2") inline __m256i Rotr32(__m256i x)
+    {
+        return _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1));
+    }
+
+    GENERATOR_TARGET("avx2") inline __m256i Rotr24(__m256i x)
+    {
+        const __m256i mask = _mm256_setr_epi8(3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10,
+                                              3, 4, 5, 6, 7, 0, 1, 2, 11, 12, 13, 14, 15, 8, 9, 10);
+        return _mm256_shuffle_epi8(x, mask);
+    }
+
+    GENERATOR_TARGET("avx2") inline __m256i Rotr16(__m256i x)
+    {
+        const __m256i mask = _mm256_setr_epi8(2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9,
+                                              2, 3, 4, 5, 6, 7, 0, 1, 10, 11, 12, 13, 14, 15, 8, 9);
+        return _mm256_shuffle_epi8(x, mask);
+    }
+
+    GENERATOR_TARGET("avx2") inline __m256i Rotr63(__m256i x)
+    {
+        return _mm256_xor_si256(_mm256_srli_epi64(x, 63), _mm256_add_epi64(x, x));
+    }
+
+    GENERATOR_TARGET("avx2") inline void G256(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+    {
+        a = BlaMka256(a, b);
+        d = Rotr32(_mm256_xor_si256(d, a));
+        c = BlaMka256(c, d);
+        b = Rotr24(_mm256_xor_si256(b, c));
+        a = BlaMka256(a, b);
+        d = Rotr16(_mm256_xor_si256(d, a));
+        c = BlaMka256(c, d);
+        b = Rotr63(_mm256_xor_si256(b, c));
+    }
+
+    /// P over one row: a = v0..v3, b = v4..v7, c = v8..v11, d = v12..v15.
+    GENERATOR_TARGET("avx2") inline void RowRound256(__m256i& a, __m256i& b, __m256i& c, __m256i& d)
+    {
+        G256(a, b, c, d);
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(0, 3, 2, 1));
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(2, 1, 0, 3));
+        G256(a, b, c, d);
+        b = _mm256_permute4x64_epi64(b, _MM_SHUFFLE(2, 1, 0, 3));
+        c = _mm256_permute4x64_epi64(c, _MM_SHUFFLE(1, 0, 3, 2));
+        d = _mm256_permute4x64_epi64(d, _MM_SHUFFLE(0, 3, 2, 1));
+    }
+
+    /// Round128() on two columns at once, one in each 128-bit half; every instruction used stays within its half.
+    GENERATOR_TARGET("avx2") inline void ColumnRound256(__m256i& a0, __m256i& a1, __m256i& b0, __m256i& b1,
+                                                         __m256i& c0, __m256i& c1, __m256i& d0, __m256i& d1)
+    {
+        G256(a0, b0, c0, d0);
+        G256(a1, b1, c1, d1);
+
+        __m256i t0 = _mm256_alignr_epi8(b1, b0, 8);
+        __m256i t1 = _mm256_alignr_epi8(b0, b1, 8);
+        b0 = t0;
+        b1 = t1;
+        t0 = c0;
+        c0 = c1;
+        c1 = t0;
+        t0 = _mm256_alignr_epi8(d0, d1, 8);
+        t1 = _mm256_alignr_epi8(d1, d0, 8);
+        d0 = t0;
+        d1 = t1;
+
+        G256(a0, b0, c0, d0);
+        G256(a1, b1, c1, d1);
+
+        t0 = _mm256_alignr_epi8(b0, b1, 8);
+        t1 = _mm256_alignr_epi8(b1, b0, 8);
+        b0 = t0;
+        b1 = t1;
+        t0 = c0;
+        c0 = c1;
+        c1 = t0;
+        t0 = _mm256_alignr_epi8(d1, d0, 8);
+        t1 = _mm256_alignr_epi8(d0, d1, 8);
+        d0 = t0;
+        d1 = t1;
+    }
+
+    GENERATOR_TARGET("avx2") void FillBlockAvx2(const Argon2Block& prev, const Argon2Block& ref, Argon2Block& next, bool withXor)
+    {
+        constexpr size_t registers = Argon2Block::s_Words / 4;
+        __m256i state[registers];
+        __m256i xy[registers];
+        const auto* prevWords = (const __m256i*)prev.v;
+        const auto* refWords = (const __m256i*)ref.v;
+        auto* nextWords = (__m256i*)next.v;
+
+        for (size_t i = 0; i < registers; i++)
+        {
+            state[i] = _mm256_xor_si256(_mm256_load_si256(prevWords + i), _mm256_load_si256(refWords + i));
+            xy[i] = withXor ? _mm256_xor_si256(state[i], _mm256_load_si256(nextWords + i)) : state[i];
+        }
+        for (size_t row = 0; row < 8; row++)
+        {
+            __m256i* s = state + 4 * row;
+            RowRound256(s[0], s[1], s[2], s[3]);
+        }
+        // register 4 * row + pair holds columns 2 * pair and 2 * pair + 1 of that row
+        for (size_t pair = 0; pair < 4; pair++)
+        {
+            __m256i* s = state + pair;
+            ColumnRound256(s[0], s[4], s[8], s[12], s[16], s[20], s[24], s[28]);
+        }
+        for (size_t i = 0; i < registers; i++)
+            _mm256_store_si256(nextWords + i, _mm256_xor_si256(state[i], xy[i]));
+    }
+
+    bool CpuHas(Generator::Argon2Kernel kernel)
+    {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int info[4];
+        __cpuid(info, 0);
+        const int maxLeaf = info[0];
+        __cpuid(info, 1);
+        const bool sse41 = (info[2] & (1 << 19)) != 0;
+        if (kernel == Generator::Argon2Kernel::Sse41)
+            return sse41;
+        // AVX2 also needs the OS to save the ymm registers (OSXSAVE, then XCR0 bits 1 and 2)
+        const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+        if (maxLeaf < 7 || !osSavesYmm)
+            return false;
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        // libgcc's check includes the OS support for the AVX state
+        __builtin_cpu_init();
+        return kernel == Generator::Argon2Kernel::Sse41 ? __builtin_cpu_supports("sse4.1") != 0 : __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+#endif
+}
+
+bool Generator::IsArgon2KernelSupported(Argon2Kernel kernel)
+{
+    if (kernel == Argon2Kernel::Portable)
+        return true;
+#if defined(GENERATOR_ARGON2_X86)
+    static const bool sse41 = CpuHas(Argon2Kernel::Sse41);
+    static const bool avx2 = CpuHas(Argon2Kernel::Avx2);
+    return kernel == Argon2Kernel::Sse41 ? sse41 : avx2;
+#else
+    return false;
+#endif
+}
+
+Generator::Argon2Kernel Generator::BestArgon2Kernel()
+{
+    if (IsArgon2KernelSupported(Argon2Kernel::Avx2))
+        return Argon2Kernel::Avx2;
+    if (IsArgon2KernelSupported(Argon2Kernel::Sse41))
+        return Argon2Kernel::Sse41;
+    return Argon2Kernel::Portable;
+}
+
+Generator::Argon2FillBlock Generator::GetArgon2FillBlock(Argon2Kernel kernel)
+{
+    if (!IsArgon2KernelSupported(kernel))
+        throw std::invalid_argument(std::string("This CPU can't run the ") + Argon2KernelName(kernel) + " Argon2 kernel");
+
+    switch (kernel)
+    {
+#if defined(GENERATOR_ARGON2_X86)
+        case Argon2Kernel::Avx2: return FillBlockAvx2;
+        case Argon2Kernel::Sse41: return FillBlockSse41;
+#endif
+        default: return FillBlockPortable;
+    }
+}
+
+const char* Generator::Argon2KernelName(Argon2Kernel kernel)
+{
+    switch (kernel)
+    {
+        case Argon2Kernel::Portable: return "portable";
+        case Argon2Kernel::Sse41: return "sse4.1";
+        case Argon2Kernel::Avx2: return "avx2";
+    }
+    return "unknown";
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Generator
+{
+    /// Block compression implementations. Which ones a CPU can run is decided at runtime.
+    enum class Argon2Kernel
+    {
+        Portable,
+        Sse41,
+        Avx2
+    };
+
+    /// One 1 KiB Argon2 memory block.
+    struct alignas(64) Argon2Block
+    {
+        static constexpr size_t s_Words = 128;
+        uint64_t v[s_Words];
+    };
+
+    /// The compression function G applied as Argon2 fills memory: next = G(prev, ref), or next ^= G(prev, ref) when
+    /// withXor is set (version 1.3, every pass after the first).
+    using Argon2FillBlock = void (*)(const Argon2Block& prev, const Argon2Block& ref, Argon2Block& next, bool withXor);
+
+    [[nodiscard]] bool IsArgon2KernelSupported(Argon2Kernel kernel);
+    /// The fastest kernel this CPU supports.
+    [[nodiscard]] Argon2Kernel BestArgon2Kernel();
+    /// @throws std::invalid_argument if the CPU can't run the kernel.
+    [[nodiscard]] Argon2FillBlock GetArgon2FillBlock(Argon2Kernel kernel);
+    [[nodiscard]] const char* Argon2KernelName(Argon2Kernel kernel);
+}
@@ -0,0 +1,215 @@
+#include "CodeGenerator.h"
+
+#include <array>
+#include <stdexcept>
+
+namespace
+{
+    constexpr std::array<std::array<uint8_t, 10>, 10> s_DammTable = {{
+        {0, 3, 1, 7, 5, 9, 8, 6, 4, 2},
+        {7, 0, 9, 2, 1, 5, 4, 8, 6, 3},
+        {4, 2, 0, 6, 8, 7, 1, 3, 5, 9},
+        {1, 7, 5, 0, 9, 8, 3, 4, 2, 6},
+        {6, 1, 2, 3, 0, 4, 5, 9, 7, 8},
+        {3, 6, 7, 4, 2, 0, 9, 5, 8, 1},
+        {5, 8, 6, 9, 7, 2, 0, 1, 3, 4},
+        {8, 9, 4, 5, 3, 6, 2, 0, 1, 7},
+        {9, 4, 3, 8, 6, 1, 7, 2, 0, 5},
+        {2, 5, 8, 1, 4, 3, 6, 7, 9, 0},
+    }};
+
+    // Random words fetched per randombytes_buf() call
+    constexpr size_t s_WordBatch = 128;
+
+    void RequireDigits(std::string_view digits)
+    {
+        for (const char c : digits)
+            if (c < '0' || c > '9')
+                throw std::invalid_argument("Check digits are only defined for decimal digits");
+    }
+
+    /// Hands out uniformly distributed words >= rejectBelow, refilling from libsodium a batch at a time.
+    class WordSource
+    {
+    public:
+        explicit WordSource(uint64_t rejectBelow) : rejectBelow(rejectBelow) {}
+        ~WordSource() { sodium_memzero(words.data(), sizeof(words)); }
+
+        uint64_t Next()
+        {
+            while (true)
+            {
+                if (next == words.size())
+                {
+                    randombytes_buf(words.data(), sizeof(words));
+                    next = 0;
+                }
+                const uint64_t word = words[next++];
+                if (word >= rejectBelow)
+                    return word;
+            }
+        }
+
+    private:
+        std::array<uint64_t, s_WordBatch> words{};
+        size_t next = s_WordBatch;
+        const uint64_t rejectBelow;
+    };
+}
+
+char Generator::LuhnCheckDigit(std::string_view digits)
+{
+    RequireDigits(digits);
+
+    // double every second digit, starting with the rightmost payload digit (the check digit goes to its right)
+    unsigned sum = 0;
+    bool doubled = true;
+    for (auto it = digits.rbegin(); it != digits.rend(); ++it, doubled = !doubled)
+    {
+        unsigned digit = (unsigned)(*it - '0');
+        if (doubled)
+        {
+            digit *= 2;
+            if (digit > 9)
+                digit -= 9;
+        }
+        sum += digit;
+    }
+    return (char)('0' + (10 - sum % 10) % 10);
+}
+
+char Generator::DammCheckDigit(std::string_view digits)
+{
+    RequireDigits(digits);
+
+    uint8_t interim = 0;
+    for (const char c : digits)
+        interim = s_DammTable[interim][(size_t)(c - '0')];
+    return (char)('0' + interim);
+}
+
+bool Generator::HasValidCheckDigit(std::string_view code, CheckDigit checkDigit)
+{
+    if (checkDigit == CheckDigit::None)
+        return true;
+    if (code.empty())
+        return false;
+
+    const std::string_view payload = code.substr(0, code.size() - 1);
+    const char expected = checkDigit == CheckDigit::Luhn ? LuhnCheckDigit(payload) : DammCheckDigit(payload);
+    return code.back() == expected;
+}
+
+Generator::CodeGenerator::CodeGenerator(size_t codeLength, std::string alphabet, CheckDigit checkDigit)
+    :
+    codeLength(codeLength),
+    alphabet(std::move(alphabet)),
+    checkDigit(checkDigit)
+{
+    if (this->codeLength == 0)
+        throw std::invalid_argument("Code length must be positive");
+    if (this->alphabet.size() < 2 || this->alphabet.size() > 256)
+        throw std::invalid_argument("Code alphabet must have between 2 and 256 characters");
+
+    std::array<bool, 256> seen{};
+    for (const char c : this->alphabet)
+    {
+        if (seen[(unsigned char)c])
+            throw std::invalid_argument("Code alphabet has repeated characters");
+        seen[(unsigned char)c] = true;
+    }
+    if (checkDigit != CheckDigit::None && this->alphabet != s_NumbersChars)
+        throw std::invalid_argument("Check digits need the decimal alphabet");
+
+    // Pick how many characters to take per word: more per word vs. more rejected words. For base 10, 19 digits per
+    // word would reject 46% of words, 18 digits rejects 2.4%.
+    const uint64_t base = this->alphabet.size();
+    double bestYield = 0;
+    uint64_t power = 1;
+    for (unsigned k = 1; power <= UINT64_MAX / base; k++)
+    {
+        power *= base;
+        const uint64_t rejected = (0 - power) % power; // 2^64 mod base^k
+        const double yield = k * (1.0 - (double)rejected / 18446744073709551616.0);
+        if (yield > bestYield)
+        {
+            bestYield = yield;
+            charactersPerWord = k;
+            rejectBelow = rejected;
+        }
+    }
+}
+
+template <uint64_t Base>
+void Generator::CodeGenerator::FillWithBase(char* out, size_t numCodes) const
+{
+    // a compile-time base turns the divisions below into multiplications
+    const uint64_t base = Base != 0 ? Base : alphabet.size();
+    const size_t stride = CodeLength();
+
+    WordSource source(rejectBelow);
+    uint64_t word = 0;
+    unsigned left = 0;
+    for (size_t c = 0; c < numCodes; c++)
+    {
+        char* code = out + c * stride;
+        for (size_t i = 0; i < codeLength; i++)
+        {
+            if (left == 0)
+            {
+                word = source.Next();
+                left = charactersPerWord;
+            }
+            code[i] = alphabet[word % base];
+            word /= base;
+            left--;
+        }
+
+        if (checkDigit == CheckDigit::Luhn)
+            code[codeLength] = LuhnCheckDigit({ code, codeLength });
+        else if (checkDigit == CheckDigit::Damm)
+            code[codeLength] = DammCheckDigit({ code, codeLength });
+    }
+    sodium_memzero(&word, sizeof(word));
+}
+
+void Generator::CodeGenerator::Fill(char* out, size_t numCodes) const
+{
+    switch (alphabet.size())
+    {
+        case 10:
+            FillWithBase<10>(out, numCodes);
+            break;
+        case 16:
+            FillWithBase<16>(out, numCodes);
+            break;
+        case 36:
+            FillWithBase<36>(out, numCodes);
+            break;
+        default:
+            FillWithBase<0>(out, numCodes);
+            break;
+    }
+}
+
+std::string Generator::CodeGenerator::Generate() const
+{
+    std::string code(CodeLength(), '\0');
+    Fill(code.data(), 1);
+    return code;
+}
+
+std::vector<std::string> Generator::CodeGenerator::Generate(size_t numCodes) const
+{
+    const size_t length = CodeLength();
+    std::vector<char> packed(numCodes * length);
+    Fill(packed.data(), numCodes);
+
+    std::vector<std::string> codes;
+    codes.reserve(numCodes);
+    for (size_t i = 0; i < numCodes; i++)
+        codes.emplace_back(packed.data() + i * length, length);
+
+    sodium_memzero(packed.data(), packed.size());
+    return codes;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Generator.h"
+
+namespace Generator
+{
+    /// Check digit appended to decimal codes.
+    enum class CheckDigit
+    {
+        None,
+        Luhn,
+        Damm
+    };
+
+    class CodeGenerator;
+
+    /// The Luhn (mod 10) digit to append to a string of decimal digits.
+    [[nodiscard]] char LuhnCheckDigit(std::string_view digits);
+    /// The Damm digit to append to a string of decimal digits. Unlike Luhn it catches every adjacent transposition.
+    [[nodiscard]] char DammCheckDigit(std::string_view digits);
+    /// True if the last character of code is the correct check digit for the rest (always true for CheckDigit::None).
+    [[nodiscard]] bool HasValidCheckDigit(std::string_view code, CheckDigit checkDigit);
+}
+
+/// Generator for PINs and one-time codes over a small fixed alphabet. Instead of one random byte per character, it
+/// draws 64-bit words in batches and peels several characters off each word by base conversion. Words from the top
+/// (2^64 mod base^k) of the range are rejected so every character stays exactly uniform.
+/// Output goes straight into caller buffers. Thread-safe: all generation state is on the stack.
+class Generator::CodeGenerator
+{
+public:
+    /**
+     * @param codeLength Random characters per code, not counting the check digit.
+     * @param checkDigit Only allowed with the decimal alphabet.
+     * @throws std::invalid_argument for an alphabet with fewer than 2 or repeated characters, or a zero length.
+     */
+    explicit CodeGenerator(size_t codeLength = 6, std::string alphabet = s_NumbersChars,
+                           CheckDigit checkDigit = CheckDigit::None);
+
+    /// Characters in one code, including the check digit.
+    [[nodiscard]] size_t CodeLength() const { return codeLength + (checkDigit == CheckDigit::None ? 0 : 1); }
+    /// Characters extracted from each accepted random word.
+    [[nodiscard]] unsigned CharactersPerWord() const { return charactersPerWord; }
+
+    /// Writes numCodes codes back to back (no separators) into out, which must hold numCodes * CodeLength() bytes.
+    void Fill(char* out, size_t numCodes) const;
+
+    [[nodiscard]] std::string Generate() const;
+    [[nodiscard]] std::vector<std::string> Generate(size_t numCodes) const;
+
+private:
+    template <uint64_t Base>
+    void FillWithBase(char* out, size_t numCodes) const;
+
+    size_t codeLength;
+    std::string alphabet;
+    CheckDigit checkDigit;
+    unsigned charactersPerWord = 1;
+    /// Words below this are rejected; 2^64 - threshold is a multiple of base^charactersPerWord.
+    uint64_t rejectBelow = 0;
+};
@@ -0,0 +1,256 @@
+#include "CompiledPolicy.h"
+
+#include <cmath>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "WeightedAlphabet.h"
+
+namespace
+{
+    constexpr size_t s_CacheCapacity = 256;
+    /// Most random bytes FillAdvanced() draws per call
+    constexpr size_t s_RandomBatchBytes = 16 * 1024;
+    const std::string s_NoCharactersError = "No valid characters available for password generation";
+
+    /// Most recently used compiled policies, front = newest.
+    struct PolicyCache
+    {
+        std::mutex mutex;
+        std::list<std::shared_ptr<const Generator::CompiledPolicy>> entries;
+        std::unordered_map<size_t, decltype(entries)::iterator> index;
+    };
+
+    PolicyCache& Cache()
+    {
+        static PolicyCache cache;
+        return cache;
+    }
+
+    template <typename T>
+    void Combine(size_t& seed, const T& value)
+    {
+        seed ^= std::hash<T>{}(value) + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+    }
+
+    std::string WithoutExcluded(const std::string& characters, const std::bitset<256>& excluded)
+    {
+        std::string allowed;
+        for (const char c : characters)
+            if (!excluded[(unsigned char)c])
+                allowed.push_back(c);
+        return allowed;
+    }
+}
+
+size_t Generator::HashPolicy(const PasswordPolicy& policy)
+{
+    size_t seed = 0;
+    Combine(seed, policy.passwordLength);
+    Combine(seed, policy.requireLowercase);
+    Combine(seed, policy.requireUppercase);
+    Combine(seed, policy.requireNumbers);
+    Combine(seed, policy.requireSymbols);
+    Combine(seed, policy.excludedCharacters);
+    for (const CharacterClassRule& rule : policy.classRules)
+    {
+        Combine(seed, rule.weight);
+        Combine(seed, rule.minCount);
+        Combine(seed, rule.maxCount);
+    }
+    for (const auto& [c, weight] : policy.characterWeights)
+    {
+        Combine(seed, c);
+        Combine(seed, weight);
+    }
+    return seed;
+}
+
+Generator::PasswordPolicy Generator::GenerationPolicy(const PasswordPolicy& policy)
+{
+    PasswordPolicy generation = policy;
+    const PasswordPolicy defaults;
+    generation.encryptionStrength = defaults.encryptionStrength;
+    generation.hashAlgorithm = defaults.hashAlgorithm;
+    generation.hashCost = defaults.hashCost;
+    generation.useArgon2Engine = defaults.useArgon2Engine;
+    return generation;
+}
+
+std::shared_ptr<const Generator::CompiledPolicy> Generator::CompiledPolicy::Get(const PasswordPolicy& fullPolicy)
+{
+    PolicyCache& cache = Cache();
+    const PasswordPolicy policy = GenerationPolicy(fullPolicy);
+    const size_t key = HashPolicy(policy);
+    {
+        std::lock_guard lock(cache.mutex);
+        const auto found = cache.index.find(key);
+        if (found != cache.index.end() && (*found->second)->Policy() == policy)
+        {
+            cache.entries.splice(cache.entries.begin(), cache.entries, found->second);
+            return *found->second;
+        }
+    }
+
+    // compile outside the lock; two threads racing on the same new policy just both compile it
+    auto compiled = std::make_shared<const CompiledPolicy>(policy);
+
+    std::lock_guard lock(cache.mutex);
+    const auto found = cache.index.find(key);
+    if (found != cache.index.end())
+        cache.entries.erase(found->second);
+    cache.entries.push_front(compiled);
+    cache.index[key] = cache.entries.begin();
+    while (cache.entries.size() > s_CacheCapacity)
+    {
+        cache.index.erase(HashPolicy(cache.entries.back()->Policy()));
+        cache.entries.pop_back();
+    }
+    return compiled;
+}
+
+size_t Generator::CompiledPolicy::CacheSize()
+{
+    PolicyCache& cache = Cache();
+    std::lock_guard lock(cache.mutex);
+    return cache.entries.size();
+}
+
+Generator::CompiledPolicy::CompiledPolicy(PasswordPolicy policy)
+    :
+    policy(GenerationPolicy(policy))
+{
+    const PasswordPolicy& p = this->policy;
+    for (const char c : p.excludedCharacters)
+        excluded[(unsigned char)c] = true;
+
+    // simple tier: printable ASCII or a-z
+    for (char c = 33; c <= 126; c++)
+        if (!excluded[(unsigned char)c])
+            simpleAlphabet.push_back(c);
+    intelligibleAlphabet = WithoutExcluded(s_LowerCaseChars, excluded);
+    if (!intelligibleAlphabet.empty() && intelligibleAlphabet.size() < s_LowerCaseChars.size())
+        pronounceable = std::make_shared<const PronounceableModel>(PronounceableModel::English().Without(p.excludedCharacters));
+
+    // intermediate tier: one alphabet per enabled class that has characters left
+    const std::array<std::pair<bool, const std::string*>, 4> classes = {{
+        { p.requireLowercase, &s_LowerCaseChars }, { p.requireUppercase, &s_UpperCaseChars },
+        { p.requireNumbers, &s_NumbersChars }, { p.requireSymbols, &s_SymbolsChars } }};
+    for (const auto& [enabled, characters] : classes)
+    {
+        if (!enabled)
+            continue;
+        std::string allowed = WithoutExcluded(*characters, excluded);
+        if (!allowed.empty())
+            classAlphabets.push_back(std::move(allowed));
+    }
+
+    // advanced tier
+    if (p.HasCharacterRules())
+    {
+        weightedAlphabet = std::make_shared<const WeightedAlphabet>(p);
+        advancedAlphabet = weightedAlphabet->Characters();
+    }
+    else
+    {
+        for (const std::string& allowed : classAlphabets)
+            advancedAlphabet += allowed;
+    }
+
+    if (advancedAlphabet.empty())
+    {
+        error = s_NoCharactersError;
+        return;
+    }
+    rejectFrom = 256 - 256 % (unsigned)advancedAlphabet.size();
+    for (unsigned b = 0; b < 256; b++)
+        byteToChar[b] = advancedAlphabet[b % advancedAlphabet.size()];
+}
+
+const Generator::PronounceableModel& Generator::CompiledPolicy::Pronounceable() const
+{
+    if (intelligibleAlphabet.empty())
+        throw std::runtime_error(s_NoCharactersError);
+    return pronounceable ? *pronounceable : PronounceableModel::English();
+}
+
+void Generator::CompiledPolicy::FillSimple(char* out, bool intelligible, std::mt19937_64& rng) const
+{
+    const std::string& alphabet = intelligible ? intelligibleAlphabet : simpleAlphabet;
+    if (alphabet.empty())
+        throw std::runtime_error(s_NoCharactersError);
+
+    std::uniform_int_distribution<size_t> dist(0, alphabet.size() - 1);
+    for (uint64_t i = 0; i < policy.passwordLength; i++)
+        out[i] = alphabet[dist(rng)];
+}
+
+void Generator::CompiledPolicy::FillIntermediate(char* out, std::mt19937_64& rng) const
+{
+    if (classAlphabets.empty())
+        throw std::runtime_error(s_NoCharactersError);
+
+    std::uniform_int_distribution<size_t> groupDist(0, classAlphabets.size() - 1);
+    for (uint64_t i = 0; i < policy.passwordLength; i++)
+    {
+        const std::string& group = classAlphabets[groupDist(rng)];
+        std::uniform_int_distribution<size_t> dist(0, group.size() - 1);
+        out[i] = group[dist(rng)];
+    }
+}
+
+double Generator::CompiledPolicy::DistinctAdvancedBits() const
+{
+    if (weightedAlphabet)
+        return weightedAlphabet->DistinctBits(policy.passwordLength);
+    return (double)policy.passwordLength * std::log2((double)advancedAlphabet.size());
+}
+
+void Generator::CompiledPolicy::FillAdvanced(char* out) const
+{
+    FillAdvanced(out, 1, policy.passwordLength);
+}
+
+void Generator::CompiledPolicy::FillAdvanced(char* out, size_t count, size_t stride) const
+{
+    if (!error.empty())
+        throw std::runtime_error(error);
+
+    const size_t length = policy.passwordLength;
+    if (weightedAlphabet)
+    {
+        weightedAlphabet->Fill(out, count, stride, length);
+        return;
+    }
+
+    // Bytes at or above rejectFrom are skipped, so characters come from a stream of random bytes drawn in batches
+    // sized to what is still needed (256 / rejectFrom bytes per character on average).
+    std::array<unsigned char, s_RandomBatchBytes> random;
+    // batches shrink towards the end, so the wipe covers the largest one rather than the last
+    size_t available = 0, next = 0, drawn = 0;
+    uint64_t remaining = (uint64_t)count * length;
+    for (size_t r = 0; r < count; r++)
+    {
+        char* record = out + r * stride;
+        for (size_t i = 0; i < length; i++, remaining--)
+        {
+            unsigned char value;
+            do
+            {
+                if (next == available)
+                {
+                    available = (size_t)std::min<uint64_t>(random.size(), remaining * 256 / rejectFrom + 8);
+                    randombytes_buf(random.data(), available);
+                    drawn = std::max(drawn, available);
+                    next = 0;
+                }
+                value = random[next++];
+            } while (value >= rejectFrom);
+            record[i] = byteToChar[value];
+        }
+    }
+    sodium_memzero(random.data(), drawn);
+}
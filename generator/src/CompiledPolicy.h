@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Generator.h"
+#include "Pronounceable.h"
+
+namespace Generator
+{
+    class CompiledPolicy;
+
+    /// Hash over the fields of a policy that affect generation, used to key the compiled policy cache.
+    [[nodiscard]] size_t HashPolicy(const PasswordPolicy& policy);
+    /// The policy with its hashing fields (strength, algorithm, cost, engine) reset to their defaults. Policies that
+    /// only differ in how they hash compile to the same thing, so they share one cache entry.
+    [[nodiscard]] PasswordPolicy GenerationPolicy(const PasswordPolicy& policy);
+}
+
+/// Everything the generation functions need from a PasswordPolicy, worked out once: the allowed character bitmap, the
+/// alphabet of each generation tier, the byte-to-character map and rejection threshold of the advanced tier, and the
+/// weighted tables when the policy has class rules. Immutable, so one instance can be shared between threads and
+/// generators. Get() caches instances by policy, so switching between a set of policies doesn't rebuild anything.
+class Generator::CompiledPolicy
+{
+public:
+    /**
+     * Compiled policy for the given policy, from the cache when an equal policy was compiled recently.
+     * @throws std::invalid_argument if the policy's class rules or character weights contradict each other.
+     */
+    [[nodiscard]] static std::shared_ptr<const CompiledPolicy> Get(const PasswordPolicy& policy);
+
+    /// Compiled policies currently held by the cache.
+    [[nodiscard]] static size_t CacheSize();
+
+    /// Compiles without the cache. Prefer Get().
+    explicit CompiledPolicy(PasswordPolicy policy);
+
+    /// The compiled GenerationPolicy(): hashing fields are at their defaults whatever the caller's policy had.
+    [[nodiscard]] const PasswordPolicy& Policy() const { return policy; }
+
+    /// Why intermediate and advanced generation can't produce a password under this policy (no usable characters),
+    /// or empty if they can. Generation throws std::runtime_error with this message.
+    [[nodiscard]] const std::string& Error() const { return error; }
+
+    /// log2 of the number of distinct passwords GenerateAdvancedPassword() can produce, class min/max counts included.
+    [[nodiscard]] double DistinctAdvancedBits() const;
+
+    /// Characters GenerateAdvancedPassword() can emit.
+    [[nodiscard]] const std::string& AdvancedAlphabet() const { return advancedAlphabet; }
+    [[nodiscard]] bool IsExcluded(char c) const { return excluded[(unsigned char)c]; }
+
+    /// The pronounceable model with the policy's excluded letters removed.
+    /// @throws std::runtime_error if every letter is excluded.
+    [[nodiscard]] const PronounceableModel& Pronounceable() const;
+
+    /// Each Fill writes Policy().passwordLength characters into out.
+    void FillSimple(char* out, bool intelligible, std::mt19937_64& rng) const;
+    void FillIntermediate(char* out, std::mt19937_64& rng) const;
+    void FillAdvanced(char* out) const;
+    /// FillAdvanced() for count records, record i starting at out + i * stride. Random bytes are drawn for many
+    /// records per call, which matters because every libsodium randombytes call can be a getrandom() syscall.
+    /// Use this for bulk output rather than looping over FillAdvanced(out).
+    void FillAdvanced(char* out, size_t count, size_t stride) const;
+
+private:
+    PasswordPolicy policy;
+    std::string error;
+    std::bitset<256> excluded;
+
+    std::string simpleAlphabet;
+    std::string intelligibleAlphabet;
+    /// Enabled classes that still have characters after exclusions, for the intermediate tier.
+    std::vector<std::string> classAlphabets;
+
+    std::string advancedAlphabet;
+    /// Random bytes at or above this are redrawn, so the byte -> character map below is unbiased.
+    unsigned rejectFrom = 256;
+    std::array<char, 256> byteToChar{};
+
+    std::shared_ptr<const WeightedAlphabet> weightedAlphabet;
+    /// Only built when the policy excludes letters; otherwise the shared English model is used.
+    std::shared_ptr<const PronounceableModel> pronounceable;
+};
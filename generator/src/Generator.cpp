@@ -3,104 +3,43 @@
 #include <sodium.h>
 #include <tuple>
 
+#include "Argon2Engine.h"
+#include "CompiledPolicy.h"
+#include "Pronounceable.h"
+#include "Trace.h"
+#include "UniqueSet.h"
+
+Generator::PasswordGenerator::PasswordGenerator(PasswordPolicy policy)
+    :
+    policy(std::move(policy)),
+    compiled(CompiledPolicy::Get(this->policy))
+{
+}
+
+void Generator::PasswordGenerator::SetPolicy(const PasswordPolicy& newPolicy)
+{
+    // compile (and validate) before touching the current policy
+    compiled = CompiledPolicy::Get(newPolicy);
+    policy = newPolicy;
+}
+
 std::string Generator::PasswordGenerator::GenerateSimplePassword(bool intelligible) const
 {
-    std::string password;
+    std::string password(policy.passwordLength, '\0');
 
     std::random_device rd;
     auto rng = std::mt19937_64(rd());
-
-    if (intelligible)
-    {
-        std::uniform_int_distribution<int> dist('a', 'a' + 25); // ASCII letters range
-
-        for (uint64_t i = 0; i < policy.passwordLength; i++)
-        {
-            char c = (char)dist(rng);
-            while (policy.excludedCharacters.find(c) != std::string::npos)
-                c = (char)dist(rng);
-
-            password.push_back(c);
-        }
-    }
-    else
-    {
-        std::uniform_int_distribution<int> dist(33, 126); // ASCII full range
-
-        for (size_t i = 0; i < policy.passwordLength; i++)
-        {
-            char c = (char)dist(rng);
-            while (policy.excludedCharacters.find(c) != std::string::npos)
-                c = (char)dist(rng);
-
-            password.push_back(c);
-        }
-    }
+    compiled->FillSimple(password.data(), intelligible, rng);
 
     return password;
 }
 
 std::string Generator::PasswordGenerator::GenerateIntermediatePassword() const {
-    std::string password;
+    std::string password(policy.passwordLength, '\0');
 
     std::random_device rd;
     auto rng = std::mt19937_64(rd());
-
-    std::uniform_int_distribution<short> groupDist(0, 3); // we have 4 categories, lowercase, uppercase, numbers, and symbols
-
-    for (uint64_t i = 0; i < policy.passwordLength; i++)
-    {
-        short charGroup = groupDist(rng);
-
-        // this is bad code. in fact, this whole function sucks. but I'm not going to refactor it because GenerateAdvancedPassword() exists
-        while (charGroup == 0 && !policy.requireLowercase)
-            charGroup = groupDist(rng);
-        while (charGroup == 1 && !policy.requireUppercase)
-            charGroup = groupDist(rng);
-        while (charGroup == 2 && !policy.requireNumbers)
-            charGroup = groupDist(rng);
-        while (charGroup == 3 && !policy.requireSymbols)
-            charGroup = groupDist(rng);
-
-
-        switch (charGroup)
-        {
-            case 0: {
-                std::uniform_int_distribution<size_t> dist(0, s_LowerCaseChars.length() - 1);
-                char c = s_LowerCaseChars[dist(rng)];
-                while (policy.excludedCharacters.find(c) != std::string::npos)
-                    c = s_LowerCaseChars[dist(rng)];
-                password.push_back(s_LowerCaseChars[c]);
-                break;
-            }
-            case 1: {
-                std::uniform_int_distribution<size_t> dist(0, s_UpperCaseChars.length() - 1);
-                char c = s_UpperCaseChars[dist(rng)];
-                while (policy.excludedCharacters.find(c) != std::string::npos)
-                    c = s_UpperCaseChars[dist(rng)];
-                password.push_back(s_UpperCaseChars[c]);
-                break;
-            }
-            case 2: {
-                std::uniform_int_distribution<size_t> dist(0, s_NumbersChars.length() - 1);
-                char c = s_NumbersChars[dist(rng)];
-                while (policy.excludedCharacters.find(c) != std::string::npos)
-                    c = s_NumbersChars[dist(rng)];
-                password.push_back(s_NumbersChars[c]);
-                break;
-            }
-            case 3: {
-                std::uniform_int_distribution<size_t> dist(0, s_SymbolsChars.length() - 1);
-                char c = s_SymbolsChars[dist(rng)];
-                while (policy.excludedCharacters.find(c) != std::string::npos)
-                    c = s_SymbolsChars[dist(rng)];
-                password.push_back(s_SymbolsChars[c]);
-                break;
-            }
-            default:
-                std::cerr << "invalid char group";
-        }
-    }
+    compiled->FillIntermediate(password.data(), rng);
 
     // compiler does Return Value Optimization automatically, no need for std::move
     return password;
@@ -114,45 +53,10 @@ std::future<std::vector<std::string>> Generator::PasswordGenerator::GenerateInte
 
 std::string Generator::PasswordGenerator::GenerateAdvancedPassword() const
 {
-    std::string password;
-    std::vector<char> availableChars;
-
-    // Build a pool of characters based on the policy
-    if (policy.requireLowercase)
-    {
-        availableChars.insert(availableChars.end(), s_LowerCaseChars.begin(), s_LowerCaseChars.end());
-    }
-    if (policy.requireUppercase)
-    {
-        availableChars.insert(availableChars.end(), s_UpperCaseChars.begin(), s_UpperCaseChars.end());
-    }
-    if (policy.requireNumbers)
-    {
-        availableChars.insert(availableChars.end(), s_NumbersChars.begin(), s_NumbersChars.end());
-    }
-    if (policy.requireSymbols)
-    {
-        availableChars.insert(availableChars.end(), s_SymbolsChars.begin(), s_SymbolsChars.end());
-    }
-
-    // Remove excluded characters
-    std::erase_if(availableChars, [this](const char& c) {
-                      return policy.excludedCharacters.find(c) != std::string::npos;
-                  });
-
-    if (availableChars.empty()) {
-        throw std::runtime_error("No valid characters available for password generation");
-    }
-
+    const Trace::Span span("generate", "GenerateAdvancedPassword");
     // Generate password respecting the required length
-    for (uint64_t i = 0; i < policy.passwordLength; i++)
-    {
-        unsigned char randomIndex;
-        randombytes_buf(&randomIndex, sizeof(randomIndex)); // Generate a random index
-        randomIndex %= availableChars.size();                   // Map to available characters
-        password += availableChars[randomIndex];
-    }
-
+    std::string password(policy.passwordLength, '\0');
+    compiled->FillAdvanced(password.data());
     return password;
 }
 
@@ -162,29 +66,65 @@ std::future<std::vector<std::string>> Generator::PasswordGenerator::GenerateAdva
     return std::async(std::launch::async, &Generator::PasswordGenerator::GenerateAdvancedPasswords, this, numPasswords);
 }
 
+std::tuple<std::string, double> Generator::PasswordGenerator::GeneratePronounceablePassword() const
+{
+    return compiled->Pronounceable().Generate(policy.passwordLength);
+}
+
+std::vector<std::string> Generator::PasswordGenerator::GenerateUniqueAdvancedPasswords(size_t numPasswords) const
+{
+    const size_t length = policy.passwordLength;
+    std::vector<char> packed(numPasswords * length);
+    GenerateUniqueAdvancedPasswordsInto(packed.data(), numPasswords);
+
+    std::vector<std::string> passwords;
+    passwords.reserve(numPasswords);
+    for (size_t i = 0; i < numPasswords; i++)
+        passwords.emplace_back(packed.data() + i * length, length);
+
+    sodium_memzero(packed.data(), packed.size());
+    return passwords;
+}
+
+void Generator::PasswordGenerator::GenerateUniqueAdvancedPasswordsInto(char* out, size_t numPasswords) const
+{
+    const Trace::Span span("generate", "GenerateUniqueAdvancedPasswords");
+    if (!compiled->Error().empty())
+        throw std::runtime_error(compiled->Error());
+
+    // compare in log space; class min/max counts shrink the space well below alphabet^length
+    if (numPasswords > 1 && compiled->DistinctAdvancedBits() < std::log2((double)numPasswords))
+        throw std::invalid_argument("Policy can't produce that many distinct passwords");
+
+    // Even a space big enough can take long to exhaust under skewed weights. A uniform draw needs about numPasswords
+    // tries for the very last password, so this many in a row only fail by chance with odds around e^-64.
+    const size_t maxAttempts = 64 * numPasswords + 1024;
+    FixedLengthUniqueSet seen(out, policy.passwordLength, numPasswords);
+    for (size_t i = 0; i < numPasswords; i++)
+    {
+        // regenerate in place until the password is new; only collisions pay for a second draw
+        size_t attempts = 0;
+        do
+        {
+            if (attempts++ == maxAttempts)
+                throw std::runtime_error("Policy ran out of distinct passwords");
+            compiled->FillAdvanced(out + i * policy.passwordLength);
+        } while (!seen.Insert(i));
+    }
+}
+
 std::tuple<std::string, std::string> Generator::PasswordGenerator::GenerateHashedPassword() const
 {
     std::string password = GenerateAdvancedPassword();
-    char encryptedPw[crypto_pwhash_STRBYTES];
-    const int hashSuccess = crypto_pwhash_str(encryptedPw, password.c_str(), password.length(),
-        sodiumOpsLimitFromEncryptionStrength(policy.encryptionStrength), sodiumMemLimitFromEncryptionStrength(policy.encryptionStrength));
-    if (hashSuccess == -1)
-        throw std::runtime_error("Failed to encrypt password");
-    std::string encryptedPassword(encryptedPw);
+    std::string encryptedPassword = HashPassword(password);
 
     return std::make_tuple(std::move(password), std::move(encryptedPassword));
 }
 
 std::string Generator::PasswordGenerator::HashPassword(const std::string& password) const
 {
-    char encryptedPw[crypto_pwhash_STRBYTES];
-    const int hashSuccess = crypto_pwhash_str(encryptedPw, password.c_str(), password.length(),
-        sodiumOpsLimitFromEncryptionStrength(policy.encryptionStrength), sodiumMemLimitFromEncryptionStrength(policy.encryptionStrength));
-    if (hashSuccess == -1)
-        throw std::runtime_error("Failed to encrypt password");
-
-    std::string encryptedPassword(encryptedPw);
-    return encryptedPassword;
+    const Trace::Span span("hash", "HashPassword");
+    return WithPolicyEngine(GetHashingBackend(policy.hashAlgorithm)).Hash(password, policy.GetHashCost());
 }
 
 std::string Generator::PasswordGenerator::HashPasswordSafe(std::string password) const
@@ -195,7 +135,10 @@ std::string Generator::PasswordGenerator::HashPasswordSafe(std::string password)
         throw std::invalid_argument("Password cannot be empty");
     }
 
-    sodium_mlock(&password[0], password.length());
+    {
+        const Trace::Span span("memory", "sodium_mlock");
+        sodium_mlock(&password[0], password.length());
+    }
     std::string hashedPassword = HashPassword(password);
     sodium_munlock(&password[0], password.length());
     return hashedPassword;
@@ -207,9 +150,19 @@ std::future<std::vector<std::string>> Generator::PasswordGenerator::HashPassword
     return std::async(std::launch::async, &Generator::PasswordGenerator::HashPasswordsSafe, this, std::move(passwords));
 }
 
+const Generator::HashingBackend& Generator::PasswordGenerator::WithPolicyEngine(const HashingBackend& backend) const
+{
+    if (policy.useArgon2Engine && backend.Algorithm() == HashAlgorithm::Argon2id)
+        return GetArgon2EngineBackend();
+    return backend;
+}
+
 bool Generator::PasswordGenerator::VerifyPassword(const std::string& password, const std::string& hash) const // NOLINT(*-convert-member-functions-to-static)
 {
-    return crypto_pwhash_str_verify(hash.c_str(), password.c_str(), password.length()) == 0;
+    const Trace::Span span("verify", "VerifyPassword");
+    // dispatch on the hash's own prefix, so hashes made under an older policy still verify
+    const HashingBackend* backend = FindHashingBackend(hash);
+    return backend && WithPolicyEngine(*backend).Verify(password, hash);
 }
 
 bool Generator::PasswordGenerator::VerifyPasswordSafe(std::string password, const std::string& hash) const
@@ -220,8 +173,17 @@ bool Generator::PasswordGenerator::VerifyPasswordSafe(std::string password, cons
         throw std::invalid_argument("Password cannot be empty");
     }
 
-    sodium_mlock(&password[0], password.length());
+    {
+        const Trace::Span span("memory", "sodium_mlock");
+        sodium_mlock(&password[0], password.length());
+    }
     bool result = VerifyPassword(password, hash);
     sodium_munlock(&password[0], password.length());
     return result;
+}
+
+bool Generator::PasswordGenerator::NeedsRehash(const std::string& hash) const
+{
+    const HashingBackend* backend = FindHashingBackend(hash);
+    return !backend || backend->Algorithm() != policy.hashAlgorithm || backend->NeedsRehash(hash, policy.GetHashCost());
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <string>
 
@@ -10,6 +11,12 @@
 
 #include <sodium.h>
 #include <tuple>
+#include <optional>
+#include <array>
+#include <map>
+#include <memory>
+
+#include "HashingBackend.h"
 
 namespace Generator
 {
@@ -18,8 +25,20 @@ namespace Generator
     static const std::string s_NumbersChars = "0123456789";
     static const std::string s_SymbolsChars = "!@#$%^&*()_+=-[]{}|;':\",./<>?";
 
+    struct CharacterClassRule;
     struct PasswordPolicy;
     class PasswordGenerator;
+    class WeightedAlphabet;
+    class CompiledPolicy;
+
+    /// Index into PasswordPolicy::classRules
+    enum class CharacterClass
+    {
+        Lowercase,
+        Uppercase,
+        Numbers,
+        Symbols
+    };
 
     enum class EncryptionStrength
     {
@@ -58,6 +77,25 @@ namespace Generator
         }
     }
 
+    /// Reads the memory cost (in bytes) out of an encoded argon2 hash ("...$m=65536,t=2,p=1$..."), so callers can
+    /// budget for a verification before running it. Returns 0 if the hash has no memory parameter, SIZE_MAX if the
+    /// parameter doesn't fit in a size_t (a crafted hash mustn't look cheap).
+    inline size_t sodiumMemLimitFromHash(const std::string& hash)
+    {
+        const size_t pos = hash.find("$m=");
+        if (pos == std::string::npos)
+            return 0;
+
+        size_t kibibytes = 0;
+        for (size_t i = pos + 3; i < hash.length() && hash[i] >= '0' && hash[i] <= '9'; i++)
+        {
+            if (kibibytes > (SIZE_MAX / 1024 - 9) / 10)
+                return SIZE_MAX;
+            kibibytes = kibibytes * 10 + (size_t)(hash[i] - '0');
+        }
+        return kibibytes * 1024;
+    }
+
     inline double CalculatePasswordEntropy(const std::string& password)
     {
         size_t pool = 0;
@@ -76,6 +114,19 @@ namespace Generator
 
 }
 
+/// Frequency and count limits for one character class of a policy
+struct Generator::CharacterClassRule
+{
+    /// Share of the password this class gets, relative to the other classes' weights. Only used once some class has a
+    /// non-zero weight; a class left at 0 then only contributes its minCount characters.
+    uint32_t weight = 0;
+    /// Characters of this class every password contains at least / at most.
+    uint64_t minCount = 0;
+    uint64_t maxCount = UINT64_MAX;
+
+    bool operator==(const CharacterClassRule&) const = default;
+};
+
 /// A multitude of parameters to generate passwords using
 struct Generator::PasswordPolicy
 {
@@ -98,6 +149,41 @@ struct Generator::PasswordPolicy
     bool requireSymbols = true;
     std::string excludedCharacters;
     EncryptionStrength encryptionStrength = EncryptionStrength::Low;
+    /// Which backend HashPassword() uses. Verification always follows the stored hash's own algorithm.
+    HashAlgorithm hashAlgorithm = HashAlgorithm::Argon2id;
+    /// Explicit cost parameters for the backend. When unset, they come from encryptionStrength.
+    std::optional<HashCost> hashCost;
+    /// Run argon2id on the in-library Argon2Engine (vectorized, per-thread reused memory) instead of libsodium.
+    /// The hashes are identical either way, so this can be flipped without rehashing anything.
+    bool useArgon2Engine = false;
+
+    /// Per-class weights and min/max counts for GenerateAdvancedPassword(), indexed by CharacterClass.
+    std::array<CharacterClassRule, 4> classRules{};
+    /// Relative weight of single characters within their class (default 1, 0 removes the character).
+    std::map<char, uint32_t> characterWeights;
+
+    /// True if advanced generation has to honour classRules or characterWeights instead of drawing uniformly.
+    [[nodiscard]] bool HasCharacterRules() const
+    {
+        return !characterWeights.empty() || classRules != std::array<CharacterClassRule, 4>{};
+    }
+
+    [[nodiscard]] const CharacterClassRule& GetClassRule(CharacterClass characterClass) const
+    {
+        return classRules[(size_t)characterClass];
+    }
+    [[nodiscard]] CharacterClassRule& GetClassRule(CharacterClass characterClass)
+    {
+        return classRules[(size_t)characterClass];
+    }
+
+    bool operator==(const PasswordPolicy&) const = default;
+
+    /// The cost parameters hashing under this policy uses.
+    [[nodiscard]] HashCost GetHashCost() const
+    {
+        return hashCost ? *hashCost : GetHashingBackend(hashAlgorithm).CostFor(encryptionStrength);
+    }
 };
 
 /// Class for generating passwords. Only member is a password policy.
@@ -105,19 +191,20 @@ struct Generator::PasswordPolicy
 class Generator::PasswordGenerator
 {
 public:
-    explicit PasswordGenerator(PasswordPolicy policy)
-        :
-        policy(std::move(policy))
-    {
-    }
+    /// @throws std::invalid_argument if the policy's class rules or character weights can't be satisfied.
+    explicit PasswordGenerator(PasswordPolicy policy);
 
     /**
      * Updates the current password policy with a new policy definition.
      * @param newPolicy The new password policy to be set, which defines rules for the password generation
+     * @throws std::invalid_argument if the policy's class rules or character weights can't be satisfied.
      */
-    inline void SetPolicy(const PasswordPolicy& newPolicy) { policy = newPolicy;}
+    void SetPolicy(const PasswordPolicy& newPolicy);
     /// Update specifically the encryption strength of the policy
     inline void SetPolicyEncryptionStrength(EncryptionStrength newEncryptionStrength) { policy.encryptionStrength = newEncryptionStrength; }
+    [[nodiscard]] inline const PasswordPolicy& GetPolicy() const { return policy; }
+    /// The compiled form of the policy. CompiledPolicy::Error() tells whether generation can succeed.
+    [[nodiscard]] inline const std::shared_ptr<const CompiledPolicy>& GetCompiledPolicy() const { return compiled; }
 
     /**
      * Generates a simple password based on the current policy (only password length is used).
@@ -150,6 +237,9 @@ public:
 
     /**
      * Generates an advanced password adhering to the current password policy. It uses libsodium to randomly generate characters.
+     * If the policy has class rules or character weights, characters are drawn from a weighted alias table built once
+     * per policy and the min/max counts are enforced.
+     * @throws std::runtime_error if the policy leaves no characters to draw from.
      * @return A randomly generated advanced password as a string.
      */
     [[nodiscard]] std::string GenerateAdvancedPassword() const;
@@ -167,13 +257,35 @@ public:
     [[nodiscard]] std::future<std::vector<std::string>> GenerateAdvancedPasswordsAsync(
         int numPasswords) const;
 
-    /** Encrypts a password using libsodium crypto_pwhash_str. The password is generated from GenerateIntermediatePassword
+    /**
+     * Generates a pronounceable lowercase password of policy.passwordLength letters from an English letter-pair Markov
+     * model. Excluded characters are respected; the other character class flags are ignored.
+     * @return The password and its exact entropy in bits under the model (lower than a uniform a-z password).
+     */
+    [[nodiscard]] std::tuple<std::string, double> GeneratePronounceablePassword() const;
+
+    /**
+     * Like GenerateAdvancedPasswords(), but no password appears twice in the result. Duplicates are caught by a
+     * compact hash set as they are generated and only the colliding password is regenerated.
+     * @throws std::invalid_argument if the policy can't produce numPasswords distinct passwords.
+     * @throws std::runtime_error if a new password still wasn't found after many draws, which only happens in practice
+     *         when the policy's weights make some of its passwords vanishingly unlikely.
+     */
+    [[nodiscard]] std::vector<std::string> GenerateUniqueAdvancedPasswords(size_t numPasswords) const;
+
+    /**
+     * Packed version of GenerateUniqueAdvancedPasswords() for very large batches: writes numPasswords distinct
+     * passwords back to back (no separators) into out, which must hold numPasswords * passwordLength bytes.
+     */
+    void GenerateUniqueAdvancedPasswordsInto(char* out, size_t numPasswords) const;
+
+    /** Encrypts a password using HashPassword(). The password is generated from GenerateAdvancedPassword
      * @returns The generated password and the hashed password
      */
     [[nodiscard]] std::tuple<std::string, std::string> GenerateHashedPassword() const;
 
     /**
-     * Hash a password using libsodium.
+     * Hash a password using the policy's hashing backend (argon2id by default).
      * @returns The hashed password
      */
     [[nodiscard]] std::string HashPassword(const std::string& password) const;
@@ -208,7 +320,15 @@ public:
     /// to destroy your password string, then don't use std::move(). otherwise, move it.
     [[nodiscard]] bool VerifyPasswordSafe(std::string password, const std::string& hash) const;
 
+    /// True if the hash was not made with the current policy's algorithm and cost, i.e. it should be replaced with a
+    /// fresh hash the next time the plaintext is available.
+    [[nodiscard]] bool NeedsRehash(const std::string& hash) const;
+
 private:
-    PasswordPolicy policy;
+    /// The backend to actually run: Argon2Engine in place of libsodium's argon2id when the policy asks for it.
+    [[nodiscard]] const HashingBackend& WithPolicyEngine(const HashingBackend& backend) const;
 
+    PasswordPolicy policy;
+    /// Alphabets and tables of the policy, shared through the compiled policy cache.
+    std::shared_ptr<const CompiledPolicy> compiled;
 };
\ No newline at end of file
@@ -0,0 +1,335 @@
+#include "HashJob.h"
+
+#if !defined(_WIN32)
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <sodium.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+
+#include "WireFormat.h"
+
+namespace
+{
+    constexpr uint32_t s_Magic = 0x4A484750; // "PGHJ"
+    constexpr uint32_t s_FormatVersion = 2;
+    constexpr size_t s_ChecksumBytes = crypto_generichash_BYTES_MIN;
+    constexpr size_t s_FingerprintBytes = crypto_generichash_BYTES;
+    /// A chunk record is one Wire frame: chunk number and length, then every hash with its length prefix. Every
+    /// backend's hash string is shorter than crypto_pwhash_STRBYTES, the largest of them.
+    constexpr uint64_t s_ChunkRecordBytes = 2 * sizeof(uint64_t);
+    constexpr uint64_t s_HashRecordBytes = sizeof(uint32_t) + crypto_pwhash_STRBYTES;
+    constexpr uint64_t s_MaxChunkSize = (Generator::Wire::MaxFrameBytes - s_ChunkRecordBytes) / s_HashRecordBytes;
+
+    struct Header
+    {
+        uint64_t totalItems = 0;
+        uint64_t chunkSize = 0;
+        std::string fingerprint;
+
+        [[nodiscard]] uint64_t TotalChunks() const { return (totalItems + chunkSize - 1) / chunkSize; }
+        [[nodiscard]] uint64_t ChunkLength(uint64_t chunk) const
+        {
+            return std::min(chunkSize, totalItems - chunk * chunkSize);
+        }
+    };
+
+    [[noreturn]] void ThrowErrno(const std::string& what, const std::string& path)
+    {
+        throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    /// Identifies the shape of the input, so a journal can't be resumed with a different set. Only the count and the
+    /// password lengths go in: a digest of the plaintexts would be a fast offline oracle for them, sitting next to the
+    /// hashes. Resuming also verifies one journaled hash against its password, which catches same-shape inputs.
+    std::string Fingerprint(const std::vector<std::string>& passwords, uint64_t chunkSize)
+    {
+        crypto_generichash_state state;
+        crypto_generichash_init(&state, nullptr, 0, s_FingerprintBytes);
+        const uint64_t count = passwords.size();
+        crypto_generichash_update(&state, (const unsigned char*)&count, sizeof(count));
+        crypto_generichash_update(&state, (const unsigned char*)&chunkSize, sizeof(chunkSize));
+        for (const std::string& password : passwords)
+        {
+            const uint64_t length = password.size();
+            crypto_generichash_update(&state, (const unsigned char*)&length, sizeof(length));
+        }
+        std::string digest(s_FingerprintBytes, '\0');
+        crypto_generichash_final(&state, (unsigned char*)digest.data(), digest.size());
+        return digest;
+    }
+
+    void Checksum(const uint8_t* payload, size_t size, uint8_t* out)
+    {
+        crypto_generichash(out, s_ChecksumBytes, payload, size, nullptr, 0);
+    }
+
+    /// Appends frame + checksum in a single write, then makes it durable.
+    void AppendRecord(int fd, Generator::Wire::Writer& frame, const std::string& path)
+    {
+        const std::vector<uint8_t>& bytes = frame.Finish();
+        // ScanJournal() would take a larger frame for a torn one and cut it and everything after it off
+        if (bytes.size() - Generator::Wire::FrameHeaderBytes > Generator::Wire::MaxFrameBytes)
+            throw std::runtime_error("Journal record too large for " + path);
+        std::vector<uint8_t> record(bytes);
+        record.resize(bytes.size() + s_ChecksumBytes);
+        Checksum(bytes.data() + Generator::Wire::FrameHeaderBytes, bytes.size() - Generator::Wire::FrameHeaderBytes,
+                 record.data() + bytes.size());
+        if (!Generator::Wire::WriteAll(fd, record.data(), record.size()))
+            ThrowErrno("Failed to append to", path);
+#if defined(__APPLE__)
+        // fsync() on macOS doesn't flush the drive's cache
+        if (fcntl(fd, F_FULLFSYNC) != 0 && fsync(fd) != 0)
+#else
+        if (fdatasync(fd) != 0)
+#endif
+            ThrowErrno("Failed to sync", path);
+    }
+
+    /// A new file's directory entry has to be synced too, or the whole journal can vanish in a crash.
+    void SyncDirectory(const std::string& path)
+    {
+        std::string directory = std::filesystem::path(path).parent_path().string();
+        if (directory.empty())
+            directory = ".";
+        const int fd = open(directory.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            ThrowErrno("Failed to open", directory);
+        const int result = fsync(fd);
+        close(fd);
+        if (result != 0)
+            ThrowErrno("Failed to sync", directory);
+    }
+
+    /**
+     * Reads the journal front to back. Stops at the first torn or corrupt record.
+     * @returns The offset where the valid records end.
+     */
+    off_t ScanJournal(int fd, std::optional<Header>& header,
+                      const std::function<void(uint64_t chunk, Generator::Wire::Reader& hashes)>& onChunk)
+    {
+        off_t validEnd = 0;
+        std::vector<uint8_t> payload;
+        uint8_t checksum[s_ChecksumBytes];
+        uint8_t expected[s_ChecksumBytes];
+
+        while (Generator::Wire::ReadFrame(fd, payload) && Generator::Wire::ReadAll(fd, checksum, sizeof(checksum)))
+        {
+            Checksum(payload.data(), payload.size(), expected);
+            if (sodium_memcmp(checksum, expected, sizeof(checksum)) != 0)
+                break;
+
+            try
+            {
+                Generator::Wire::Reader reader(payload);
+                if (!header)
+                {
+                    if (reader.U32() != s_Magic || reader.U32() != s_FormatVersion)
+                        throw std::runtime_error("Not a hash job journal");
+                    Header read;
+                    read.totalItems = reader.U64();
+                    read.chunkSize = reader.U64();
+                    read.fingerprint = reader.String();
+                    if (read.chunkSize == 0)
+                        throw std::runtime_error("Corrupt hash job journal header");
+                    header = std::move(read);
+                }
+                else
+                {
+                    const uint64_t chunk = reader.U64();
+                    if (chunk >= header->TotalChunks() || reader.U64() != header->ChunkLength(chunk))
+                        break;
+                    onChunk(chunk, reader);
+                }
+            }
+            catch (const std::runtime_error&)
+            {
+                if (!header)
+                    throw;
+                break;
+            }
+            validEnd += (off_t)(Generator::Wire::FrameHeaderBytes + payload.size() + sizeof(checksum));
+        }
+        return validEnd;
+    }
+}
+
+Generator::HashJob::HashJob(const PasswordGenerator& generator, std::string journalPath, HashJobOptions options)
+    :
+    generator(generator),
+    journalPath(std::move(journalPath)),
+    options(options)
+{
+    if (options.chunkSize == 0)
+        throw std::invalid_argument("Chunk size must be at least 1");
+    if (options.chunkSize > s_MaxChunkSize)
+        throw std::invalid_argument("Chunk size must be at most " + std::to_string(s_MaxChunkSize));
+}
+
+size_t Generator::HashJob::Run(const std::vector<std::string>& passwords,
+                               const std::function<void(uint64_t doneChunks, uint64_t totalChunks)>& onProgress)
+{
+    Header expected{passwords.size(), options.chunkSize, Fingerprint(passwords, options.chunkSize)};
+
+    const int fd = open(journalPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    if (fd < 0)
+        ThrowErrno("Failed to open", journalPath);
+
+    // a worker's failure is rethrown after the catch below, which closes fd on every other way out
+    std::exception_ptr failure;
+    size_t hashedChunks = 0;
+    try
+    {
+        std::optional<Header> header;
+        std::vector<bool> done(expected.TotalChunks());
+        uint64_t doneChunks = 0;
+        std::optional<std::pair<uint64_t, std::string>> sample;
+        const off_t validEnd = ScanJournal(fd, header, [&](uint64_t chunk, Wire::Reader& reader)
+        {
+            // a mismatched header is reported below, don't index with its chunk numbers
+            if (chunk >= done.size())
+                return;
+            if (!sample)
+                sample.emplace(chunk * expected.chunkSize, reader.String());
+            if (!done[chunk])
+                doneChunks++;
+            done[chunk] = true;
+        });
+
+        if (header && (header->totalItems != expected.totalItems || header->chunkSize != expected.chunkSize ||
+                       header->fingerprint != expected.fingerprint ||
+                       (sample && !generator.VerifyPassword(passwords[sample->first], sample->second))))
+            throw std::invalid_argument("Journal " + journalPath + " belongs to a different input or chunk size");
+
+        // drop a torn record left by a crash, then continue appending after the last good one
+        if (ftruncate(fd, validEnd) != 0 || lseek(fd, validEnd, SEEK_SET) < 0)
+            ThrowErrno("Failed to truncate", journalPath);
+        if (!header)
+        {
+            Wire::Writer frame;
+            frame.U32(s_Magic);
+            frame.U32(s_FormatVersion);
+            frame.U64(expected.totalItems);
+            frame.U64(expected.chunkSize);
+            frame.String(expected.fingerprint);
+            AppendRecord(fd, frame, journalPath);
+            SyncDirectory(journalPath);
+        }
+
+        std::vector<uint64_t> pending;
+        for (uint64_t chunk = 0; chunk < expected.TotalChunks(); chunk++)
+            if (!done[chunk])
+                pending.push_back(chunk);
+
+        std::atomic<size_t> next = 0;
+        std::atomic<bool> stop = false;
+        std::mutex journalMutex;
+
+        auto worker = [&]()
+        {
+            try
+            {
+                for (size_t i = next++; i < pending.size() && !stop; i = next++)
+                {
+                    const uint64_t chunk = pending[i];
+                    const uint64_t first = chunk * expected.chunkSize;
+                    const uint64_t length = expected.ChunkLength(chunk);
+
+                    Wire::Writer frame;
+                    frame.U64(chunk);
+                    frame.U64(length);
+                    for (uint64_t item = first; item < first + length && !stop; item++)
+                        frame.String(generator.HashPasswordSafe(passwords[item]));
+                    if (stop)
+                        return;
+
+                    std::lock_guard lock(journalMutex);
+                    AppendRecord(fd, frame, journalPath);
+                    hashedChunks++;
+                    if (onProgress)
+                        onProgress(++doneChunks, expected.TotalChunks());
+                }
+            }
+            catch (...)
+            {
+                std::lock_guard lock(journalMutex);
+                if (!failure)
+                    failure = std::current_exception();
+                stop = true;
+            }
+        };
+
+        const unsigned threads = (unsigned)std::min<size_t>(
+            options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency()),
+            std::max<size_t>(1, pending.size()));
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++)
+            workers.emplace_back(worker);
+        worker();
+        for (std::thread& thread : workers)
+            thread.join();
+    }
+    catch (...)
+    {
+        close(fd);
+        throw;
+    }
+
+    close(fd);
+    if (failure)
+        std::rethrow_exception(failure);
+    return hashedChunks;
+}
+
+std::vector<std::string> Generator::HashJob::Results() const
+{
+    const int fd = open(journalPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        ThrowErrno("Failed to open", journalPath);
+
+    std::optional<Header> header;
+    std::vector<std::string> hashes;
+    std::vector<bool> done;
+    uint64_t doneChunks = 0;
+    try
+    {
+        ScanJournal(fd, header, [&](uint64_t chunk, Wire::Reader& reader)
+        {
+            if (done.empty())
+            {
+                hashes.resize(header->totalItems);
+                done.resize(header->TotalChunks());
+            }
+            const uint64_t first = chunk * header->chunkSize;
+            for (uint64_t item = first; item < first + header->ChunkLength(chunk); item++)
+                hashes[item] = reader.String();
+            if (!done[chunk])
+                doneChunks++;
+            done[chunk] = true;
+        });
+    }
+    catch (...)
+    {
+        close(fd);
+        throw;
+    }
+    close(fd);
+
+    if (!header)
+        throw std::runtime_error("Journal " + journalPath + " is empty");
+    if (doneChunks != header->TotalChunks())
+        throw std::runtime_error("Hash job " + journalPath + " isn't complete: " + std::to_string(doneChunks) + " of " +
+                                 std::to_string(header->TotalChunks()) + " chunks done");
+    return hashes;
+}
+#endif
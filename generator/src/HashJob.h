@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Generator.h"
+
+namespace Generator
+{
+    struct HashJobOptions;
+    class HashJob;
+}
+
+struct Generator::HashJobOptions
+{
+    /// Passwords per chunk, the unit of work that is journaled. At most this much work is lost in a crash. A chunk's
+    /// hashes must fit one Wire frame, which caps it at about 127k.
+    uint64_t chunkSize = 256;
+    /// Worker threads. 0 means one per hardware thread.
+    unsigned threads = 0;
+};
+
+#if !defined(_WIN32)
+/// A bulk hashing run (e.g. a rehash of millions of accounts) that survives the process dying. The input is split
+/// into numbered chunks; every finished chunk is appended to a journal file together with its results and fsync'd
+/// before the next progress report, so the journal itself is the checkpoint. Running the same job again with the same
+/// input skips every chunk already in the journal, and no hash is ever computed twice once its chunk was reported.
+///
+/// Journal: a header record (input size, chunk size, fingerprint of the password lengths), then one record per
+/// finished chunk in completion order. Records are Wire frames followed by a 16 byte BLAKE2b checksum; a torn record at
+/// the end of the file (a crash mid-write) is cut off when the job resumes. The journal holds hashes only, never
+/// plaintext or anything derived from it quickly.
+class Generator::HashJob
+{
+public:
+    /// The generator must outlive the job. Its policy decides the hash cost.
+    /// @throws std::invalid_argument if the chunk size is 0 or too large for one journal record.
+    HashJob(const PasswordGenerator& generator, std::string journalPath, HashJobOptions options = {});
+
+    /**
+     * Hashes every chunk of passwords the journal doesn't have yet.
+     * @param onProgress Called after each chunk is durable, with the number of finished chunks and the total. Runs
+     *                   on a worker thread, one call at a time. If it throws, the run stops and rethrows it.
+     * @returns The number of chunks hashed by this call (0 if the journal was already complete).
+     * @throws std::invalid_argument if the journal was started for different input or a different chunk size.
+     * @throws std::runtime_error if a journal operation fails.
+     */
+    size_t Run(const std::vector<std::string>& passwords,
+               const std::function<void(uint64_t doneChunks, uint64_t totalChunks)>& onProgress = {});
+
+    /// Every hash in the journal, in input order.
+    /// @throws std::runtime_error if the journal is missing, unreadable or not complete yet.
+    [[nodiscard]] std::vector<std::string> Results() const;
+
+    [[nodiscard]] const std::string& JournalPath() const { return journalPath; }
+
+private:
+    const PasswordGenerator& generator;
+    const std::string journalPath;
+    const HashJobOptions options;
+};
+#endif
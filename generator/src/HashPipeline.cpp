@@ -0,0 +1,154 @@
+#include "HashPipeline.h"
+
+#include <exception>
+#include <mutex>
+
+#include "MpmcQueue.h"
+#include "Trace.h"
+
+namespace
+{
+    /// Zeroes every byte the string owns, including the small string buffer inside the object itself, which a move
+    /// copies out of but leaves as it was.
+    void WipeString(std::string& value)
+    {
+        value.resize(value.capacity());
+        sodium_memzero(value.data(), value.size());
+        value.clear();
+    }
+
+    /// Moving one wipes the source, so no plaintext stays behind in a queue cell or a moved-from local.
+    struct PendingPassword
+    {
+        PendingPassword() = default;
+        PendingPassword(size_t index, std::string&& generated)
+            :
+            index(index),
+            password(std::move(generated))
+        {
+            WipeString(generated);
+        }
+        PendingPassword(PendingPassword&& other) noexcept { *this = std::move(other); }
+        PendingPassword& operator=(PendingPassword&& other) noexcept
+        {
+            if (this != &other)
+            {
+                WipeString(password);
+                index = other.index;
+                password = std::move(other.password);
+                WipeString(other.password);
+            }
+            return *this;
+        }
+        ~PendingPassword() { WipeString(password); }
+
+        size_t index = 0;
+        std::string password;
+    };
+}
+
+Generator::HashPipeline::HashPipeline(const PasswordGenerator& generator, PipelineOptions options)
+    :
+    generator(generator),
+    options(options)
+{
+    if (options.generatorThreads == 0 || options.hasherThreads == 0)
+        throw std::invalid_argument("Both pipeline stages need at least one thread");
+}
+
+void Generator::HashPipeline::Run(size_t count, const PipelineSink& sink) const
+{
+    BoundedMpmcQueue<PendingPassword> queue(options.queueCapacity);
+    std::atomic<size_t> nextIndex = 0;
+    std::atomic<unsigned> activeGenerators = options.generatorThreads;
+    std::atomic<bool> abort = false;
+
+    std::exception_ptr firstError;
+    std::mutex errorMutex;
+    const auto fail = [&]() {
+        std::lock_guard lock(errorMutex);
+        if (!firstError)
+            firstError = std::current_exception();
+        abort = true;
+    };
+
+    const auto generate = [&]() {
+        try
+        {
+            for (size_t index = nextIndex++; index < count && !abort; index = nextIndex++)
+            {
+                // an unpushed password is wiped by the destructor
+                PendingPassword pending(index, generator.GenerateAdvancedPassword());
+                (void)queue.Push(pending, abort);
+            }
+        }
+        catch (...)
+        {
+            fail();
+        }
+        activeGenerators--;
+    };
+
+    const auto hash = [&](unsigned worker) {
+        if (options.placement)
+            options.placement->PinCurrentThread(worker);
+
+        PendingPassword pending;
+        for (unsigned attempt = 0; ; )
+        {
+            // after an error or a throwing sink the queued passwords aren't hashed, the leftover drain wipes them
+            if (abort)
+                break;
+            if (!queue.TryPop(pending))
+            {
+                // generators finished and nothing is left in flight
+                if (activeGenerators == 0 && queue.Size() == 0)
+                    break;
+                BoundedMpmcQueue<PendingPassword>::Backoff(attempt++);
+                continue;
+            }
+            attempt = 0;
+
+            try
+            {
+                // HashPasswordSafe() takes a copy we don't need to keep, so hash from an mlocked view instead
+                {
+                    const Trace::Span span("memory", "sodium_mlock");
+                    sodium_mlock(pending.password.data(), pending.password.length());
+                }
+                const std::string hashed = generator.HashPassword(pending.password);
+                sink(pending.index, pending.password, hashed);
+            }
+            catch (...)
+            {
+                fail();
+            }
+            // sodium_munlock() zeroes the plaintext before unlocking it
+            sodium_munlock(pending.password.data(), pending.password.length());
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < options.generatorThreads; i++)
+        threads.emplace_back(generate);
+    for (unsigned i = 0; i < options.hasherThreads; i++)
+        threads.emplace_back(hash, i);
+    for (auto& thread : threads)
+        thread.join();
+
+    // an aborted run can leave plaintexts behind in the queue; popping them wipes the cells
+    PendingPassword leftover;
+    while (queue.TryPop(leftover))
+    {
+    }
+
+    if (firstError)
+        std::rethrow_exception(firstError);
+}
+
+std::vector<std::string> Generator::HashPipeline::GenerateHashes(size_t count) const
+{
+    std::vector<std::string> hashes(count);
+    Run(count, [&hashes](size_t index, const std::string&, const std::string& hash) { hashes[index] = hash; });
+    return hashes;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Generator.h"
+#include "WorkerPlacement.h"
+
+namespace Generator
+{
+    struct PipelineOptions
+    {
+        unsigned generatorThreads = 1;
+        unsigned hasherThreads = std::max(1u, std::thread::hardware_concurrency());
+        /// Generated passwords waiting for a hasher. Generators stall once it is full, which bounds how much
+        /// plaintext is in memory at any time.
+        size_t queueCapacity = 1024;
+        /// Pins hasher n to placement->CpuForWorker(n). Generators are cheap and stay unpinned.
+        std::shared_ptr<const WorkerPlacement> placement = nullptr;
+    };
+
+    /// Receives every generated password together with its hash. Called concurrently from the hasher threads, in no
+    /// particular order. The plaintext is wiped as soon as the sink returns.
+    using PipelineSink = std::function<void(size_t index, const std::string& password, const std::string& hash)>;
+
+    class HashPipeline;
+}
+
+/// Generates and hashes passwords as two overlapping stages connected by a BoundedMpmcQueue, instead of generating a
+/// whole vector with GenerateAdvancedPasswords() and then hashing it with HashPasswordsSafe().
+class Generator::HashPipeline
+{
+public:
+    /// The generator must outlive the pipeline. Its policy is used for both generation and hashing.
+    explicit HashPipeline(const PasswordGenerator& generator, PipelineOptions options = {});
+
+    /// Generates and hashes count passwords, blocking until all are done. Rethrows the first stage error.
+    void Run(size_t count, const PipelineSink& sink) const;
+
+    /// Runs the pipeline and keeps only the hashes, in generation order.
+    [[nodiscard]] std::vector<std::string> GenerateHashes(size_t count) const;
+
+private:
+    const PasswordGenerator& generator;
+    const PipelineOptions options;
+};
@@ -0,0 +1,188 @@
+#include "HashScheduler.h"
+
+Generator::HashScheduler::HashScheduler(const PasswordGenerator& generator, SchedulerOptions options)
+    :
+    generator(generator),
+    options(options)
+{
+    if (options.workers == 0 || options.interactive.maxConcurrency == 0 || options.bulk.maxConcurrency == 0)
+        throw std::invalid_argument("Scheduler needs at least one worker per priority class");
+
+    for (unsigned i = 0; i < options.workers; i++)
+        workers.emplace_back(&HashScheduler::WorkerLoop, this, i);
+}
+
+Generator::HashScheduler::~HashScheduler()
+{
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    bulkSpaceAvailable.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+std::future<bool> Generator::HashScheduler::SubmitVerify(std::string password, std::string hash, JobPriority priority)
+{
+    const size_t memoryBytes = MemoryCostOfHash(hash);
+    return Submit<bool>(priority, memoryBytes, [this, password = std::move(password), hash = std::move(hash)]() mutable {
+        return generator.VerifyPasswordSafe(std::move(password), hash);
+    });
+}
+
+std::future<std::string> Generator::HashScheduler::SubmitHash(std::string password, JobPriority priority)
+{
+    const size_t memoryBytes = generator.GetPolicy().GetHashCost().memLimit;
+    return Submit<std::string>(priority, memoryBytes, [this, password = std::move(password)]() mutable {
+        return generator.HashPasswordSafe(std::move(password));
+    });
+}
+
+std::future<std::vector<std::string>> Generator::HashScheduler::HashPasswordsSafeAsync(std::vector<std::string> passwords)
+{
+    return std::async(std::launch::async, [this, passwords = std::move(passwords)]() mutable {
+        std::vector<std::future<std::string>> pending;
+        pending.reserve(passwords.size());
+        for (auto& password : passwords)
+            pending.push_back(SubmitHash(std::move(password), JobPriority::Bulk));
+
+        std::vector<std::string> hashedPasswords;
+        hashedPasswords.reserve(pending.size());
+        for (auto& hash : pending)
+            hashedPasswords.push_back(hash.get());
+        return hashedPasswords;
+    });
+}
+
+Generator::HashScheduler::Stats Generator::HashScheduler::GetStats() const
+{
+    std::lock_guard lock(mutex);
+    return Stats{interactive.queue.size(), bulk.queue.size(), interactive.running, bulk.running, memoryInUse};
+}
+
+template<typename T>
+std::future<T> Generator::HashScheduler::Submit(JobPriority priority, size_t memoryBytes, std::function<T()> work)
+{
+    auto task = std::make_shared<std::packaged_task<T()>>(std::move(work));
+    std::future<T> result = task->get_future();
+
+    const size_t classBudget = priority == JobPriority::Interactive
+        ? options.memoryBudgetBytes
+        : options.memoryBudgetBytes - std::min(options.memoryBudgetBytes, options.interactiveReserveBytes);
+
+    std::unique_lock lock(mutex);
+    try
+    {
+        if (memoryBytes > classBudget)
+            throw std::invalid_argument("Job needs more memory than the scheduler's budget");
+
+        ClassState& state = State(priority);
+        if (priority == JobPriority::Bulk)
+        {
+            // backpressure: batch producers wait for room instead of queueing the whole job
+            bulkSpaceAvailable.wait(lock, [this, &state]() { return stopping || state.queue.size() < options.bulk.queueCapacity; });
+        }
+        else if (state.queue.size() >= options.interactive.queueCapacity)
+        {
+            throw std::runtime_error("Interactive queue is full");
+        }
+        if (stopping)
+            throw std::runtime_error("Scheduler is shutting down");
+
+        state.queue.push_back(Job{[task]() { (*task)(); }, memoryBytes});
+    }
+    catch (...)
+    {
+        std::promise<T> failed;
+        failed.set_exception(std::current_exception());
+        return failed.get_future();
+    }
+    lock.unlock();
+    workAvailable.notify_one();
+    return result;
+}
+
+bool Generator::HashScheduler::TryDequeue(Job& job, JobPriority& priority, std::chrono::steady_clock::time_point& wakeAt)
+{
+    const auto admissible = [this](JobPriority p, size_t reservedBytes) {
+        const ClassState& state = State(p);
+        return !state.queue.empty()
+            && state.running < Limits(p).maxConcurrency
+            && memoryInUse + state.queue.front().memoryBytes + reservedBytes <= options.memoryBudgetBytes;
+    };
+
+    if (admissible(JobPriority::Interactive, 0))
+    {
+        priority = JobPriority::Interactive;
+    }
+    else if (interactive.queue.empty() && admissible(JobPriority::Bulk, options.interactiveReserveBytes))
+    {
+        if (options.bulkJobsPerSecond > 0.0)
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const double elapsed = std::chrono::duration<double>(now - lastRefill).count();
+            bulkTokens = std::min(1.0, bulkTokens + elapsed * options.bulkJobsPerSecond);
+            lastRefill = now;
+            if (bulkTokens < 1.0)
+            {
+                const double secondsToToken = (1.0 - bulkTokens) / options.bulkJobsPerSecond;
+                wakeAt = now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(secondsToToken));
+                return false;
+            }
+            bulkTokens -= 1.0;
+        }
+        priority = JobPriority::Bulk;
+    }
+    else
+    {
+        return false;
+    }
+
+    ClassState& state = State(priority);
+    job = std::move(state.queue.front());
+    state.queue.pop_front();
+    state.running++;
+    memoryInUse += job.memoryBytes;
+    return true;
+}
+
+void Generator::HashScheduler::WorkerLoop(unsigned index)
+{
+    if (options.placement)
+        options.placement->PinCurrentThread(index);
+
+    std::unique_lock lock(mutex);
+    while (true)
+    {
+        Job job;
+        JobPriority priority = JobPriority::Bulk;
+        auto wakeAt = std::chrono::steady_clock::time_point::max();
+
+        if (TryDequeue(job, priority, wakeAt))
+        {
+            if (priority == JobPriority::Bulk)
+                bulkSpaceAvailable.notify_one();
+
+            lock.unlock();
+            job.run();  // exceptions are captured by the packaged_task
+            job.run = nullptr;
+            lock.lock();
+
+            State(priority).running--;
+            memoryInUse -= job.memoryBytes;
+            // a finished job can unblock admission for any class, so let everybody re-check
+            workAvailable.notify_all();
+            continue;
+        }
+
+        if (stopping && interactive.queue.empty() && bulk.queue.empty())
+            return;
+
+        if (wakeAt == std::chrono::steady_clock::time_point::max())
+            workAvailable.wait(lock);
+        else
+            workAvailable.wait_until(lock, wakeAt);
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Generator.h"
+#include "WorkerPlacement.h"
+
+namespace Generator
+{
+    enum class JobPriority
+    {
+        Interactive,    // logins: verify calls somebody is waiting on
+        Bulk            // provisioning and rehash jobs
+    };
+
+    struct SchedulerOptions;
+    class HashScheduler;
+}
+
+struct Generator::SchedulerOptions
+{
+    struct ClassLimits
+    {
+        /// Jobs that may wait in this class' queue. Full interactive queues fail fast, full bulk queues block the submitter.
+        size_t queueCapacity;
+        /// Jobs of this class that may run at the same time.
+        unsigned maxConcurrency;
+    };
+
+    unsigned workers = std::max(2u, std::thread::hardware_concurrency());
+    ClassLimits interactive{1024, workers};
+    /// Bulk gets at most half the workers by default, so a login never waits behind a whole pool of bulk hashes.
+    ClassLimits bulk{256, std::max(1u, workers / 2)};
+
+    /// Argon2 memory all running jobs may use together.
+    size_t memoryBudgetBytes = 1024ull * 1024 * 1024;
+    /// Part of the budget bulk jobs may never touch, kept free for interactive verifies.
+    size_t interactiveReserveBytes = crypto_pwhash_MEMLIMIT_INTERACTIVE;
+    /// Bulk jobs started per second. 0 disables rate limiting.
+    double bulkJobsPerSecond = 0.0;
+    /// Pins worker n to placement->CpuForWorker(n). Workers float freely when unset.
+    std::shared_ptr<const WorkerPlacement> placement = nullptr;
+};
+
+/// Runs hash and verify jobs on a shared worker pool with two priority classes. Interactive jobs always go first,
+/// bulk jobs are capped in concurrency, memory and rate, so a provisioning job can't push login latency around.
+/// Memory admission uses the same limits the hash itself will use (the policy's HashCost for hashing, the stored
+/// hash's own parameters for verification).
+class Generator::HashScheduler
+{
+public:
+    /// The generator must outlive the scheduler. Its policy decides the cost of SubmitHash() jobs.
+    explicit HashScheduler(const PasswordGenerator& generator, SchedulerOptions options = {});
+    ~HashScheduler();
+    HashScheduler(const HashScheduler&) = delete;
+    HashScheduler& operator=(const HashScheduler&) = delete;
+
+    /// Verifies a password (see PasswordGenerator::VerifyPasswordSafe()). Defaults to the interactive class.
+    [[nodiscard]] std::future<bool> SubmitVerify(std::string password, std::string hash, JobPriority priority = JobPriority::Interactive);
+
+    /// Hashes a password (see PasswordGenerator::HashPasswordSafe()). Defaults to the bulk class.
+    [[nodiscard]] std::future<std::string> SubmitHash(std::string password, JobPriority priority = JobPriority::Bulk);
+
+    /// Scheduled equivalent of PasswordGenerator::HashPasswordsSafeAsync(). Every password is a bulk job. Results
+    /// keep the input order. passwords vector will be erased.
+    [[nodiscard]] std::future<std::vector<std::string>> HashPasswordsSafeAsync(std::vector<std::string> passwords);
+
+    struct Stats
+    {
+        size_t queuedInteractive = 0;
+        size_t queuedBulk = 0;
+        unsigned runningInteractive = 0;
+        unsigned runningBulk = 0;
+        size_t memoryInUse = 0;
+    };
+    [[nodiscard]] Stats GetStats() const;
+
+private:
+    struct Job
+    {
+        std::function<void()> run;
+        size_t memoryBytes = 0;
+    };
+
+    struct ClassState
+    {
+        std::deque<Job> queue;
+        unsigned running = 0;
+    };
+
+    template<typename T>
+    std::future<T> Submit(JobPriority priority, size_t memoryBytes, std::function<T()> work);
+
+    /// Picks the next job that passes admission. Must hold the mutex. Sets wakeAt when bulk is only held back by the rate limit.
+    bool TryDequeue(Job& job, JobPriority& priority, std::chrono::steady_clock::time_point& wakeAt);
+    void WorkerLoop(unsigned index);
+
+    [[nodiscard]] ClassState& State(JobPriority priority) { return priority == JobPriority::Interactive ? interactive : bulk; }
+    [[nodiscard]] const SchedulerOptions::ClassLimits& Limits(JobPriority priority) const
+    {
+        return priority == JobPriority::Interactive ? options.interactive : options.bulk;
+    }
+
+    const PasswordGenerator& generator;
+    const SchedulerOptions options;
+
+    ClassState interactive;
+    ClassState bulk;
+    size_t memoryInUse = 0;
+    // token bucket for bulk starts
+    double bulkTokens = 1.0;
+    std::chrono::steady_clock::time_point lastRefill = std::chrono::steady_clock::now();
+    bool stopping = false;
+
+    mutable std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable bulkSpaceAvailable;
+    std::vector<std::thread> workers;
+};
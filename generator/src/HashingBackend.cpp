@@ -0,0 +1,210 @@
+#include "HashingBackend.h"
+
+#include <stdexcept>
+
+#include "Generator.h"
+
+namespace
+{
+    using Generator::EncryptionStrength;
+    using Generator::HashAlgorithm;
+    using Generator::HashCost;
+
+    void RequireSingleLane(const HashCost& cost)
+    {
+        if (cost.parallelism != 1)
+            throw std::invalid_argument("libsodium's argon2 only supports a single lane");
+    }
+
+    class Argon2idBackend final : public Generator::HashingBackend
+    {
+    public:
+        [[nodiscard]] HashAlgorithm Algorithm() const override { return HashAlgorithm::Argon2id; }
+        [[nodiscard]] std::string_view Name() const override { return "argon2id"; }
+        [[nodiscard]] std::string_view Prefix() const override { return crypto_pwhash_argon2id_STRPREFIX; }
+
+        [[nodiscard]] HashCost CostFor(EncryptionStrength strength) const override
+        {
+            return HashCost{(uint64_t)Generator::sodiumOpsLimitFromEncryptionStrength(strength),
+                            (size_t)Generator::sodiumMemLimitFromEncryptionStrength(strength)};
+        }
+
+        [[nodiscard]] std::string Hash(const std::string& password, const HashCost& cost) const override
+        {
+            RequireSingleLane(cost);
+            char encryptedPw[crypto_pwhash_STRBYTES];
+            if (crypto_pwhash_argon2id_str(encryptedPw, password.c_str(), password.length(), cost.opsLimit, cost.memLimit) != 0)
+                throw std::runtime_error("Failed to encrypt password");
+            return encryptedPw;
+        }
+
+        [[nodiscard]] bool Verify(const std::string& password, const std::string& hash) const override
+        {
+            return crypto_pwhash_argon2id_str_verify(hash.c_str(), password.c_str(), password.length()) == 0;
+        }
+
+        [[nodiscard]] bool NeedsRehash(const std::string& hash, const HashCost& cost) const override
+        {
+            return crypto_pwhash_argon2id_str_needs_rehash(hash.c_str(), cost.opsLimit, cost.memLimit) != 0;
+        }
+
+        [[nodiscard]] size_t MemoryCost(std::string_view hash) const override
+        {
+            return Generator::sodiumMemLimitFromHash(std::string(hash));
+        }
+    };
+
+    class Argon2iBackend final : public Generator::HashingBackend
+    {
+    public:
+        [[nodiscard]] HashAlgorithm Algorithm() const override { return HashAlgorithm::Argon2i; }
+        [[nodiscard]] std::string_view Name() const override { return "argon2i"; }
+        [[nodiscard]] std::string_view Prefix() const override { return crypto_pwhash_argon2i_STRPREFIX; }
+
+        /// argon2i needs at least 3 passes, it has no data-dependent addressing to make up for fewer.
+        [[nodiscard]] HashCost CostFor(EncryptionStrength strength) const override
+        {
+            switch (strength)
+            {
+                case EncryptionStrength::Medium:
+                    return HashCost{crypto_pwhash_argon2i_OPSLIMIT_INTERACTIVE, crypto_pwhash_argon2i_MEMLIMIT_INTERACTIVE};
+                case EncryptionStrength::High:
+                    return HashCost{crypto_pwhash_argon2i_OPSLIMIT_SENSITIVE, crypto_pwhash_argon2i_MEMLIMIT_SENSITIVE};
+                case EncryptionStrength::Low:
+                default:
+                    return HashCost{crypto_pwhash_argon2i_OPSLIMIT_MIN, crypto_pwhash_argon2i_MEMLIMIT_MIN};
+            }
+        }
+
+        [[nodiscard]] std::string Hash(const std::string& password, const HashCost& cost) const override
+        {
+            RequireSingleLane(cost);
+            char encryptedPw[crypto_pwhash_STRBYTES];
+            if (crypto_pwhash_argon2i_str(encryptedPw, password.c_str(), password.length(), cost.opsLimit, cost.memLimit) != 0)
+                throw std::runtime_error("Failed to encrypt password");
+            return encryptedPw;
+        }
+
+        [[nodiscard]] bool Verify(const std::string& password, const std::string& hash) const override
+        {
+            return crypto_pwhash_argon2i_str_verify(hash.c_str(), password.c_str(), password.length()) == 0;
+        }
+
+        [[nodiscard]] bool NeedsRehash(const std::string& hash, const HashCost& cost) const override
+        {
+            return crypto_pwhash_argon2i_str_needs_rehash(hash.c_str(), cost.opsLimit, cost.memLimit) != 0;
+        }
+
+        [[nodiscard]] size_t MemoryCost(std::string_view hash) const override
+        {
+            return Generator::sodiumMemLimitFromHash(std::string(hash));
+        }
+    };
+
+    class ScryptBackend final : public Generator::HashingBackend
+    {
+    public:
+        [[nodiscard]] HashAlgorithm Algorithm() const override { return HashAlgorithm::Scrypt; }
+        [[nodiscard]] std::string_view Name() const override { return "scrypt"; }
+        [[nodiscard]] std::string_view Prefix() const override { return crypto_pwhash_scryptsalsa208sha256_STRPREFIX; }
+
+        [[nodiscard]] HashCost CostFor(EncryptionStrength strength) const override
+        {
+            switch (strength)
+            {
+                case EncryptionStrength::Medium:
+                    return HashCost{crypto_pwhash_scryptsalsa208sha256_OPSLIMIT_INTERACTIVE, crypto_pwhash_scryptsalsa208sha256_MEMLIMIT_INTERACTIVE};
+                case EncryptionStrength::High:
+                    return HashCost{crypto_pwhash_scryptsalsa208sha256_OPSLIMIT_SENSITIVE, crypto_pwhash_scryptsalsa208sha256_MEMLIMIT_SENSITIVE};
+                case EncryptionStrength::Low:
+                default:
+                    return HashCost{crypto_pwhash_scryptsalsa208sha256_OPSLIMIT_MIN, crypto_pwhash_scryptsalsa208sha256_MEMLIMIT_MIN};
+            }
+        }
+
+        [[nodiscard]] std::string Hash(const std::string& password, const HashCost& cost) const override
+        {
+            char encryptedPw[crypto_pwhash_scryptsalsa208sha256_STRBYTES];
+            if (crypto_pwhash_scryptsalsa208sha256_str(encryptedPw, password.c_str(), password.length(), cost.opsLimit, cost.memLimit) != 0)
+                throw std::runtime_error("Failed to encrypt password");
+            return encryptedPw;
+        }
+
+        [[nodiscard]] bool Verify(const std::string& password, const std::string& hash) const override
+        {
+            return crypto_pwhash_scryptsalsa208sha256_str_verify(hash.c_str(), password.c_str(), password.length()) == 0;
+        }
+
+        [[nodiscard]] bool NeedsRehash(const std::string& hash, const HashCost& cost) const override
+        {
+            return crypto_pwhash_scryptsalsa208sha256_str_needs_rehash(hash.c_str(), cost.opsLimit, cost.memLimit) != 0;
+        }
+
+        /// "$7$" is followed by log2(N) as one character and r as five, in scrypt's own little-endian base64.
+        [[nodiscard]] size_t MemoryCost(std::string_view hash) const override
+        {
+            if (hash.length() < 9)
+                return 0;
+
+            const int logN = Decode64(hash[3]);
+            uint64_t r = 0;
+            for (int i = 0; i < 5; i++)
+            {
+                const int digit = Decode64(hash[4 + i]);
+                if (digit < 0)
+                    return 0;
+                r |= (uint64_t)digit << (6 * i);
+            }
+            if (logN < 0)
+                return 0;
+            return Generator::ScryptMemoryCost(r, (uint64_t)logN);
+        }
+
+    private:
+        static int Decode64(char c)
+        {
+            static constexpr std::string_view s_Itoa64 = "./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+            const size_t pos = s_Itoa64.find(c);
+            return pos == std::string_view::npos ? -1 : (int)pos;
+        }
+    };
+
+    const Argon2idBackend s_Argon2id;
+    const Argon2iBackend s_Argon2i;
+    const ScryptBackend s_Scrypt;
+    const Generator::HashingBackend* const s_Backends[] = { &s_Argon2id, &s_Argon2i, &s_Scrypt };
+}
+
+const Generator::HashingBackend& Generator::GetHashingBackend(HashAlgorithm algorithm)
+{
+    for (const HashingBackend* backend : s_Backends)
+    {
+        if (backend->Algorithm() == algorithm)
+            return *backend;
+    }
+    throw std::invalid_argument("Unknown hash algorithm");
+}
+
+const Generator::HashingBackend* Generator::FindHashingBackend(std::string_view hash)
+{
+    for (const HashingBackend* backend : s_Backends)
+    {
+        if (backend->Matches(hash))
+            return backend;
+    }
+    return nullptr;
+}
+
+size_t Generator::ScryptMemoryCost(uint64_t r, uint64_t logN)
+{
+    // saturate rather than wrap: a wrapped cost would slip a crafted hash past the memory budget
+    if (logN >= 64 || r > (SIZE_MAX / 128) >> logN)
+        return SIZE_MAX;
+    return (size_t)(128 * r << logN);
+}
+
+size_t Generator::MemoryCostOfHash(std::string_view hash)
+{
+    const HashingBackend* backend = FindHashingBackend(hash);
+    return backend ? backend->MemoryCost(hash) : 0;
+}
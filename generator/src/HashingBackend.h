@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <sodium.h>
+
+namespace Generator
+{
+    enum class EncryptionStrength;
+
+    enum class HashAlgorithm
+    {
+        Argon2id,   // libsodium's default, what crypto_pwhash_str produces
+        Argon2i,
+        Scrypt      // crypto_pwhash_scryptsalsa208sha256
+    };
+
+    /// Cost parameters of a single hash. Their meaning is backend specific, see each backend's CostFor().
+    struct HashCost
+    {
+        uint64_t opsLimit = 0;
+        size_t memLimit = 0;
+        /// Argon2 lanes. libsodium only implements a single lane, so its backends reject anything else.
+        uint32_t parallelism = 1;
+
+        bool operator==(const HashCost&) const = default;
+    };
+
+    class HashingBackend;
+
+    /// Returns the backend for an algorithm. Backends are stateless singletons.
+    [[nodiscard]] const HashingBackend& GetHashingBackend(HashAlgorithm algorithm);
+
+    /// Finds the backend that produced an encoded hash by looking at its prefix. Returns nullptr for unknown formats.
+    [[nodiscard]] const HashingBackend* FindHashingBackend(std::string_view hash);
+
+    /// Memory (in bytes) verifying this hash will allocate, or 0 if the format is unknown. SIZE_MAX if the cost
+    /// doesn't fit in a size_t, which every budget treats as too large.
+    [[nodiscard]] size_t MemoryCostOfHash(std::string_view hash);
+
+    /// Memory (in bytes) scrypt allocates for block size r and 2^logN iterations: 128 * r * 2^logN, or SIZE_MAX if
+    /// that doesn't fit in a size_t.
+    [[nodiscard]] size_t ScryptMemoryCost(uint64_t r, uint64_t logN);
+}
+
+/// One password hashing algorithm. PasswordGenerator picks the backend for hashing from the policy's hashAlgorithm,
+/// and picks the backend for verification from the prefix of the stored hash, so hashes made under an older policy
+/// keep verifying after the policy changes.
+class Generator::HashingBackend
+{
+public:
+    virtual ~HashingBackend() = default;
+
+    [[nodiscard]] virtual HashAlgorithm Algorithm() const = 0;
+    [[nodiscard]] virtual std::string_view Name() const = 0;
+    /// The encoded-string prefix this backend produces, e.g. "$argon2id$".
+    [[nodiscard]] virtual std::string_view Prefix() const = 0;
+
+    /// The backend's cost parameters for an EncryptionStrength. Backends scale differently, so the same strength
+    /// doesn't mean the same ops/mem numbers across algorithms.
+    [[nodiscard]] virtual HashCost CostFor(EncryptionStrength strength) const = 0;
+
+    /// Hashes a password into its encoded string form. Throws std::runtime_error if hashing fails.
+    [[nodiscard]] virtual std::string Hash(const std::string& password, const HashCost& cost) const = 0;
+    [[nodiscard]] virtual bool Verify(const std::string& password, const std::string& hash) const = 0;
+    /// True if the hash was made with different cost parameters than the given ones.
+    [[nodiscard]] virtual bool NeedsRehash(const std::string& hash, const HashCost& cost) const = 0;
+    /// Memory (in bytes) hashing or verifying with this encoded hash allocates.
+    [[nodiscard]] virtual size_t MemoryCost(std::string_view hash) const = 0;
+
+    [[nodiscard]] bool Matches(std::string_view hash) const { return hash.starts_with(Prefix()); }
+};
@@ -0,0 +1,63 @@
+#include "MemoryBudget.h"
+
+#include <stdexcept>
+
+#include "Trace.h"
+
+Generator::MemoryBudget::Reservation& Generator::MemoryBudget::Reservation::operator=(Reservation&& other) noexcept
+{
+    if (this != &other)
+    {
+        Release();
+        budget = other.budget;
+        bytes = other.bytes;
+        other.budget = nullptr;
+    }
+    return *this;
+}
+
+void Generator::MemoryBudget::Reservation::Release()
+{
+    if (budget)
+    {
+        budget->Release(bytes);
+        budget = nullptr;
+    }
+}
+
+Generator::MemoryBudget::Reservation Generator::MemoryBudget::Acquire(size_t bytes)
+{
+    if (bytes > capacity)
+        throw std::invalid_argument("Requested memory exceeds the memory budget");
+
+    // how long a hash stalls on the budget shows up as its own span
+    const Trace::Span span("memory", "MemoryBudget::Acquire");
+    std::unique_lock lock(mutex);
+    released.wait(lock, [this, bytes]() { return used + bytes <= capacity; });
+    used += bytes;
+    return {this, bytes};
+}
+
+Generator::MemoryBudget::Reservation Generator::MemoryBudget::TryAcquire(size_t bytes)
+{
+    std::lock_guard lock(mutex);
+    if (used + bytes > capacity)
+        return {};
+    used += bytes;
+    return {this, bytes};
+}
+
+size_t Generator::MemoryBudget::InUse() const
+{
+    std::lock_guard lock(mutex);
+    return used;
+}
+
+void Generator::MemoryBudget::Release(size_t bytes)
+{
+    {
+        std::lock_guard lock(mutex);
+        used -= bytes;
+    }
+    released.notify_all();
+}
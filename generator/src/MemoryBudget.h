@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace Generator
+{
+    class MemoryBudget;
+}
+
+/// A process-wide byte budget for memory hungry work (mainly Argon2, which allocates its full memlimit per hash).
+/// Callers reserve the bytes they are about to use and give them back when done, so N concurrent hashes can never
+/// ask the allocator for more than the budget in total.
+class Generator::MemoryBudget
+{
+public:
+    /// RAII handle for bytes taken from the budget. Released on destruction.
+    class Reservation
+    {
+    public:
+        Reservation() = default;
+        Reservation(MemoryBudget* budget, size_t bytes) : budget(budget), bytes(bytes) {}
+        Reservation(const Reservation&) = delete;
+        Reservation& operator=(const Reservation&) = delete;
+        Reservation(Reservation&& other) noexcept : budget(other.budget), bytes(other.bytes) { other.budget = nullptr; }
+        Reservation& operator=(Reservation&& other) noexcept;
+        ~Reservation() { Release(); }
+
+        /// Gives the bytes back early. Safe to call more than once.
+        void Release();
+        [[nodiscard]] explicit operator bool() const { return budget != nullptr; }
+        [[nodiscard]] size_t Bytes() const { return bytes; }
+
+    private:
+        MemoryBudget* budget = nullptr;
+        size_t bytes = 0;
+    };
+
+    explicit MemoryBudget(size_t capacityBytes) : capacity(capacityBytes) {}
+    MemoryBudget(const MemoryBudget&) = delete;
+    MemoryBudget& operator=(const MemoryBudget&) = delete;
+
+    /**
+     * Blocks until the requested amount of memory is available and reserves it.
+     * @throws std::invalid_argument if the request can never fit in the budget.
+     */
+    [[nodiscard]] Reservation Acquire(size_t bytes);
+
+    /// Non-blocking version of Acquire(). The returned reservation is empty if the bytes aren't available right now.
+    [[nodiscard]] Reservation TryAcquire(size_t bytes);
+
+    [[nodiscard]] size_t Capacity() const { return capacity; }
+    [[nodiscard]] size_t InUse() const;
+
+private:
+    void Release(size_t bytes);
+
+    const size_t capacity;
+    size_t used = 0;
+    mutable std::mutex mutex;
+    std::condition_variable released;
+};
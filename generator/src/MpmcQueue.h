@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace Generator
+{
+    template<typename T>
+    class BoundedMpmcQueue;
+}
+
+/// Bounded lock-free multi-producer/multi-consumer ring buffer (Dmitry Vyukov's design). Every cell carries a sequence
+/// number that tells producers and consumers whose turn it is, so a push or pop is one CAS on the shared position plus
+/// one release store on the cell. Capacity is rounded up to a power of two.
+template<typename T>
+class Generator::BoundedMpmcQueue
+{
+public:
+    explicit BoundedMpmcQueue(size_t capacity)
+        :
+        capacity(std::bit_ceil(std::max<size_t>(capacity, 2))),
+        mask(this->capacity - 1),
+        cells(std::make_unique<Cell[]>(this->capacity))
+    {
+        for (size_t i = 0; i < this->capacity; i++)
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    BoundedMpmcQueue(const BoundedMpmcQueue&) = delete;
+    BoundedMpmcQueue& operator=(const BoundedMpmcQueue&) = delete;
+
+    /// Returns false if the queue is full. value is only moved from on success.
+    bool TryPush(T& value)
+    {
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = (intptr_t)sequence - (intptr_t)pos;
+            if (diff == 0)
+            {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns false if the queue is empty. The cell keeps the moved-from value until it is reused, so a T holding secrets
+    /// should wipe its source when moved.
+    bool TryPop(T& value)
+    {
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        Cell* cell;
+        while (true)
+        {
+            cell = &cells[pos & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+            if (diff == 0)
+            {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0)
+            {
+                return false;
+            }
+            else
+            {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        value = std::move(cell->value);
+        cell->sequence.store(pos + capacity, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Pushes, waiting while the queue is full. This is the backpressure point between pipeline stages.
+     * @returns false if abort was raised before there was room.
+     */
+    bool Push(T& value, const std::atomic<bool>& abort)
+    {
+        for (unsigned attempt = 0; !TryPush(value); attempt++)
+        {
+            if (abort.load(std::memory_order_relaxed))
+                return false;
+            Backoff(attempt);
+        }
+        return true;
+    }
+
+    /// Approximate number of queued items.
+    [[nodiscard]] size_t Size() const
+    {
+        const size_t enqueued = enqueuePos.load(std::memory_order_relaxed);
+        const size_t dequeued = dequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+    [[nodiscard]] size_t Capacity() const { return capacity; }
+
+    /// Spin briefly, then yield, then sleep. Waiting stages shouldn't burn a core the other stage could use.
+    static void Backoff(unsigned attempt)
+    {
+        if (attempt < 64)
+            return;
+        if (attempt < 128)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    const size_t capacity;
+    const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    alignas(64) std::atomic<size_t> enqueuePos = 0;
+    alignas(64) std::atomic<size_t> dequeuePos = 0;
+};
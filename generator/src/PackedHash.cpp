@@ -0,0 +1,382 @@
+#include "PackedHash.h"
+
+#include <algorithm>
+#include <charconv>
+#include <stdexcept>
+
+namespace
+{
+    using Generator::HashAlgorithm;
+
+    constexpr uint8_t s_FormatVersion = 1;
+    constexpr uint32_t s_Argon2Version = 19;
+    // Bytes of the scrypt "$7$" header: prefix, log2(N) and five characters each for r and p
+    constexpr size_t s_ScryptHeaderLength = 3 + 1 + 5 + 5;
+    constexpr std::string_view s_Itoa64 = "./0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+    // Stable on-disk ids, deliberately independent of the HashAlgorithm enumerator values
+    uint8_t AlgorithmId(HashAlgorithm algorithm)
+    {
+        switch (algorithm)
+        {
+            case HashAlgorithm::Argon2id: return 1;
+            case HashAlgorithm::Argon2i: return 2;
+            case HashAlgorithm::Scrypt: return 3;
+        }
+        throw std::invalid_argument("Unknown hash algorithm");
+    }
+
+    HashAlgorithm AlgorithmFromId(uint8_t id)
+    {
+        switch (id)
+        {
+            case 1: return HashAlgorithm::Argon2id;
+            case 2: return HashAlgorithm::Argon2i;
+            case 3: return HashAlgorithm::Scrypt;
+            default: throw std::invalid_argument("Unknown packed hash algorithm id");
+        }
+    }
+
+    [[noreturn]] void Malformed()
+    {
+        throw std::invalid_argument("Malformed password hash");
+    }
+
+    /// LEB128: seven bits per byte, least significant group first, high bit set on all but the last byte.
+    void AppendVarint(std::vector<uint8_t>& out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    class ByteReader
+    {
+    public:
+        ByteReader(const uint8_t* data, size_t size) : data(data), size(size) {}
+
+        uint8_t Byte()
+        {
+            if (pos == size)
+                throw std::invalid_argument("Truncated packed hash");
+            return data[pos++];
+        }
+
+        uint64_t Varint()
+        {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7)
+            {
+                const uint8_t byte = Byte();
+                // Reject bits past 64 and overlong encodings, so every value has exactly one packed form
+                if (shift == 63 && byte > 1)
+                    throw std::invalid_argument("Packed hash varint overflows");
+                value |= (uint64_t)(byte & 0x7f) << shift;
+                if ((byte & 0x80) == 0)
+                {
+                    if (byte == 0 && shift != 0)
+                        throw std::invalid_argument("Overlong varint in packed hash");
+                    return value;
+                }
+            }
+            throw std::invalid_argument("Packed hash varint overflows");
+        }
+
+        uint32_t Varint32()
+        {
+            const uint64_t value = Varint();
+            if (value > UINT32_MAX)
+                throw std::invalid_argument("Packed hash field out of range");
+            return (uint32_t)value;
+        }
+
+        std::vector<uint8_t> Bytes()
+        {
+            const uint64_t length = Varint();
+            if (length > size - pos)
+                throw std::invalid_argument("Truncated packed hash");
+            std::vector<uint8_t> bytes(data + pos, data + pos + length);
+            pos += (size_t)length;
+            return bytes;
+        }
+
+        [[nodiscard]] bool AtEnd() const { return pos == size; }
+
+    private:
+        const uint8_t* data;
+        size_t size;
+        size_t pos = 0;
+    };
+
+    /// Reads a decimal number without sign or leading zeros up to the next delimiter.
+    uint64_t ParseDecimal(std::string_view& text, char delimiter)
+    {
+        const size_t end = text.find(delimiter);
+        if (end == std::string_view::npos || end == 0)
+            Malformed();
+        uint64_t value = 0;
+        const auto [ptr, ec] = std::from_chars(text.data(), text.data() + end, value);
+        if (ec != std::errc() || ptr != text.data() + end)
+            Malformed();
+        text.remove_prefix(end + 1);
+        return value;
+    }
+
+    void Expect(std::string_view& text, std::string_view prefix)
+    {
+        if (!text.starts_with(prefix))
+            Malformed();
+        text.remove_prefix(prefix.length());
+    }
+
+    std::vector<uint8_t> DecodeBase64(std::string_view text)
+    {
+        std::vector<uint8_t> bytes(text.length() * 3 / 4 + 1);
+        size_t length = 0;
+        if (sodium_base642bin(bytes.data(), bytes.size(), text.data(), text.length(), nullptr, &length, nullptr,
+                              sodium_base64_VARIANT_ORIGINAL_NO_PADDING) != 0)
+            Malformed();
+        bytes.resize(length);
+        return bytes;
+    }
+
+    void AppendBase64(std::string& out, const std::vector<uint8_t>& bytes)
+    {
+        std::string text(sodium_base64_ENCODED_LEN(bytes.size(), sodium_base64_VARIANT_ORIGINAL_NO_PADDING), '\0');
+        sodium_bin2base64(text.data(), text.size(), bytes.data(), bytes.size(), sodium_base64_VARIANT_ORIGINAL_NO_PADDING);
+        text.pop_back();
+        out += text;
+    }
+
+    /// Scrypt's base64: its own alphabet, with each group of up to three bytes written least significant six bits first.
+    void AppendItoa64(std::string& out, uint64_t value, int bits)
+    {
+        for (int bit = 0; bit < bits; bit += 6)
+        {
+            out.push_back(s_Itoa64[value & 0x3f]);
+            value >>= 6;
+        }
+    }
+
+    void AppendItoa64(std::string& out, const std::vector<uint8_t>& bytes)
+    {
+        for (size_t i = 0; i < bytes.size();)
+        {
+            uint32_t value = 0;
+            int bits = 0;
+            do
+            {
+                value |= (uint32_t)bytes[i++] << bits;
+                bits += 8;
+            } while (bits < 24 && i < bytes.size());
+            AppendItoa64(out, value, bits);
+        }
+    }
+
+    uint64_t DecodeItoa64(std::string_view text)
+    {
+        uint64_t value = 0;
+        for (size_t i = 0; i < text.length(); i++)
+        {
+            const size_t digit = s_Itoa64.find(text[i]);
+            if (digit == std::string_view::npos)
+                Malformed();
+            value |= (uint64_t)digit << (6 * i);
+        }
+        return value;
+    }
+
+    std::vector<uint8_t> DecodeItoa64Bytes(std::string_view text)
+    {
+        std::vector<uint8_t> bytes;
+        bytes.reserve(text.length() * 3 / 4);
+        while (!text.empty())
+        {
+            // Four characters carry three bytes; a trailing group of two or three characters carries one or two
+            const size_t chars = std::min<size_t>(text.length(), 4);
+            if (chars == 1)
+                Malformed();
+            uint64_t value = DecodeItoa64(text.substr(0, chars));
+            for (size_t b = 0; b < chars - 1; b++, value >>= 8)
+                bytes.push_back((uint8_t)value);
+            text.remove_prefix(chars);
+        }
+        return bytes;
+    }
+
+    std::string ScryptSaltText(const Generator::PackedHash& hash)
+    {
+        std::string text;
+        AppendItoa64(text, hash.salt);
+        return text;
+    }
+
+    Generator::PackedHash ParseArgon2(std::string_view text, HashAlgorithm algorithm)
+    {
+        Generator::PackedHash hash;
+        hash.algorithm = algorithm;
+        Expect(text, "v=");
+        hash.version = (uint32_t)ParseDecimal(text, '$');
+        Expect(text, "m=");
+        hash.memoryCost = ParseDecimal(text, ',');
+        Expect(text, "t=");
+        hash.timeCost = ParseDecimal(text, ',');
+        Expect(text, "p=");
+        const uint64_t parallelism = ParseDecimal(text, '$');
+        if (parallelism > UINT32_MAX)
+            Malformed();
+        hash.parallelism = (uint32_t)parallelism;
+
+        const size_t separator = text.find('$');
+        if (separator == std::string_view::npos)
+            Malformed();
+        hash.salt = DecodeBase64(text.substr(0, separator));
+        hash.tag = DecodeBase64(text.substr(separator + 1));
+        return hash;
+    }
+
+    Generator::PackedHash ParseScrypt(std::string_view text)
+    {
+        const size_t separator = text.find('$', s_ScryptHeaderLength);
+        if (text.length() < s_ScryptHeaderLength || separator == std::string_view::npos)
+            Malformed();
+
+        Generator::PackedHash hash;
+        hash.algorithm = HashAlgorithm::Scrypt;
+        hash.timeCost = DecodeItoa64(text.substr(3, 1));
+        hash.memoryCost = DecodeItoa64(text.substr(4, 5));
+        hash.parallelism = (uint32_t)DecodeItoa64(text.substr(9, 5));
+        hash.salt = DecodeItoa64Bytes(text.substr(s_ScryptHeaderLength, separator - s_ScryptHeaderLength));
+        hash.tag = DecodeItoa64Bytes(text.substr(separator + 1));
+        return hash;
+    }
+}
+
+Generator::PackedHash Generator::PackedHash::FromString(std::string_view encoded)
+{
+    PackedHash hash;
+    if (encoded.starts_with(crypto_pwhash_argon2id_STRPREFIX))
+        hash = ParseArgon2(encoded.substr(sizeof(crypto_pwhash_argon2id_STRPREFIX) - 1), HashAlgorithm::Argon2id);
+    else if (encoded.starts_with(crypto_pwhash_argon2i_STRPREFIX))
+        hash = ParseArgon2(encoded.substr(sizeof(crypto_pwhash_argon2i_STRPREFIX) - 1), HashAlgorithm::Argon2i);
+    else if (encoded.starts_with(crypto_pwhash_scryptsalsa208sha256_STRPREFIX))
+        hash = ParseScrypt(encoded);
+    else
+        throw std::invalid_argument("Unknown password hash format");
+
+    // Non-canonical spellings (leading zeros, stray padding bits, ...) would come back different, and a stored hash
+    // must never change meaning by being packed
+    if (hash.ToString() != encoded)
+        throw std::invalid_argument("Password hash doesn't have a canonical encoding");
+    return hash;
+}
+
+Generator::PackedHash Generator::PackedHash::FromBytes(const uint8_t* data, size_t size)
+{
+    ByteReader reader(data, size);
+    if (reader.Byte() != s_FormatVersion)
+        throw std::invalid_argument("Unknown packed hash format version");
+
+    PackedHash hash;
+    hash.algorithm = AlgorithmFromId(reader.Byte());
+    hash.version = reader.Varint32();
+    hash.timeCost = reader.Varint();
+    hash.memoryCost = reader.Varint();
+    hash.parallelism = reader.Varint32();
+    hash.salt = reader.Bytes();
+    hash.tag = reader.Bytes();
+    if (!reader.AtEnd())
+        throw std::invalid_argument("Trailing bytes after packed hash");
+    return hash;
+}
+
+std::string Generator::PackedHash::ToString() const
+{
+    std::string out;
+    if (algorithm == HashAlgorithm::Scrypt)
+    {
+        if (timeCost > 63 || memoryCost >= (1u << 30) || parallelism >= (1u << 30))
+            throw std::invalid_argument("Scrypt parameters out of range");
+        out.reserve(crypto_pwhash_scryptsalsa208sha256_STRBYTES);
+        out += crypto_pwhash_scryptsalsa208sha256_STRPREFIX;
+        AppendItoa64(out, timeCost, 6);
+        AppendItoa64(out, memoryCost, 30);
+        AppendItoa64(out, parallelism, 30);
+        AppendItoa64(out, salt);
+        out += '$';
+        AppendItoa64(out, tag);
+        return out;
+    }
+
+    out.reserve(crypto_pwhash_STRBYTES);
+    out += algorithm == HashAlgorithm::Argon2id ? crypto_pwhash_argon2id_STRPREFIX : crypto_pwhash_argon2i_STRPREFIX;
+    out += "v=" + std::to_string(version);
+    out += "$m=" + std::to_string(memoryCost);
+    out += ",t=" + std::to_string(timeCost);
+    out += ",p=" + std::to_string(parallelism) + "$";
+    AppendBase64(out, salt);
+    out += '$';
+    AppendBase64(out, tag);
+    return out;
+}
+
+std::vector<uint8_t> Generator::PackedHash::ToBytes() const
+{
+    std::vector<uint8_t> out;
+    out.reserve(2 + 4 * 5 + salt.size() + tag.size());
+    out.push_back(s_FormatVersion);
+    out.push_back(AlgorithmId(algorithm));
+    AppendVarint(out, version);
+    AppendVarint(out, timeCost);
+    AppendVarint(out, memoryCost);
+    AppendVarint(out, parallelism);
+    AppendVarint(out, salt.size());
+    out.insert(out.end(), salt.begin(), salt.end());
+    AppendVarint(out, tag.size());
+    out.insert(out.end(), tag.begin(), tag.end());
+    return out;
+}
+
+bool Generator::PackedHash::Verify(const std::string& password) const
+{
+    if (tag.empty())
+        return false;
+
+    std::vector<uint8_t> computed(tag.size());
+    int result = -1;
+    if (algorithm == HashAlgorithm::Scrypt)
+    {
+        // Scrypt hashes with the salt's text form, not its decoded bytes
+        const std::string saltText = ScryptSaltText(*this);
+        result = crypto_pwhash_scryptsalsa208sha256_ll((const uint8_t*)password.data(), password.size(),
+                                                       (const uint8_t*)saltText.data(), saltText.size(),
+                                                       (uint64_t)1 << timeCost, (uint32_t)memoryCost, parallelism,
+                                                       computed.data(), computed.size());
+    }
+    else if (salt.size() != crypto_pwhash_SALTBYTES || parallelism != 1 || version != s_Argon2Version ||
+             tag.size() < crypto_pwhash_BYTES_MIN)
+    {
+        // Valid argon2 but outside what crypto_pwhash() accepts; libsodium's string verifier handles these
+        return GetHashingBackend(algorithm).Verify(password, ToString());
+    }
+    else
+    {
+        const int alg = algorithm == HashAlgorithm::Argon2id ? crypto_pwhash_ALG_ARGON2ID13 : crypto_pwhash_ALG_ARGON2I13;
+        result = crypto_pwhash(computed.data(), computed.size(), password.data(), password.size(), salt.data(),
+                               timeCost, (size_t)(memoryCost * 1024), alg);
+    }
+
+    const bool matches = result == 0 && sodium_memcmp(computed.data(), tag.data(), tag.size()) == 0;
+    sodium_memzero(computed.data(), computed.size());
+    return matches;
+}
+
+size_t Generator::PackedHash::MemoryCost() const
+{
+    if (algorithm == HashAlgorithm::Scrypt)
+        return ScryptMemoryCost(memoryCost, timeCost);
+    return memoryCost > SIZE_MAX / 1024 ? SIZE_MAX : (size_t)(memoryCost * 1024);
+}
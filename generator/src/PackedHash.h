@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HashingBackend.h"
+
+namespace Generator
+{
+    struct PackedHash;
+}
+
+/// A password hash in compact binary form: algorithm id and cost parameters as varints, salt and tag as raw bytes.
+/// An argon2id hash takes 58 bytes instead of its ~97 character encoded string. Converts losslessly to and from the
+/// encoded (PHC / "$7$") strings the hashing backends produce, and verifies without going back to the string.
+///
+/// Layout: format version, algorithm id, then varints for version, timeCost, memoryCost, parallelism, salt length and
+/// tag length, with the salt and tag bytes after their lengths.
+struct Generator::PackedHash
+{
+    HashAlgorithm algorithm = HashAlgorithm::Argon2id;
+    /// Argon2 version (19). 0 for scrypt.
+    uint32_t version = 0;
+    /// Argon2: passes (t). Scrypt: log2(N).
+    uint64_t timeCost = 0;
+    /// Argon2: memory in KiB (m). Scrypt: block size (r).
+    uint64_t memoryCost = 0;
+    /// Argon2 lanes or scrypt p.
+    uint32_t parallelism = 1;
+    /// Raw salt bytes. For scrypt these decode the salt text, which is what scrypt actually hashes with.
+    std::vector<uint8_t> salt;
+    std::vector<uint8_t> tag;
+
+    /**
+     * Parses an encoded hash from one of the hashing backends.
+     * @throws std::invalid_argument if the string isn't a well-formed argon2id, argon2i or scrypt hash, or wouldn't
+     *         survive the round trip unchanged.
+     */
+    [[nodiscard]] static PackedHash FromString(std::string_view encoded);
+
+    /// @throws std::invalid_argument on truncated, trailing or unknown data.
+    [[nodiscard]] static PackedHash FromBytes(const uint8_t* data, size_t size);
+    [[nodiscard]] static PackedHash FromBytes(const std::vector<uint8_t>& bytes) { return FromBytes(bytes.data(), bytes.size()); }
+
+    /// The encoded string FromString() was given.
+    [[nodiscard]] std::string ToString() const;
+    [[nodiscard]] std::vector<uint8_t> ToBytes() const;
+
+    /// Recomputes the tag from the password and compares in constant time. Falls back to the backend's string
+    /// verification for parameters libsodium's raw API can't take (e.g. non-standard salt sizes).
+    [[nodiscard]] bool Verify(const std::string& password) const;
+
+    /// Memory (in bytes) verifying this hash allocates, SIZE_MAX if that doesn't fit in a size_t.
+    [[nodiscard]] size_t MemoryCost() const;
+
+    bool operator==(const PackedHash&) const = default;
+};
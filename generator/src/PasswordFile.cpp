@@ -0,0 +1,123 @@
+#include "PasswordFile.h"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "CompiledPolicy.h"
+
+namespace
+{
+    [[noreturn]] void ThrowErrno(const std::string& what, const std::string& path)
+    {
+        throw std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    /// Reserves the file's blocks up front, so running out of disk space is an error here and not a SIGBUS while
+    /// writing through the mapping.
+    int Preallocate(int fd, off_t size)
+    {
+#if defined(__linux__)
+        if (fallocate(fd, 0, 0, size) == 0)
+            return 0;
+        if (errno != EOPNOTSUPP)
+            return -1;
+        // filesystems without fallocate (e.g. some network mounts) get the portable fallback
+#endif
+#if defined(__APPLE__)
+        return ftruncate(fd, size);
+#else
+        const int result = posix_fallocate(fd, 0, size);
+        if (result != 0)
+            errno = result;
+        return result == 0 ? 0 : -1;
+#endif
+    }
+}
+
+void Generator::WritePasswordFile(const PasswordGenerator& generator, const std::string& path, uint64_t numPasswords)
+{
+    WritePasswordFile(generator, path, numPasswords, PasswordFileOptions{});
+}
+
+void Generator::WritePasswordFile(const PasswordGenerator& generator, const std::string& path, uint64_t numPasswords,
+                                  const PasswordFileOptions& options)
+{
+    const std::shared_ptr<const CompiledPolicy>& compiled = generator.GetCompiledPolicy();
+    if (!compiled->Error().empty())
+        throw std::runtime_error(compiled->Error());
+
+    const uint64_t length = generator.GetPolicy().passwordLength;
+    const uint64_t stride = length + 1;
+    const uint64_t size = numPasswords * stride;
+    if (length == 0 || (numPasswords != 0 && size / numPasswords != stride))
+        throw std::runtime_error("Invalid password file size");
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (options.overwrite ? O_TRUNC : O_EXCL), 0600);
+    if (fd < 0)
+        ThrowErrno("Failed to create", path);
+
+    char* mapping = nullptr;
+    try
+    {
+        if (size == 0)
+        {
+            close(fd);
+            return;
+        }
+        if (Preallocate(fd, (off_t)size) != 0)
+            ThrowErrno("Failed to preallocate", path);
+
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED)
+            ThrowErrno("Failed to map", path);
+        mapping = static_cast<char*>(mapped);
+        madvise(mapping, size, MADV_SEQUENTIAL);
+
+        // each worker owns one contiguous run of records, so no two threads ever touch the same page
+        unsigned threads = options.threads != 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+        threads = (unsigned)std::min<uint64_t>(threads, numPasswords);
+        const uint64_t perThread = (numPasswords + threads - 1) / threads;
+
+        std::vector<std::thread> workers;
+        workers.reserve(threads);
+        for (unsigned t = 0; t < threads; t++)
+        {
+            const uint64_t begin = t * perThread;
+            const uint64_t end = std::min(numPasswords, begin + perThread);
+            workers.emplace_back([&compiled, mapping, stride, length, begin, end, separator = options.separator]() {
+                compiled->FillAdvanced(mapping + begin * stride, end - begin, stride);
+                for (uint64_t i = begin; i < end; i++)
+                    mapping[i * stride + length] = separator;
+            });
+        }
+        for (auto& worker : workers)
+            worker.join();
+
+        if (msync(mapping, size, MS_SYNC) != 0)
+            ThrowErrno("Failed to sync", path);
+        munmap(mapping, size);
+        mapping = nullptr;
+        const int closed = close(fd);
+        fd = -1;
+        if (closed != 0)
+            ThrowErrno("Failed to close", path);
+    }
+    catch (...)
+    {
+        if (mapping)
+            munmap(mapping, size);
+        if (fd >= 0)
+            close(fd);
+        unlink(path.c_str());
+        throw;
+    }
+}
+#endif
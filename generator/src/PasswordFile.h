@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "Generator.h"
+
+namespace Generator
+{
+    struct PasswordFileOptions;
+
+#if !defined(_WIN32)
+    /**
+     * Writes numPasswords advanced passwords of the generator's policy to a new file at path, one per line. The file is
+     * preallocated to its final size and memory mapped; worker threads generate straight into disjoint ranges of fixed
+     * length records in the mapping, so there are no intermediate strings and no write() calls. A final msync() flushes
+     * it. Meant for offline provisioning runs of hundreds of millions of credentials. The file holds plaintext
+     * passwords: it is created with mode 0600, but protecting it afterwards is up to the caller.
+     * @throws std::runtime_error if the policy has no usable characters or a file operation fails. A partially written
+     *         file is removed.
+     */
+    void WritePasswordFile(const PasswordGenerator& generator, const std::string& path, uint64_t numPasswords,
+                           const PasswordFileOptions& options);
+    void WritePasswordFile(const PasswordGenerator& generator, const std::string& path, uint64_t numPasswords);
+#endif
+}
+
+struct Generator::PasswordFileOptions
+{
+    /// Worker threads. 0 means one per hardware thread.
+    unsigned threads = 0;
+    /// Written after every password, making each record passwordLength + 1 bytes.
+    char separator = '\n';
+    /// Replace an existing file instead of failing.
+    bool overwrite = false;
+};
@@ -0,0 +1,202 @@
+#include "PasswordPool.h"
+
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+#include "CompiledPolicy.h"
+#include "ThreadUtils.h"
+
+namespace
+{
+    // slot layout: u32 password length, u32 hash length, password bytes, hash bytes
+    constexpr size_t s_SlotHeaderBytes = 2 * sizeof(uint32_t);
+}
+
+Generator::PasswordPool::PasswordPool(PasswordPolicy policy, PoolOptions options)
+    :
+    generator(std::move(policy)),
+    capacity(std::bit_ceil(std::max<size_t>(options.capacity, 2))),
+    mask(capacity - 1),
+    lowWatermark(std::min(capacity, options.lowWatermark == 0 ? capacity / 4 : options.lowWatermark)),
+    passwordBytes(generator.GetPolicy().passwordLength),
+    slotBytes(s_SlotHeaderBytes + passwordBytes + crypto_pwhash_STRBYTES),
+    cells(std::make_unique<Cell[]>(capacity))
+{
+    // otherwise every refill would fail
+    if (!generator.GetCompiledPolicy()->Error().empty())
+        throw std::invalid_argument(generator.GetCompiledPolicy()->Error());
+
+    // sodium_allocarray memory is mlocked and surrounded by guard pages
+    slots = static_cast<unsigned char*>(sodium_allocarray(capacity, slotBytes));
+    if (!slots)
+        throw std::bad_alloc();
+
+    for (size_t i = 0; i < capacity; i++)
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+
+    for (unsigned i = 0; i < std::max(1u, options.refillWorkers); i++)
+        refillThreads.emplace_back(&PasswordPool::RefillLoop, this);
+}
+
+Generator::PasswordPool::~PasswordPool()
+{
+    {
+        std::lock_guard lock(refillMutex);
+        stopping = true;
+    }
+    refillNeeded.notify_all();
+    for (auto& thread : refillThreads)
+        thread.join();
+
+    // sodium_free zeroes the region before releasing it
+    sodium_free(slots);
+}
+
+std::tuple<std::string, std::string> Generator::PasswordPool::Issue()
+{
+    if (hasRefillError.load(std::memory_order_acquire))
+    {
+        std::exception_ptr error;
+        {
+            std::lock_guard lock(refillMutex);
+            error = std::exchange(refillError, nullptr);
+            hasRefillError = false;
+        }
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    std::string password;
+    std::string hash;
+    if (TryIssue(password, hash))
+        return std::make_tuple(std::move(password), std::move(hash));
+
+    misses.fetch_add(1, std::memory_order_relaxed);
+    refillNeeded.notify_one();
+    return generator.GenerateHashedPassword();
+}
+
+bool Generator::PasswordPool::TryIssue(std::string& password, std::string& hash)
+{
+    size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true)
+    {
+        cell = &cells[pos & mask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+        if (diff == 0)
+        {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return false; // empty
+        }
+        else
+        {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    unsigned char* slot = SlotData(pos & mask);
+    uint32_t passwordLength;
+    uint32_t hashLength;
+    std::memcpy(&passwordLength, slot, sizeof(passwordLength));
+    std::memcpy(&hashLength, slot + sizeof(passwordLength), sizeof(hashLength));
+    password.assign(reinterpret_cast<const char*>(slot + s_SlotHeaderBytes), passwordLength);
+    hash.assign(reinterpret_cast<const char*>(slot + s_SlotHeaderBytes + passwordBytes), hashLength);
+    sodium_memzero(slot, slotBytes);
+
+    // hand the cell back to producers
+    cell->sequence.store(pos + capacity, std::memory_order_release);
+
+    if (Size() < lowWatermark)
+        refillNeeded.notify_one();
+    return true;
+}
+
+size_t Generator::PasswordPool::Size() const
+{
+    const size_t enqueued = enqueuePos.load(std::memory_order_relaxed);
+    const size_t dequeued = dequeuePos.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0;
+}
+
+bool Generator::PasswordPool::TryPush(const std::string& password, const std::string& hash)
+{
+    if (password.length() > passwordBytes || hash.length() > crypto_pwhash_STRBYTES)
+        return false;
+
+    size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true)
+    {
+        cell = &cells[pos & mask];
+        const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const auto diff = (intptr_t)sequence - (intptr_t)pos;
+        if (diff == 0)
+        {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            return false; // full
+        }
+        else
+        {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    unsigned char* slot = SlotData(pos & mask);
+    const auto passwordLength = (uint32_t)password.length();
+    const auto hashLength = (uint32_t)hash.length();
+    std::memcpy(slot, &passwordLength, sizeof(passwordLength));
+    std::memcpy(slot + sizeof(passwordLength), &hashLength, sizeof(hashLength));
+    std::memcpy(slot + s_SlotHeaderBytes, password.data(), passwordLength);
+    std::memcpy(slot + s_SlotHeaderBytes + passwordBytes, hash.data(), hashLength);
+
+    // publish to consumers
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+void Generator::PasswordPool::RefillLoop()
+{
+    LowerCurrentThreadPriority();
+
+    while (!stopping)
+    {
+        {
+            std::unique_lock lock(refillMutex);
+            // the timeout covers wakeups lost between a lock-free pop and this wait
+            refillNeeded.wait_for(lock, std::chrono::milliseconds(100), [this]() { return stopping || Size() < lowWatermark; });
+        }
+
+        try
+        {
+            while (!stopping && Size() < capacity)
+            {
+                auto [password, hash] = generator.GenerateHashedPassword();
+                const bool pushed = TryPush(password, hash);
+                sodium_memzero(password.data(), password.length());
+                if (!pushed)
+                    break;
+            }
+        }
+        catch (...)
+        {
+            // an exception escaping this thread would terminate the process; the next issuer gets it instead
+            std::unique_lock lock(refillMutex);
+            refillError = std::current_exception();
+            hasRefillError = true;
+            // the cause is likely to persist, so don't spin on it
+            refillNeeded.wait_for(lock, std::chrono::seconds(1), [this]() { return stopping.load(); });
+        }
+    }
+}
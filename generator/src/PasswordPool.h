@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "Generator.h"
+
+namespace Generator
+{
+    struct PoolOptions;
+    class PasswordPool;
+}
+
+struct Generator::PoolOptions
+{
+    /// Ready (password, hash) pairs the pool holds at most. Rounded up to a power of two.
+    size_t capacity = 256;
+    /// Refill starts once fewer than this many pairs are left. 0 means a quarter of the capacity.
+    size_t lowWatermark = 0;
+    unsigned refillWorkers = 1;
+};
+
+/// Keeps a bounded stock of pre-generated (password, hash) pairs for one policy, so issuing a credential doesn't pay for
+/// generation and a full hash on the request path. Pairs live in a sodium_malloc'd (mlocked, guard-paged) ring and are
+/// wiped as soon as they are handed out. Issue() is a lock-free pop. Refill runs on low priority background threads.
+class Generator::PasswordPool
+{
+public:
+    /// @throws std::invalid_argument if the policy leaves no characters to generate from.
+    explicit PasswordPool(PasswordPolicy policy, PoolOptions options = {});
+    ~PasswordPool();
+    PasswordPool(const PasswordPool&) = delete;
+    PasswordPool& operator=(const PasswordPool&) = delete;
+
+    /// Same result as PasswordGenerator::GenerateHashedPassword(). Served from the pool when it has stock, generated
+    /// inline otherwise.
+    /// @throws The exception a background refill failed with since the last call, e.g. when hashing fails.
+    [[nodiscard]] std::tuple<std::string, std::string> Issue();
+
+    /// Lock-free pop. Returns false, leaving the outputs untouched, if the pool is empty.
+    [[nodiscard]] bool TryIssue(std::string& password, std::string& hash);
+
+    /// Approximate number of ready pairs.
+    [[nodiscard]] size_t Size() const;
+    [[nodiscard]] size_t Capacity() const { return capacity; }
+    /// Issue() calls that had to fall back to inline generation.
+    [[nodiscard]] uint64_t Misses() const { return misses.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+    };
+
+    bool TryPush(const std::string& password, const std::string& hash);
+    void RefillLoop();
+    [[nodiscard]] unsigned char* SlotData(size_t index) const { return slots + index * slotBytes; }
+
+    const PasswordGenerator generator;
+    const size_t capacity;
+    const size_t mask;
+    const size_t lowWatermark;
+    const size_t passwordBytes;
+    const size_t slotBytes;
+
+    // Bounded MPMC ring (Vyukov). Sequence numbers live in ordinary memory, the secrets in the sodium_malloc'd slots.
+    std::unique_ptr<Cell[]> cells;
+    unsigned char* slots = nullptr;
+    alignas(64) std::atomic<size_t> enqueuePos = 0;
+    alignas(64) std::atomic<size_t> dequeuePos = 0;
+
+    std::atomic<uint64_t> misses = 0;
+    std::atomic<bool> stopping = false;
+    std::atomic<bool> hasRefillError = false;
+    std::mutex refillMutex;
+    /// Guarded by refillMutex. Handed to the next Issue() call.
+    std::exception_ptr refillError;
+    std::condition_variable refillNeeded;
+    std::vector<std::thread> refillThreads;
+};
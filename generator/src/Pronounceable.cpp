@@ -0,0 +1,109 @@
+#include "Pronounceable.h"
+
+#include <cmath>
+#include <limits>
+#include <sodium.h>
+
+namespace
+{
+    // Letter pair counts from a few hundred KB of English prose, each distinct word counted by the square root of its
+    // frequency, pairs under 1% of their row dropped, rows scaled to a maximum of 255.
+    constexpr Generator::BigramWeights s_EnglishBigrams = {{
+        {{176,  85, 240, 133, 136, 130,  63,  60, 113,   0,   0, 103, 139,  71,  78, 173,   0, 131, 255, 179,  65,  48, 106,   0,   0,   0}}, // start
+        {{  0,  76, 106,  65,   0,   0,  58,   0,  61,   0,  24, 193,  56, 202,   0,  73,   0, 217,  75, 255,  32,  25,   0,   0,  31,   0}}, // a
+        {{125,  35,   0,   0, 155,   0,   0,   0,  95,  19,   0, 255,   0,   0,  88,   0,   0, 100,  46,  12, 150,   0,   0,   0,  16,   0}}, // b
+        {{ 93,   0,  22,   0, 132,   0,   0, 114,  50,   0,  44,  49,   0,   0, 255,   0,   0,  41,   0, 132,  47,   0,   0,   0,   0,   0}}, // c
+        {{ 39,   0,   0,  29, 255,   0,   0,   0, 210,   0,   0,  14,   0,   0,  70,   0,   0,  12,  46,  10,  26,   0,   0,   0,   8,   0}}, // d
+        {{ 68,   0,  95, 173,  33,  36,  16,   0,   0,   0,   0,  65,  48, 191,   0,  34,   0, 255, 184,  76,   0,  35,  16,  61,   0,   0}}, // e
+        {{ 51,   0,   0,   0, 105,  86,   0,   0, 255,   0,   0,  25,   0,  10, 197,   0,   0,  50,   0,  56,  68,   0,   0,   0,  26,   0}}, // f
+        {{ 56,   0,   0,   0, 255,   0,  23,  92,  96,   0,   0,  29,   0,  48,  27,   0,   0, 106,  39,   0,  57,  12,   0,   0,   0,   0}}, // g
+        {{160,   0,   0,   0, 255,   0,   0,   0, 133,   0,   0,  14,   0,   0, 115,   0,   0,  16,   8,  51,  12,   0,   0,   0,   0,   0}}, // h
+        {{ 22,  24,  60,  28,  32,  26,  30,   0,   0,   0,   0,  48,  39, 255,  93,  13,   0,  25,  66,  78,   0,  23,   0,   0,   0,   0}}, // i
+        {{ 67,   0,   0,   0, 122,   0,   0,   0,   0,  37,  10,   0,   0,   0, 112,   8,   0,   0,  20,   0, 255,   0,   0,   0,   0,   0}}, // j
+        {{ 23,   0,   0,   7, 255,   0,   0,   0,  85,   0,   9,  17,   0,  36,   0,   0,   0,   0,  95,   0,  17,   0,  10,   0,   6,   0}}, // k
+        {{108,   0,   0,  38, 255,   0,   0,   0, 195,   0,   0, 130,   0,   0, 105,   0,   0,   0,  27,  29,  50,   0,   0,   0, 107,   0}}, // l
+        {{244,  39,   0,  12, 255,   0,   0,   0,  89,   0,   0,   0,  56,   0,  99, 119,   0,   0,  35,   0,  18,   0,   0,   0,   0,   0}}, // m
+        {{ 72,   0,  83, 151, 129,  22, 255,   0,  56,   0,   0,  13,   0,   0,  63,   0,   0,   0, 138, 238,  34,  17,   0,   0,  16,   0}}, // n
+        {{ 11,  15,  32,  41,   0,  15,  17,   0,  13,   0,   0,  56,  91, 255,  25,  55,   0, 172,  42,  45,  86,  37,  49,   0,   0,   0}}, // o
+        {{183,   0,   0,   0, 243,   0,   0,  21,  74,   0,   0, 184,   0,   0, 127,  87,   0, 255,  30,  92,  63,   0,   0,   0,  30,   0}}, // p
+        {{  7,   0,   0,   0,   0,   4,   4,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   5,   0,   0, 255,   0,   0,   0,   0,   0}}, // q
+        {{ 84,   0,  24,  25, 255,   0,  14,   0, 100,   0,  15,  12,  33,  15,  79,   0,   0,  25,  55,  51,  14,   0,   0,   0,  27,   0}}, // r
+        {{ 41,   0,  46,   0, 255,   0,   0,  57, 123,   0,  12,  18,   0,   0,  60,  53,   0,   0,  85, 231,  70,   0,   0,   0,  17,   0}}, // s
+        {{103,   0,  26,   0, 255,   0,   0, 134, 249,   0,   0,  21,   0,   0,  61,   0,   0,  81,  65,  31,  31,   0,  14,   0,  38,   0}}, // t
+        {{ 84,  85,  56,  35,  59,  41,  57,   0,  67,   0,   0, 104, 106, 252,   0,  82,   0, 182, 214, 255,   0,   0,   0,   0,   0,   0}}, // u
+        {{ 62,   0,   0,   0, 255,   0,   0,   0, 129,   0,   0,   0,   0,   0,  17,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0}}, // v
+        {{169,   0,   0,   0,  81,   0,   0, 153, 255,   0,   0,  12,   0,  45, 148,   0,   0,  74,  61,   0,   0,   0,   0,   0,   0,   0}}, // w
+        {{ 69,  12,  89,   0, 122,   0,   0,   0,  85,   0,   0,  10,   0,   0,   0, 199,   0,   0,  14, 255,   0,   0,   0,  59,  17,   0}}, // x
+        {{ 40,  28,   0,   0,  70,   0,   0,   0, 101,   0,   0,  36,  23, 100, 255, 230,   0,  50, 148,  56,   0,   0,  48,   0,   0,  13}}, // y
+        {{ 54,   0,   0,   0, 255,   0,   0,   0,  85,   0,   0,   0,   0,   0,  39,   0,   0,   0,   0,   0,   0,   0,   0,   0,  20,  20}}, // z
+    }};
+
+    constexpr Generator::PronounceableModel s_English(s_EnglishBigrams);
+
+    size_t StateAfter(char letter) { return 1 + (size_t)(letter - 'a'); }
+}
+
+const Generator::PronounceableModel& Generator::PronounceableModel::English()
+{
+    return s_English;
+}
+
+Generator::PronounceableModel Generator::PronounceableModel::Without(std::string_view excludedCharacters) const
+{
+    BigramWeights weights{};
+    for (size_t state = 0; state < weights.size(); state++)
+        for (size_t letter = 0; letter < 26; letter++)
+            weights[state][letter] = tables[state].Weight(letter);
+
+    for (const char c : excludedCharacters)
+    {
+        if (c < 'a' || c > 'z')
+            continue;
+        for (auto& row : weights)
+            row[(size_t)(c - 'a')] = 0;
+    }
+
+    auto isEmpty = [](const std::array<uint32_t, 26>& row) {
+        for (const uint32_t weight : row)
+            if (weight != 0)
+                return false;
+        return true;
+    };
+    if (isEmpty(weights[0]))
+        throw std::runtime_error("No valid characters available for password generation");
+    for (auto& row : weights)
+        if (isEmpty(row))
+            row = weights[0];
+
+    return PronounceableModel(weights);
+}
+
+std::tuple<std::string, double> Generator::PronounceableModel::Generate(size_t length) const
+{
+    std::string password(length, '\0');
+    double entropy = 0;
+    size_t state = 0;
+    for (size_t i = 0; i < length; i++)
+    {
+        const AliasTable<26>& table = tables[state];
+        const size_t letter = table.Sample(randombytes_uniform((uint32_t)table.Range()));
+        entropy += std::log2((double)table.Total() / table.Weight(letter));
+        password[i] = (char)('a' + letter);
+        state = 1 + letter;
+    }
+    return { password, entropy };
+}
+
+double Generator::PronounceableModel::Entropy(std::string_view password) const
+{
+    double entropy = 0;
+    size_t state = 0;
+    for (const char c : password)
+    {
+        if (c < 'a' || c > 'z' || tables[state].Weight((size_t)(c - 'a')) == 0)
+            return std::numeric_limits<double>::infinity();
+        entropy += std::log2((double)tables[state].Total() / tables[state].Weight((size_t)(c - 'a')));
+        state = StateAfter(c);
+    }
+    return entropy;
+}
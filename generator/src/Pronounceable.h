@@ -0,0 +1,47 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+
+#include "AliasTable.h"
+
+namespace Generator
+{
+    /// Letter transition weights: row 0 is the first letter, row 1 + c follows letter 'a' + c.
+    using BigramWeights = std::array<std::array<uint32_t, 26>, 27>;
+
+    class PronounceableModel;
+}
+
+/// First-order Markov model over a-z used for pronounceable passwords. Each of the 27 states owns an alias table, so
+/// generating a character costs one random draw and two table reads; the whole model is about 14 KB.
+class Generator::PronounceableModel
+{
+public:
+    constexpr explicit PronounceableModel(const BigramWeights& weights)
+    {
+        for (size_t state = 0; state < weights.size(); state++)
+            tables[state] = AliasTable<26>(weights[state]);
+    }
+
+    /// Built at compile time from letter-pair frequencies of English prose.
+    [[nodiscard]] static const PronounceableModel& English();
+
+    /// A copy of this model that never emits the given characters (non-letters are ignored). A letter whose
+    /// successors are all excluded continues as if starting a new word.
+    /// @throws std::runtime_error if every letter is excluded.
+    [[nodiscard]] PronounceableModel Without(std::string_view excludedCharacters) const;
+
+    /// Draws a password of the given length. Returns it with its exact entropy in bits under this model,
+    /// i.e. -log2 of the probability of drawing exactly that password.
+    [[nodiscard]] std::tuple<std::string, double> Generate(size_t length) const;
+
+    /// -log2 P(password) under this model. Infinity if the model can't produce it.
+    [[nodiscard]] double Entropy(std::string_view password) const;
+
+private:
+    std::array<AliasTable<26>, 27> tables{};
+};
@@ -0,0 +1,201 @@
+#include "TenantRegistry.h"
+
+#include <stdexcept>
+#include <thread>
+
+#include "CompiledPolicy.h"
+
+namespace
+{
+    std::atomic<size_t> s_NextReaderSlot = 0;
+
+    /// Threads get slots round robin, so up to TenantRegistry's slot count each have one to themselves.
+    size_t HomeSlot()
+    {
+        thread_local const size_t slot = s_NextReaderSlot.fetch_add(1, std::memory_order_relaxed);
+        return slot;
+    }
+}
+
+/// A hazard pointer: the table is published in a slot before it is used, and a writer only frees tables no slot holds.
+/// Stores and loads on both sides are sequentially consistent, so either the writer's scan sees the slot, or the
+/// reader's second look at the current table sees the writer's newer one and claims that instead.
+class Generator::TenantRegistry::ReadGuard
+{
+public:
+    explicit ReadGuard(const TenantRegistry& registry)
+    {
+        const Table* claimed = registry.table.load(std::memory_order_seq_cst);
+        // another thread sharing the home slot (more threads than slots) holds it for a moment; try the next ones
+        for (size_t i = HomeSlot(), attempt = 0; ; i++, attempt++)
+        {
+            ReaderSlot& candidate = registry.readers[i % s_ReaderSlots];
+            const Table* empty = nullptr;
+            if (candidate.table.compare_exchange_strong(empty, claimed, std::memory_order_seq_cst))
+            {
+                slot = &candidate.table;
+                break;
+            }
+            if (attempt % s_ReaderSlots == s_ReaderSlots - 1)
+                std::this_thread::yield();
+        }
+
+        while (true)
+        {
+            const Table* now = registry.table.load(std::memory_order_seq_cst);
+            if (now == claimed)
+                break;
+            claimed = now;
+            slot->store(claimed, std::memory_order_seq_cst);
+        }
+        table = claimed;
+    }
+
+    ~ReadGuard() { slot->store(nullptr, std::memory_order_release); }
+    ReadGuard(const ReadGuard&) = delete;
+    ReadGuard& operator=(const ReadGuard&) = delete;
+
+    [[nodiscard]] const Table& Current() const { return *table; }
+
+private:
+    std::atomic<const Table*>* slot = nullptr;
+    const Table* table = nullptr;
+};
+
+Generator::TenantRegistry::TenantRegistry()
+    :
+    current(std::make_unique<const Table>())
+{
+    table.store(current.get());
+}
+
+Generator::TenantRegistry::~TenantRegistry() = default;
+
+std::shared_ptr<const Generator::PasswordGenerator> Generator::TenantRegistry::Compile(const PasswordPolicy& policy)
+{
+    auto generator = std::make_shared<const PasswordGenerator>(policy);
+    if (!generator->GetCompiledPolicy()->Error().empty())
+        throw std::invalid_argument(generator->GetCompiledPolicy()->Error());
+    return generator;
+}
+
+void Generator::TenantRegistry::SetTenantPolicy(const std::string& tenant, const PasswordPolicy& policy)
+{
+    SetTenantPolicies({ { tenant, policy } });
+}
+
+void Generator::TenantRegistry::SetTenantPolicies(const std::vector<std::pair<std::string, PasswordPolicy>>& policies)
+{
+    // compile before taking the writer lock, equal policies share their compiled form through the policy cache
+    std::vector<std::shared_ptr<const PasswordGenerator>> generators;
+    generators.reserve(policies.size());
+    for (const auto& [tenant, policy] : policies)
+        generators.push_back(Compile(policy));
+
+    std::lock_guard lock(writeMutex);
+    auto next = std::make_unique<Table>(*current);
+    for (size_t i = 0; i < policies.size(); i++)
+        (*next)[policies[i].first] = std::move(generators[i]);
+    Publish(std::move(next));
+}
+
+bool Generator::TenantRegistry::RemoveTenant(const std::string& tenant)
+{
+    std::lock_guard lock(writeMutex);
+    if (!current->contains(tenant))
+        return false;
+
+    auto next = std::make_unique<Table>(*current);
+    next->erase(tenant);
+    Publish(std::move(next));
+    return true;
+}
+
+void Generator::TenantRegistry::Publish(std::unique_ptr<const Table> next)
+{
+    table.store(next.get(), std::memory_order_seq_cst);
+    retired.push_back(std::exchange(current, std::move(next)));
+
+    // Free what no reader holds any more. A table still in use (e.g. by a running hash) waits for a later update or
+    // the destructor, so writers never wait for readers.
+    std::erase_if(retired, [this](const std::unique_ptr<const Table>& old)
+    {
+        for (const ReaderSlot& reader : readers)
+        {
+            if (reader.table.load(std::memory_order_seq_cst) == old.get())
+                return false;
+        }
+        return true;
+    });
+}
+
+std::shared_ptr<const Generator::PasswordGenerator> Generator::TenantRegistry::Find(std::string_view tenant) const
+{
+    const ReadGuard guard(*this);
+    const auto found = guard.Current().find(tenant);
+    return found == guard.Current().end() ? nullptr : found->second;
+}
+
+size_t Generator::TenantRegistry::TenantCount() const
+{
+    const ReadGuard guard(*this);
+    return guard.Current().size();
+}
+
+const Generator::PasswordGenerator& Generator::TenantRegistry::Require(const ReadGuard& guard, std::string_view tenant)
+{
+    const auto found = guard.Current().find(tenant);
+    if (found == guard.Current().end())
+        throw std::out_of_range("Unknown tenant: " + std::string(tenant));
+    return *found->second;
+}
+
+std::string Generator::TenantRegistry::GenerateAdvancedPassword(std::string_view tenant) const
+{
+    const ReadGuard guard(*this);
+    return Require(guard, tenant).GenerateAdvancedPassword();
+}
+
+std::vector<std::string> Generator::TenantRegistry::GenerateAdvancedPasswords(std::string_view tenant,
+                                                                              int numPasswords) const
+{
+    const ReadGuard guard(*this);
+    return Require(guard, tenant).GenerateAdvancedPasswords(numPasswords);
+}
+
+std::tuple<std::string, std::string> Generator::TenantRegistry::GenerateHashedPassword(std::string_view tenant) const
+{
+    const ReadGuard guard(*this);
+    return Require(guard, tenant).GenerateHashedPassword();
+}
+
+std::string Generator::TenantRegistry::HashPasswordSafe(std::string_view tenant, std::string password) const
+{
+    const ReadGuard guard(*this);
+    const auto found = guard.Current().find(tenant);
+    if (found == guard.Current().end())
+    {
+        sodium_memzero(password.data(), password.size());
+        throw std::out_of_range("Unknown tenant: " + std::string(tenant));
+    }
+    return found->second->HashPasswordSafe(std::move(password));
+}
+
+bool Generator::TenantRegistry::VerifyPasswordSafe(std::string_view tenant, std::string password,
+                                                   const std::string& hash) const
+{
+    const ReadGuard guard(*this);
+    const auto found = guard.Current().find(tenant);
+    if (found == guard.Current().end())
+    {
+        sodium_memzero(password.data(), password.size());
+        throw std::out_of_range("Unknown tenant: " + std::string(tenant));
+    }
+    return found->second->VerifyPasswordSafe(std::move(password), hash);
+}
+
+bool Generator::TenantRegistry::NeedsRehash(std::string_view tenant, const std::string& hash) const
+{
+    const ReadGuard guard(*this);
+    return Require(guard, tenant).NeedsRehash(hash);
+}
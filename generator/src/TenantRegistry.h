@@ -0,0 +1,91 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Generator.h"
+
+namespace Generator
+{
+    class TenantRegistry;
+}
+
+/// Maps tenant ids to immutable, precompiled PasswordGenerators so one process can generate and hash for many
+/// policies at once. Updates copy the tenant table, change the copy and publish it through a plain atomic pointer
+/// (copy-on-write), so readers always see a consistent snapshot. A reader claims a hazard slot for the table it reads,
+/// one per thread on a cache line of its own, instead of bumping a shared reference count; a writer frees a replaced
+/// table once no slot holds it any more. Lookups therefore never lock and never write memory other threads read.
+class Generator::TenantRegistry
+{
+public:
+    TenantRegistry();
+    /// No call may still be running on the registry.
+    ~TenantRegistry();
+    TenantRegistry(const TenantRegistry&) = delete;
+    TenantRegistry& operator=(const TenantRegistry&) = delete;
+
+    /**
+     * Adds a tenant or replaces its policy. The policy is compiled and checked here, not on the first request.
+     * @throws std::invalid_argument if the policy's rules contradict each other or it has no usable characters.
+     */
+    void SetTenantPolicy(const std::string& tenant, const PasswordPolicy& policy);
+
+    /// SetTenantPolicy() for many tenants with a single table copy. Nothing is published if any policy is invalid.
+    void SetTenantPolicies(const std::vector<std::pair<std::string, PasswordPolicy>>& policies);
+
+    /// Returns false if the tenant wasn't registered.
+    bool RemoveTenant(const std::string& tenant);
+
+    /// The tenant's generator, or nullptr for an unknown tenant. Holding on to it pins that policy version. The calls
+    /// below skip the reference count and use the generator in place, so prefer them for single operations.
+    [[nodiscard]] std::shared_ptr<const PasswordGenerator> Find(std::string_view tenant) const;
+
+    [[nodiscard]] size_t TenantCount() const;
+
+    /// The PasswordGenerator calls of the tenant's policy. All throw std::out_of_range for an unknown tenant.
+    [[nodiscard]] std::string GenerateAdvancedPassword(std::string_view tenant) const;
+    [[nodiscard]] std::vector<std::string> GenerateAdvancedPasswords(std::string_view tenant, int numPasswords) const;
+    [[nodiscard]] std::tuple<std::string, std::string> GenerateHashedPassword(std::string_view tenant) const;
+    [[nodiscard]] std::string HashPasswordSafe(std::string_view tenant, std::string password) const;
+    [[nodiscard]] bool VerifyPasswordSafe(std::string_view tenant, std::string password, const std::string& hash) const;
+    [[nodiscard]] bool NeedsRehash(std::string_view tenant, const std::string& hash) const;
+
+private:
+    struct TenantHash
+    {
+        using is_transparent = void;
+        size_t operator()(std::string_view tenant) const { return std::hash<std::string_view>{}(tenant); }
+    };
+    using Table = std::unordered_map<std::string, std::shared_ptr<const PasswordGenerator>, TenantHash, std::equal_to<>>;
+
+    /// Pins the current table for as long as it lives.
+    class ReadGuard;
+    static constexpr size_t s_ReaderSlots = 128;
+    struct alignas(64) ReaderSlot
+    {
+        std::atomic<const Table*> table = nullptr;
+    };
+
+    /// The tenant's generator in the guarded table. Throws std::out_of_range for an unknown tenant.
+    [[nodiscard]] static const PasswordGenerator& Require(const ReadGuard& guard, std::string_view tenant);
+    static std::shared_ptr<const PasswordGenerator> Compile(const PasswordPolicy& policy);
+    /// Makes next the current table. Caller holds writeMutex.
+    void Publish(std::unique_ptr<const Table> next);
+
+    std::atomic<const Table*> table;
+    mutable std::array<ReaderSlot, s_ReaderSlots> readers;
+
+    /// Serializes writers and guards everything below; readers never touch it.
+    std::mutex writeMutex;
+    std::unique_ptr<const Table> current;
+    /// Replaced tables a reader may still hold.
+    std::vector<std::unique_ptr<const Table>> retired;
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+namespace Generator
+{
+    /// Drops the calling thread to the lowest scheduling priority the OS allows without privileges. Background
+    /// refill and rehash threads use this so they only soak up otherwise idle CPU. Best effort, failures are ignored.
+    void LowerCurrentThreadPriority();
+
+    /// Restricts the calling thread to one CPU. Returns false where that isn't supported (currently everything but Linux).
+    bool PinCurrentThreadToCpu(int cpu);
+}
@@ -0,0 +1,123 @@
+#include "TokenService.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+namespace
+{
+    // Tokens whose random bytes are fetched per randombytes_buf() call
+    constexpr size_t s_TokenBatch = 256;
+
+    // sodium_malloc only returns aligned memory for sizes that are a multiple of the alignment
+    static_assert(sizeof(crypto_generichash_state) % alignof(crypto_generichash_state) == 0);
+}
+
+Generator::TokenService::TokenService(const std::vector<uint8_t>& pepper)
+{
+    if (pepper.size() < crypto_generichash_KEYBYTES_MIN || pepper.size() > crypto_generichash_KEYBYTES_MAX)
+        throw std::invalid_argument("Token pepper must be between " + std::to_string(crypto_generichash_KEYBYTES_MIN) +
+                                    " and " + std::to_string(crypto_generichash_KEYBYTES_MAX) + " bytes");
+
+    // sodium_malloc memory is mlocked and surrounded by guard pages
+    keyedState = static_cast<crypto_generichash_state*>(sodium_malloc(sizeof(crypto_generichash_state)));
+    if (!keyedState)
+        throw std::bad_alloc();
+    if (crypto_generichash_init(keyedState, pepper.data(), pepper.size(), crypto_generichash_BYTES) != 0)
+    {
+        sodium_free(keyedState);
+        throw std::runtime_error("Failed to initialize token hashing");
+    }
+}
+
+Generator::TokenService::~TokenService()
+{
+    // sodium_free zeroes the region before releasing it
+    sodium_free(keyedState);
+}
+
+std::vector<uint8_t> Generator::TokenService::GeneratePepper()
+{
+    std::vector<uint8_t> pepper(crypto_generichash_KEYBYTES);
+    randombytes_buf(pepper.data(), pepper.size());
+    return pepper;
+}
+
+std::string Generator::TokenService::GenerateToken() const
+{
+    std::string token(s_TokenLength, '\0');
+    FillTokens(token.data(), 1);
+    return token;
+}
+
+std::vector<std::string> Generator::TokenService::GenerateTokens(size_t numTokens) const
+{
+    std::string packed(numTokens * s_TokenLength, '\0');
+    FillTokens(packed.data(), numTokens);
+
+    std::vector<std::string> tokens;
+    tokens.reserve(numTokens);
+    for (size_t i = 0; i < numTokens; i++)
+        tokens.emplace_back(packed, i * s_TokenLength, s_TokenLength);
+    sodium_memzero(packed.data(), packed.size());
+    return tokens;
+}
+
+void Generator::TokenService::FillTokens(char* out, size_t numTokens) const
+{
+    std::array<uint8_t, s_TokenBatch * s_TokenBytes> random{};
+    // bin2base64 always writes a terminating NUL, so encode through a buffer one byte longer than a token
+    char encoded[s_TokenLength + 1];
+
+    for (size_t done = 0; done < numTokens;)
+    {
+        const size_t batch = std::min(s_TokenBatch, numTokens - done);
+        randombytes_buf(random.data(), batch * s_TokenBytes);
+        for (size_t i = 0; i < batch; i++, done++)
+        {
+            sodium_bin2base64(encoded, sizeof(encoded), random.data() + i * s_TokenBytes, s_TokenBytes,
+                              sodium_base64_VARIANT_URLSAFE_NO_PADDING);
+            std::memcpy(out + done * s_TokenLength, encoded, s_TokenLength);
+        }
+    }
+    sodium_memzero(random.data(), random.size());
+    sodium_memzero(encoded, sizeof(encoded));
+}
+
+Generator::TokenDigest Generator::TokenService::HashToken(std::string_view token) const
+{
+    // the copy holds the pepper block (and then the token) on the stack until it is wiped
+    crypto_generichash_state state = *keyedState;
+    TokenDigest digest;
+    crypto_generichash_update(&state, (const unsigned char*)token.data(), token.size());
+    crypto_generichash_final(&state, digest.data(), digest.size());
+    sodium_memzero(&state, sizeof(state));
+    return digest;
+}
+
+std::vector<Generator::TokenDigest> Generator::TokenService::HashTokens(const std::vector<std::string>& tokens) const
+{
+    std::vector<TokenDigest> digests;
+    digests.reserve(tokens.size());
+    for (const std::string& token : tokens)
+        digests.push_back(HashToken(token));
+    return digests;
+}
+
+bool Generator::TokenService::VerifyToken(std::string_view token, const TokenDigest& digest) const
+{
+    const TokenDigest computed = HashToken(token);
+    return sodium_memcmp(computed.data(), digest.data(), digest.size()) == 0;
+}
+
+std::vector<bool> Generator::TokenService::VerifyTokens(const std::vector<std::string>& tokens, const std::vector<TokenDigest>& digests) const
+{
+    if (tokens.size() != digests.size())
+        throw std::invalid_argument("Every token needs exactly one digest");
+
+    std::vector<bool> verified(tokens.size());
+    for (size_t i = 0; i < tokens.size(); i++)
+        verified[i] = VerifyToken(tokens[i], digests[i]);
+    return verified;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sodium.h>
+
+namespace Generator
+{
+    /// Keyed BLAKE2b digest of a token, what gets stored instead of the token itself.
+    using TokenDigest = std::array<uint8_t, crypto_generichash_BYTES>;
+
+    class TokenService;
+}
+
+/// Issues and verifies machine API tokens: 256-bit random strings, stored as a BLAKE2b digest keyed with a server-side
+/// pepper. A token carries its full 256 bits of entropy, so unlike a password it needs no memory-hard hash; one keyed
+/// BLAKE2b call makes the stored digest useless without the pepper and costs well under a microsecond.
+/// The keyed BLAKE2b state is set up once and copied for every hash. Until more input arrives that state still holds
+/// the zero-padded pepper block in the clear, so it lives in sodium_malloc'd (mlocked, guard-paged) memory and each
+/// per-hash copy is wiped.
+/// Thread-safe: every call only reads the service.
+class Generator::TokenService
+{
+public:
+    /// Random bytes in a token.
+    static constexpr size_t s_TokenBytes = 32;
+    /// Characters in a token: its random bytes as unpadded URL-safe base64.
+    static constexpr size_t s_TokenLength = (s_TokenBytes * 4 + 2) / 3;
+
+    /// @throws std::invalid_argument unless the pepper is between crypto_generichash_KEYBYTES_MIN and _MAX bytes.
+    explicit TokenService(const std::vector<uint8_t>& pepper);
+    ~TokenService();
+
+    TokenService(const TokenService&) = delete;
+    TokenService& operator=(const TokenService&) = delete;
+
+    /// A fresh random pepper of crypto_generichash_KEYBYTES bytes. Keep it out of the database the digests are in.
+    [[nodiscard]] static std::vector<uint8_t> GeneratePepper();
+
+    [[nodiscard]] std::string GenerateToken() const;
+    /// Random bytes for the whole batch are fetched a block at a time rather than per token.
+    [[nodiscard]] std::vector<std::string> GenerateTokens(size_t numTokens) const;
+    /// Writes numTokens tokens back to back (no separators) into out, which must hold numTokens * s_TokenLength bytes.
+    void FillTokens(char* out, size_t numTokens) const;
+
+    [[nodiscard]] TokenDigest HashToken(std::string_view token) const;
+    [[nodiscard]] std::vector<TokenDigest> HashTokens(const std::vector<std::string>& tokens) const;
+
+    /// Constant-time comparison of the token's digest with the stored one.
+    [[nodiscard]] bool VerifyToken(std::string_view token, const TokenDigest& digest) const;
+    /// @throws std::invalid_argument if tokens and digests differ in size.
+    [[nodiscard]] std::vector<bool> VerifyTokens(const std::vector<std::string>& tokens, const std::vector<TokenDigest>& digests) const;
+
+private:
+    /// BLAKE2b state initialized with the pepper, which is buffered in it as plaintext.
+    crypto_generichash_state* keyedState = nullptr;
+};
@@ -0,0 +1,284 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    /// One event. The sequence number makes it a seqlock: odd while the owning thread writes it, 2 * (index + 1) once
+    /// event number index is complete, so an exporter can tell a torn or recycled slot from a finished one.
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence = 0;
+        std::atomic<const char*> category = nullptr;
+        std::atomic<const char*> name = nullptr;
+        std::atomic<uint64_t> startNs = 0;
+        std::atomic<uint64_t> endNs = 0;
+        /// Buffers are passed on when their thread exits, so every event keeps the id of the thread that recorded it.
+        std::atomic<uint32_t> threadId = 0;
+    };
+
+    /// Written by the thread that holds it only, read by exporters.
+    struct ThreadBuffer
+    {
+        explicit ThreadBuffer(size_t capacity)
+            :
+            slots(std::make_unique<Slot[]>(capacity)),
+            capacity(capacity)
+        {
+        }
+
+        std::unique_ptr<Slot[]> slots;
+        const size_t capacity;
+        /// The holding thread's id, set under the registry mutex when the buffer is handed out.
+        uint32_t threadId = 0;
+        /// Events ever recorded.
+        std::atomic<uint64_t> head = 0;
+        /// Events before this were dropped by Clear().
+        std::atomic<uint64_t> tail = 0;
+    };
+
+    struct Registry
+    {
+        std::mutex mutex;
+        // buffers outlive their threads, so a worker's events can still be exported after it exits
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        // buffers of exited threads, handed to the next new thread: there are never more buffers than threads that
+        // recorded at the same time, however many short-lived threads come and go
+        std::vector<std::shared_ptr<ThreadBuffer>> idle;
+        std::map<uint32_t, std::string> threadNames;
+        uint32_t nextThreadId = 1;
+    };
+
+    std::atomic<size_t> s_EventsPerThread = 65536;
+    std::atomic<uint64_t> s_OriginNs = 0;
+
+    Registry& GetRegistry()
+    {
+        // leaked on purpose: threads may still record while static destructors run
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+
+    /// Holds the calling thread's buffer and puts it on the idle list when the thread exits.
+    class BufferLease
+    {
+    public:
+        BufferLease() = default;
+        BufferLease(const BufferLease&) = delete;
+        BufferLease& operator=(const BufferLease&) = delete;
+
+        ~BufferLease()
+        {
+            if (!buffer)
+                return;
+            Registry& registry = GetRegistry();
+            std::lock_guard lock(registry.mutex);
+            registry.idle.push_back(std::move(buffer));
+        }
+
+        ThreadBuffer& Get()
+        {
+            if (!buffer)
+                Acquire();
+            return *buffer;
+        }
+
+    private:
+        void Acquire()
+        {
+            Registry& registry = GetRegistry();
+            const size_t capacity = s_EventsPerThread.load();
+            std::lock_guard lock(registry.mutex);
+            if (registry.idle.empty())
+            {
+                buffer = std::make_shared<ThreadBuffer>(capacity);
+                registry.buffers.push_back(buffer);
+            }
+            else
+            {
+                buffer = std::move(registry.idle.back());
+                registry.idle.pop_back();
+                // a different size means a new buffer; exporters still reading the old one keep it alive
+                if (buffer->capacity != capacity)
+                {
+                    auto replaced = std::find(registry.buffers.begin(), registry.buffers.end(), buffer);
+                    buffer = std::make_shared<ThreadBuffer>(capacity);
+                    *replaced = buffer;
+                }
+            }
+            buffer->threadId = registry.nextThreadId++;
+        }
+
+        std::shared_ptr<ThreadBuffer> buffer;
+    };
+
+    ThreadBuffer& CurrentBuffer()
+    {
+        thread_local BufferLease lease;
+        return lease.Get();
+    }
+
+    void WriteJsonString(std::ostream& out, const char* value)
+    {
+        out << '"';
+        for (const char* c = value; *c; c++)
+        {
+            if (*c == '"' || *c == '\\')
+                out << '\\' << *c;
+            else if ((unsigned char)*c < 0x20)
+                out << ' ';
+            else
+                out << *c;
+        }
+        out << '"';
+    }
+}
+
+uint64_t Generator::Trace::Detail::Now()
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() + 1;
+}
+
+void Generator::Trace::Detail::Record(const char* category, const char* name, uint64_t startNs, uint64_t endNs)
+{
+    ThreadBuffer& buffer = CurrentBuffer();
+    const uint64_t index = buffer.head.load(std::memory_order_relaxed);
+    Slot& slot = buffer.slots[index % buffer.capacity];
+
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.category.store(category, std::memory_order_relaxed);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.endNs.store(endNs, std::memory_order_relaxed);
+    slot.threadId.store(buffer.threadId, std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+    buffer.head.store(index + 1, std::memory_order_release);
+}
+
+void Generator::Trace::Enable(size_t eventsPerThread)
+{
+    if (eventsPerThread == 0)
+        throw std::invalid_argument("Trace buffers need room for at least one event");
+    s_EventsPerThread = eventsPerThread;
+    uint64_t unset = 0;
+    s_OriginNs.compare_exchange_strong(unset, Detail::Now());
+    Detail::s_Enabled = true;
+}
+
+void Generator::Trace::Disable()
+{
+    Detail::s_Enabled = false;
+}
+
+void Generator::Trace::Clear()
+{
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    for (const auto& buffer : registry.buffers)
+        buffer->tail.store(buffer->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+
+    // nothing is left to export from exited threads, so their buffers and names go
+    for (const auto& buffer : registry.idle)
+        registry.buffers.erase(std::find(registry.buffers.begin(), registry.buffers.end(), buffer));
+    registry.idle.clear();
+    std::erase_if(registry.threadNames, [&registry](const auto& entry)
+    {
+        return std::none_of(registry.buffers.begin(), registry.buffers.end(),
+                            [&entry](const auto& buffer) { return buffer->threadId == entry.first; });
+    });
+}
+
+void Generator::Trace::SetThreadName(const std::string& name)
+{
+    const uint32_t threadId = CurrentBuffer().threadId;
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    registry.threadNames[threadId] = name;
+}
+
+size_t Generator::Trace::WriteChromeTrace(std::ostream& out)
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+    std::map<uint32_t, std::string> threadNames;
+    {
+        Registry& registry = GetRegistry();
+        std::lock_guard lock(registry.mutex);
+        buffers = registry.buffers;
+        threadNames = registry.threadNames;
+    }
+    const uint64_t origin = s_OriginNs.load();
+
+    size_t written = 0;
+    bool first = true;
+    const auto separator = [&]() -> std::ostream&
+    {
+        out << (first ? "\n" : ",\n");
+        first = false;
+        return out;
+    };
+
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    for (const auto& [threadId, name] : threadNames)
+    {
+        separator() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadId
+                    << ",\"args\":{\"name\":";
+        WriteJsonString(out, name.c_str());
+        out << "}}";
+    }
+    for (const auto& buffer : buffers)
+    {
+        const uint64_t head = buffer->head.load(std::memory_order_acquire);
+        uint64_t index = std::max(buffer->tail.load(std::memory_order_relaxed),
+                                  head > buffer->capacity ? head - buffer->capacity : 0);
+        for (; index < head; index++)
+        {
+            const Slot& slot = buffer->slots[index % buffer->capacity];
+            const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+            const char* category = slot.category.load(std::memory_order_relaxed);
+            const char* name = slot.name.load(std::memory_order_relaxed);
+            const uint64_t startNs = slot.startNs.load(std::memory_order_relaxed);
+            const uint64_t endNs = slot.endNs.load(std::memory_order_relaxed);
+            const uint32_t threadId = slot.threadId.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            // the owning thread has lapped the buffer and is reusing this slot
+            if (before != 2 * index + 2 || slot.sequence.load(std::memory_order_relaxed) != before)
+                continue;
+
+            // Chrome traces count in microseconds
+            const uint64_t relativeNs = startNs > origin ? startNs - origin : 0;
+            separator() << "{\"name\":";
+            WriteJsonString(out, name);
+            out << ",\"cat\":";
+            WriteJsonString(out, category);
+            out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << threadId
+                << ",\"ts\":" << relativeNs / 1000 << '.' << std::to_string(1000 + relativeNs % 1000).substr(1)
+                << ",\"dur\":" << (endNs - startNs) / 1000 << '.' << std::to_string(1000 + (endNs - startNs) % 1000).substr(1)
+                << '}';
+            written++;
+        }
+    }
+    out << "\n]}\n";
+    return written;
+}
+
+size_t Generator::Trace::WriteChromeTrace(const std::string& path)
+{
+    std::ofstream file(path, std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("Failed to open " + path);
+    const size_t written = WriteChromeTrace(file);
+    file.flush();
+    if (!file)
+        throw std::runtime_error("Failed to write " + path);
+    return written;
+}
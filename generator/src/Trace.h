@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+/// Timeline tracing of the library's expensive operations (generate, hash, verify, mlock, budget waits, storage), for
+/// finding out where a slow bulk job spends its time. Spans are recorded into a ring buffer per thread without locks
+/// and exported as Chrome trace JSON, which chrome://tracing and ui.perfetto.dev open. A thread's buffer is passed on
+/// to the next new thread once it exits, so short-lived workers don't each keep one.
+/// Tracing is off by default. A disabled Span costs one relaxed atomic load, so the spans stay compiled in and
+/// tracing can be switched on in a running process.
+namespace Generator::Trace
+{
+    namespace Detail
+    {
+        inline std::atomic<bool> s_Enabled = false;
+
+        /// Nanoseconds on the steady clock. Never 0.
+        [[nodiscard]] uint64_t Now();
+        void Record(const char* category, const char* name, uint64_t startNs, uint64_t endNs);
+    }
+
+    /**
+     * Starts recording.
+     * @param eventsPerThread Size of each thread's ring buffer, which is created (or taken over from an exited
+     *                        thread) the first time the thread records. Once full, the oldest events in it are
+     *                        overwritten. Buffers that threads hold already keep their size.
+     * @throws std::invalid_argument if eventsPerThread is 0.
+     */
+    void Enable(size_t eventsPerThread = 65536);
+    /// Stops recording. What was recorded stays exportable.
+    void Disable();
+    [[nodiscard]] inline bool IsEnabled() { return Detail::s_Enabled.load(std::memory_order_relaxed); }
+
+    /// Drops every event recorded so far, and frees the buffers of threads that have exited.
+    void Clear();
+
+    /// Names the calling thread in exported traces.
+    void SetThreadName(const std::string& name);
+
+    /**
+     * Writes every event still in the ring buffers as a Chrome trace ({"traceEvents": [...]}, complete "X" events).
+     * Safe while other threads keep recording; an event overwritten during the export is skipped.
+     * @returns The number of events written.
+     */
+    size_t WriteChromeTrace(std::ostream& out);
+    /// @throws std::runtime_error if the file can't be written.
+    size_t WriteChromeTrace(const std::string& path);
+
+    /// Records the time from construction to destruction on the current thread, if tracing was enabled when it was
+    /// constructed. category and name must outlive the trace (string literals): only the pointers are stored.
+    class Span
+    {
+    public:
+        Span(const char* category, const char* name)
+            :
+            category(category),
+            name(name),
+            startNs(IsEnabled() ? Detail::Now() : 0)
+        {
+        }
+
+        ~Span()
+        {
+            if (startNs != 0)
+                Detail::Record(category, name, startNs, Detail::Now());
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* category;
+        const char* name;
+        uint64_t startNs;
+    };
+}
@@ -0,0 +1,77 @@
+#include "UniqueSet.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+namespace
+{
+    // splitmix64 finalizer
+    uint64_t Mix(uint64_t value)
+    {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ull;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebull;
+        value ^= value >> 31;
+        return value;
+    }
+}
+
+uint64_t Generator::HashFixedLength(const char* data, size_t length)
+{
+    uint64_t hash = 0x9e3779b97f4a7c15ull ^ length;
+    while (length >= 8)
+    {
+        uint64_t chunk;
+        std::memcpy(&chunk, data, 8);
+        hash = Mix(hash ^ chunk);
+        data += 8;
+        length -= 8;
+    }
+    if (length > 0)
+    {
+        uint64_t tail = 0;
+        std::memcpy(&tail, data, length);
+        hash = Mix(hash ^ tail ^ 0xff51afd7ed558ccdull);
+    }
+    return hash;
+}
+
+Generator::FixedLengthUniqueSet::FixedLengthUniqueSet(const char* records, size_t recordLength, size_t maxRecords)
+    :
+    records(records),
+    recordLength(recordLength)
+{
+    if (maxRecords >= s_IndexMask)
+        throw std::invalid_argument("Too many records for the unique set");
+
+    slots.assign(std::bit_ceil(std::max<size_t>(maxRecords * 2, 16)), 0);
+    mask = slots.size() - 1;
+}
+
+bool Generator::FixedLengthUniqueSet::Insert(size_t index)
+{
+    const char* record = records + index * recordLength;
+    const uint64_t hash = HashFixedLength(record, recordLength);
+    const uint64_t tag = hash >> s_IndexBits;
+
+    // linear probing, the table is at most half full
+    for (size_t slot = hash & mask; ; slot = (slot + 1) & mask)
+    {
+        const uint64_t entry = slots[slot];
+        if (entry == 0)
+        {
+            slots[slot] = (tag << s_IndexBits) | (index + 1);
+            size++;
+            return true;
+        }
+
+        if ((entry >> s_IndexBits) == tag)
+        {
+            const size_t existing = (size_t)(entry & s_IndexMask) - 1;
+            if (std::memcmp(records + existing * recordLength, record, recordLength) == 0)
+                return false;
+        }
+    }
+}
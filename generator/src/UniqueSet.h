@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Generator
+{
+    class FixedLengthUniqueSet;
+
+    /// Fast non-cryptographic 64-bit hash for short fixed-length keys (8 bytes per multiply-mix round).
+    [[nodiscard]] uint64_t HashFixedLength(const char* data, size_t length);
+}
+
+/// Open-addressing hash set over fixed-length records that live in a caller-owned buffer (record i starts at
+/// records + i * recordLength). The table itself holds only one 64-bit word per slot: the record index plus a tag of
+/// the hash's top bits, so most probes are rejected without touching the record bytes.
+class Generator::FixedLengthUniqueSet
+{
+public:
+    /// @param maxRecords The most records that will ever be inserted. The table is sized for a load factor under 0.5.
+    FixedLengthUniqueSet(const char* records, size_t recordLength, size_t maxRecords);
+
+    /// Adds record index unless an equal record is already in the set. Returns false on a duplicate.
+    bool Insert(size_t index);
+
+    [[nodiscard]] size_t Size() const { return size; }
+
+private:
+    static constexpr unsigned s_IndexBits = 40;
+    static constexpr uint64_t s_IndexMask = (1ull << s_IndexBits) - 1;
+
+    const char* records;
+    const size_t recordLength;
+    std::vector<uint64_t> slots; // 0 = empty, otherwise (tag << s_IndexBits) | (index + 1)
+    size_t mask;
+    size_t size = 0;
+};
@@ -0,0 +1,269 @@
+#include "WeightedAlphabet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    const std::array<const std::string*, 4> s_ClassChars = {
+        &Generator::s_LowerCaseChars, &Generator::s_UpperCaseChars, &Generator::s_NumbersChars,
+        &Generator::s_SymbolsChars };
+
+    // draws are 32-bit words
+    constexpr uint64_t s_MaxRange = UINT32_MAX;
+
+    bool ClassEnabled(const Generator::PasswordPolicy& policy, size_t characterClass)
+    {
+        switch (characterClass)
+        {
+            case 0: return policy.requireLowercase;
+            case 1: return policy.requireUppercase;
+            case 2: return policy.requireNumbers;
+            default: return policy.requireSymbols;
+        }
+    }
+
+    /// Uniform numbers from random words drawn in batches. Each libsodium randombytes call can be a getrandom() syscall,
+    /// so one call per character (randombytes_uniform) would cost more than the character itself.
+    class RandomWords
+    {
+    public:
+        /// @param expected Words the caller will likely need, so a short password doesn't draw a whole batch.
+        explicit RandomWords(uint64_t expected) : expected(expected) {}
+        ~RandomWords() { sodium_memzero(words.data(), drawn * sizeof(uint32_t)); }
+        RandomWords(const RandomWords&) = delete;
+        RandomWords& operator=(const RandomWords&) = delete;
+
+        /// Unbiased number in [0, bound), by the same rejection as randombytes_uniform().
+        uint32_t Uniform(uint32_t bound)
+        {
+            if (bound < 2)
+                return 0;
+            // 2^32 mod bound: words below it would favour the low results
+            const uint32_t min = (uint32_t)(0u - bound) % bound;
+            uint32_t word;
+            do
+            {
+                word = Next();
+            } while (word < min);
+            return word % bound;
+        }
+
+    private:
+        uint32_t Next()
+        {
+            if (next == available)
+            {
+                available = (size_t)std::min<uint64_t>(words.size(), expected + 8);
+                expected = expected > available ? expected - available : 0;
+                randombytes_buf(words.data(), available * sizeof(uint32_t));
+                drawn = std::max(drawn, available);
+                next = 0;
+            }
+            return words[next++];
+        }
+
+        std::array<uint32_t, 4096> words;
+        size_t available = 0, next = 0, drawn = 0;
+        uint64_t expected;
+    };
+
+    size_t Draw(const Generator::AliasTable<128>& table, RandomWords& random)
+    {
+        return table.Sample(random.Uniform((uint32_t)table.Range()));
+    }
+}
+
+int Generator::WeightedAlphabet::ClassOf(char c)
+{
+    for (size_t k = 0; k < s_ClassChars.size(); k++)
+        if (s_ClassChars[k]->find(c) != std::string::npos)
+            return (int)k;
+    return -1;
+}
+
+Generator::WeightedAlphabet::WeightedAlphabet(const PasswordPolicy& policy)
+{
+    // per-character weights within each class, before class shares are applied
+    std::array<std::array<uint64_t, 128>, 4> classWeights{};
+    std::array<uint64_t, 4> classSums{};
+    bool anyClassWeight = false;
+    for (size_t k = 0; k < 4; k++)
+    {
+        const CharacterClassRule& rule = policy.classRules[k];
+        if (rule.minCount > rule.maxCount)
+            throw std::invalid_argument("Character class minCount is larger than its maxCount");
+
+        minCounts[k] = rule.minCount;
+        maxCounts[k] = rule.maxCount;
+        if (!ClassEnabled(policy, k))
+        {
+            if (rule.minCount > 0)
+                throw std::invalid_argument("minCount set for a character class the policy doesn't use");
+            maxCounts[k] = 0;
+            continue;
+        }
+
+        anyClassWeight = anyClassWeight || rule.weight > 0;
+        for (const char c : *s_ClassChars[k])
+        {
+            if (policy.excludedCharacters.find(c) != std::string::npos)
+                continue;
+            const auto weight = policy.characterWeights.find(c);
+            classWeights[k][(size_t)c] = weight == policy.characterWeights.end() ? 1 : weight->second;
+            classSums[k] += classWeights[k][(size_t)c];
+        }
+        if (classSums[k] == 0)
+        {
+            if (rule.minCount > 0)
+                throw std::invalid_argument("minCount set for a character class with no usable characters");
+            maxCounts[k] = 0;
+        }
+    }
+
+    // With class weights, scale every class to the common multiple of the class sums so class k's total is exactly
+    // weight_k * lcm. Without, characters keep their own weights (uniform by default, like the unweighted path).
+    uint64_t lcm = 1;
+    if (anyClassWeight)
+    {
+        for (size_t k = 0; k < 4; k++)
+        {
+            if (classSums[k] != 0 && policy.classRules[k].weight > 0)
+                lcm = std::lcm(lcm, classSums[k]);
+            if (lcm > s_MaxRange)
+                throw std::invalid_argument("Character weights are too fine-grained");
+        }
+    }
+
+    std::array<uint32_t, 128> allWeights{};
+    uint64_t total = 0;
+    for (size_t k = 0; k < 4; k++)
+    {
+        if (classSums[k] == 0)
+            continue;
+
+        const uint64_t scale = anyClassWeight ? policy.classRules[k].weight * (lcm / classSums[k]) : 1;
+        if (scale == 0)
+            maxCounts[k] = std::min(maxCounts[k], minCounts[k]);
+        if (scale > s_MaxRange / 128)
+            throw std::invalid_argument("Character weights are too large");
+
+        std::array<uint32_t, 128> ownWeights{};
+        for (size_t c = 0; c < 128; c++)
+        {
+            if (classWeights[k][c] == 0)
+                continue;
+            const uint64_t weight = classWeights[k][c] * scale;
+            if (classWeights[k][c] > s_MaxRange / 128 || weight > s_MaxRange / 128)
+                throw std::invalid_argument("Character weights are too large");
+            ownWeights[c] = (uint32_t)classWeights[k][c];
+            classSizes[k]++;
+            allWeights[c] = (uint32_t)weight;
+            total += weight;
+            if (weight > 0)
+                characters.push_back((char)c);
+        }
+        if (total > s_MaxRange / 128)
+            throw std::invalid_argument("Character weights are too large");
+        perClass[k] = AliasTable<128>(ownWeights);
+    }
+
+    // every position must be fillable: mins fit, and the classes that can draw freely reach the length with their maxes
+    uint64_t minimum = 0, maximum = 0;
+    for (size_t k = 0; k < 4; k++)
+    {
+        minimum += minCounts[k];
+        maximum = maxCounts[k] > UINT64_MAX - maximum ? UINT64_MAX : maximum + maxCounts[k];
+    }
+    if (minimum > policy.passwordLength)
+        throw std::invalid_argument("Character class minCounts add up to more than the password length");
+    if (maximum < policy.passwordLength || (total == 0 && minimum < policy.passwordLength))
+        throw std::invalid_argument("Character class rules can't fill the password length");
+
+    if (total > 0)
+        all = AliasTable<128>(allWeights);
+}
+
+double Generator::WeightedAlphabet::DistinctBits(size_t length) const
+{
+    if (length > s_MaxExactLength)
+        return (double)length * std::log2((double)characters.size());
+
+    // bits[j]: log2 of the passwords of j characters drawn from the classes so far. Adding class k with c characters
+    // multiplies by C(j + c, c) positions for them and classSizes[k]^c fillings.
+    constexpr double none = -std::numeric_limits<double>::infinity();
+    std::vector<double> logFactorial(length + 1, 0.0);
+    for (size_t i = 2; i <= length; i++)
+        logFactorial[i] = logFactorial[i - 1] + std::log2((double)i);
+    const auto addLog = [](double a, double b)
+    {
+        if (a == none)
+            return b;
+        return std::max(a, b) + std::log2(1.0 + std::exp2(-std::fabs(a - b)));
+    };
+
+    std::vector<double> bits(length + 1, none);
+    bits[0] = 0.0;
+    for (size_t k = 0; k < 4; k++)
+    {
+        const uint64_t most = classSizes[k] == 0 ? 0 : std::min<uint64_t>(maxCounts[k], length);
+        std::vector<double> next(length + 1, none);
+        for (size_t j = 0; j <= length; j++)
+        {
+            if (bits[j] == none)
+                continue;
+            for (uint64_t c = minCounts[k]; c <= most && j + c <= length; c++)
+            {
+                const double arrangements = logFactorial[j + c] - logFactorial[j] - logFactorial[c];
+                const double fillings = c == 0 ? 0.0 : (double)c * std::log2((double)classSizes[k]);
+                next[j + c] = addLog(next[j + c], bits[j] + arrangements + fillings);
+            }
+        }
+        bits = std::move(next);
+    }
+    return bits[length] == none ? 0.0 : bits[length];
+}
+
+void Generator::WeightedAlphabet::Fill(char* out, size_t length) const
+{
+    Fill(out, 1, length, length);
+}
+
+void Generator::WeightedAlphabet::Fill(char* out, size_t count, size_t stride, size_t length) const
+{
+    // one word per character and one per shuffle step, plus the odd redraw
+    RandomWords random((uint64_t)count * length * 2);
+    for (size_t r = 0; r < count; r++)
+    {
+        char* record = out + r * stride;
+        std::array<uint64_t, 4> counts{};
+        size_t position = 0;
+
+        // required characters first, each drawn from its own class
+        for (size_t k = 0; k < 4; k++)
+        {
+            for (uint64_t i = 0; i < minCounts[k] && position < length; i++)
+                record[position++] = (char)Draw(perClass[k], random);
+            counts[k] = minCounts[k];
+        }
+
+        // the rest from the combined table; a class at its max is redrawn (validation guarantees another class has room)
+        while (position < length)
+        {
+            const char c = (char)Draw(all, random);
+            const size_t k = (size_t)ClassOf(c);
+            if (counts[k] >= maxCounts[k])
+                continue;
+            counts[k]++;
+            record[position++] = c;
+        }
+
+        // shuffle so the required characters don't sit at the front
+        for (size_t i = length; i > 1; i--)
+            std::swap(record[i - 1], record[random.Uniform((uint32_t)i)]);
+    }
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+#include "AliasTable.h"
+#include "Generator.h"
+
+/// The weighted character distribution of a policy with class rules or character weights. Built (and validated) once
+/// per policy; each character is then one alias table lookup, the same as drawing uniformly. Outcomes are ASCII codes,
+/// so a table needs no separate character mapping.
+class Generator::WeightedAlphabet
+{
+public:
+    /// @throws std::invalid_argument if the rules contradict each other or can't fill policy.passwordLength characters.
+    explicit WeightedAlphabet(const PasswordPolicy& policy);
+
+    /// Writes one password of length characters into out, honouring every class's min and max count.
+    void Fill(char* out, size_t length) const;
+    /// Fill() for count records, record i starting at out + i * stride. Random words are drawn for many characters
+    /// per randombytes call, like CompiledPolicy::FillAdvanced() does for unweighted policies.
+    void Fill(char* out, size_t count, size_t stride, size_t length) const;
+
+    /**
+     * log2 of the number of distinct passwords of the given length Fill() can produce: every mix of class counts within
+     * the min/max rules, times the ways to arrange and fill it. Exact up to s_MaxExactLength, above that the count
+     * without class rules (an upper bound).
+     */
+    [[nodiscard]] double DistinctBits(size_t length) const;
+    static constexpr size_t s_MaxExactLength = 4096;
+
+    /// Characters with a non-zero chance of appearing.
+    [[nodiscard]] const std::string& Characters() const { return characters; }
+
+    /// Which class a character belongs to, or -1 for characters outside all four.
+    [[nodiscard]] static int ClassOf(char c);
+
+private:
+    AliasTable<128> all;
+    /// Used to place each class's minCount characters.
+    std::array<AliasTable<128>, 4> perClass{};
+    std::array<uint64_t, 4> minCounts{};
+    std::array<uint64_t, 4> maxCounts{};
+    /// Characters each class can place.
+    std::array<uint64_t, 4> classSizes{};
+    std::string characters;
+};
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sodium.h>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+/// Length-prefixed little-endian framing shared by the out-of-process frontends (server, coordinator).
+/// A frame is a u32 payload length followed by the payload. Strings are a u32 length followed by raw bytes.
+namespace Generator::Wire
+{
+    /// Frames larger than this are treated as a protocol error rather than allocated.
+    constexpr uint32_t MaxFrameBytes = 16u * 1024u * 1024u;
+    constexpr size_t FrameHeaderBytes = sizeof(uint32_t);
+
+    /// Builds one frame. The length header is reserved up front so the whole frame goes out in a single write.
+    class Writer
+    {
+    public:
+        Writer() { buffer.resize(FrameHeaderBytes); }
+
+        void U8(uint8_t value) { buffer.push_back(value); }
+        void U32(uint32_t value) { Append(&value, sizeof(value)); }
+        void U64(uint64_t value) { Append(&value, sizeof(value)); }
+        void String(std::string_view value)
+        {
+            U32((uint32_t)value.size());
+            Append(value.data(), value.size());
+        }
+
+        /// Patches the length header and returns the complete frame.
+        [[nodiscard]] const std::vector<uint8_t>& Finish()
+        {
+            const uint32_t payloadBytes = (uint32_t)(buffer.size() - FrameHeaderBytes);
+            std::memcpy(buffer.data(), &payloadBytes, sizeof(payloadBytes));
+            return buffer;
+        }
+
+        /// Frames can carry plaintext passwords, so wipe them once they are sent.
+        void Wipe()
+        {
+            sodium_memzero(buffer.data(), buffer.size());
+            buffer.resize(FrameHeaderBytes);
+        }
+
+    private:
+        // the wire format is little-endian, which is every platform this builds on.
+        void Append(const void* data, size_t size)
+        {
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            buffer.insert(buffer.end(), bytes, bytes + size);
+        }
+
+        std::vector<uint8_t> buffer;
+    };
+
+    /// Reads fields back out of a frame payload. Throws std::runtime_error on truncated input.
+    class Reader
+    {
+    public:
+        Reader(const uint8_t* data, size_t size) : data(data), size(size) {}
+        explicit Reader(const std::vector<uint8_t>& payload) : Reader(payload.data(), payload.size()) {}
+
+        uint8_t U8()
+        {
+            Require(1);
+            return data[offset++];
+        }
+        uint32_t U32() { return Read<uint32_t>(); }
+        uint64_t U64() { return Read<uint64_t>(); }
+        std::string String()
+        {
+            const uint32_t length = U32();
+            Require(length);
+            std::string value(reinterpret_cast<const char*>(data + offset), length);
+            offset += length;
+            return value;
+        }
+
+        [[nodiscard]] bool AtEnd() const { return offset == size; }
+
+    private:
+        template<typename T>
+        T Read()
+        {
+            Require(sizeof(T));
+            T value;
+            std::memcpy(&value, data + offset, sizeof(T));
+            offset += sizeof(T);
+            return value;
+        }
+
+        void Require(size_t bytes) const
+        {
+            if (size - offset < bytes)
+                throw std::runtime_error("Truncated frame");
+        }
+
+        const uint8_t* data;
+        size_t size;
+        size_t offset = 0;
+    };
+
+#if !defined(_WIN32)
+    /// Writes all bytes to a file descriptor, retrying on partial writes. Returns false if the peer went away.
+    inline bool WriteAll(int fd, const void* data, size_t size)
+    {
+        const auto* bytes = static_cast<const uint8_t*>(data);
+        while (size > 0)
+        {
+            const ssize_t written = ::write(fd, bytes, size);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            bytes += written;
+            size -= (size_t)written;
+        }
+        return true;
+    }
+
+    /// Reads exactly size bytes. Returns false on EOF or error.
+    inline bool ReadAll(int fd, void* data, size_t size)
+    {
+        auto* bytes = static_cast<uint8_t*>(data);
+        while (size > 0)
+        {
+            const ssize_t received = ::read(fd, bytes, size);
+            if (received < 0 && errno == EINTR)
+                continue;
+            if (received <= 0)
+                return false;
+            bytes += received;
+            size -= (size_t)received;
+        }
+        return true;
+    }
+
+    inline bool WriteFrame(int fd, Writer& frame)
+    {
+        const auto& bytes = frame.Finish();
+        return WriteAll(fd, bytes.data(), bytes.size());
+    }
+
+    /// Reads one frame payload into the given buffer. Returns false on EOF, error or an oversized frame.
+    inline bool ReadFrame(int fd, std::vector<uint8_t>& payload)
+    {
+        uint32_t payloadBytes = 0;
+        if (!ReadAll(fd, &payloadBytes, sizeof(payloadBytes)) || payloadBytes > MaxFrameBytes)
+            return false;
+        payload.resize(payloadBytes);
+        return ReadAll(fd, payload.data(), payloadBytes);
+    }
+#endif
+}
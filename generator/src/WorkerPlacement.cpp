@@ -0,0 +1,255 @@
+#include "WorkerPlacement.h"
+
+#include <atomic>
+#include <cctype>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include "ThreadUtils.h"
+
+namespace
+{
+    std::string ReadFirstLine(const std::filesystem::path& path)
+    {
+        std::ifstream file(path);
+        std::string line;
+        std::getline(file, line);
+        return line;
+    }
+}
+
+std::vector<int> Generator::ParseCpuList(const std::string& list)
+{
+    std::vector<int> cpus;
+    size_t pos = 0;
+    while (pos < list.length())
+    {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos)
+            end = list.length();
+
+        const std::string range = list.substr(pos, end - pos);
+        const size_t dash = range.find('-');
+        try
+        {
+            const int first = std::stoi(range.substr(0, dash));
+            const int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; cpu++)
+                cpus.push_back(cpu);
+        }
+        catch (const std::exception&)
+        {
+            // blank or malformed entries are skipped, sysfs lists end with a newline we may not have stripped
+        }
+        pos = end + 1;
+    }
+    return cpus;
+}
+
+Generator::CpuTopology Generator::CpuTopology::Detect(const std::string& sysRoot)
+{
+    namespace fs = std::filesystem;
+    CpuTopology topology;
+    std::error_code error;
+
+    const fs::path cpuRoot = fs::path(sysRoot) / "devices/system/cpu";
+    const std::vector<int> online = ParseCpuList(ReadFirstLine(cpuRoot / "online"));
+
+    std::map<int, int> nodeOfCpu;
+    const fs::path nodeRoot = fs::path(sysRoot) / "devices/system/node";
+    int nodeCount = 0;
+    for (const auto& entry : fs::directory_iterator(nodeRoot, error))
+    {
+        const std::string name = entry.path().filename().string();
+        if (!name.starts_with("node") || name.length() == 4 || !std::isdigit((unsigned char)name[4]))
+            continue;
+        const int node = std::stoi(name.substr(4));
+        for (int cpu : ParseCpuList(ReadFirstLine(entry.path() / "cpulist")))
+            nodeOfCpu[cpu] = node;
+        nodeCount = std::max(nodeCount, node + 1);
+    }
+
+    for (int cpu : online)
+    {
+        const std::vector<int> siblings = ParseCpuList(
+            ReadFirstLine(cpuRoot / ("cpu" + std::to_string(cpu)) / "topology/thread_siblings_list"));
+        const auto node = nodeOfCpu.find(cpu);
+        topology.cpus.push_back(Cpu{cpu, node == nodeOfCpu.end() ? 0 : node->second, siblings.empty() ? cpu : siblings.front()});
+    }
+
+    if (topology.cpus.empty())
+    {
+        // no sysfs: one node, every CPU its own core
+        const int cpuCount = (int)std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < cpuCount; cpu++)
+            topology.cpus.push_back(Cpu{cpu, 0, cpu});
+        nodeCount = 1;
+    }
+
+    topology.nodeCount = std::max(1, nodeCount);
+    return topology;
+}
+
+unsigned Generator::CpuTopology::PhysicalCores() const
+{
+    return (unsigned)std::ranges::count_if(cpus, [](const Cpu& cpu) { return cpu.id == cpu.coreLeader; });
+}
+
+Generator::WorkerPlacement::WorkerPlacement(CpuTopology topology)
+    :
+    topology(std::move(topology))
+{
+    // per node: core leaders first, then their SMT siblings
+    std::vector<std::vector<CpuTopology::Cpu>> leaders(this->topology.nodeCount);
+    std::vector<std::vector<CpuTopology::Cpu>> siblings(this->topology.nodeCount);
+    for (const CpuTopology::Cpu& cpu : this->topology.cpus)
+    {
+        const int node = std::clamp(cpu.node, 0, this->topology.nodeCount - 1);
+        (cpu.id == cpu.coreLeader ? leaders : siblings)[node].push_back(cpu);
+    }
+
+    // round-robin across nodes, so N workers use N/nodes cores on every node
+    for (auto* tier : { &leaders, &siblings })
+    {
+        for (size_t i = 0; ; i++)
+        {
+            bool added = false;
+            for (const auto& nodeCpus : *tier)
+            {
+                if (i < nodeCpus.size())
+                {
+                    order.push_back(nodeCpus[i]);
+                    added = true;
+                }
+            }
+            if (!added)
+                break;
+        }
+    }
+}
+
+int Generator::WorkerPlacement::CpuForWorker(unsigned worker) const
+{
+    return order.empty() ? -1 : order[worker % order.size()].id;
+}
+
+int Generator::WorkerPlacement::NodeForWorker(unsigned worker) const
+{
+    return order.empty() ? 0 : order[worker % order.size()].node;
+}
+
+bool Generator::WorkerPlacement::PinCurrentThread(unsigned worker) const
+{
+    const int cpu = CpuForWorker(worker);
+    return cpu >= 0 && PinCurrentThreadToCpu(cpu);
+}
+
+std::vector<std::string> Generator::WorkerPlacement::HashPasswordsSafe(const PasswordGenerator& generator,
+                                                                        std::vector<std::string> passwords, unsigned workers) const
+{
+    std::vector<std::string> hashedPasswords(passwords.size());
+    std::atomic<size_t> next = 0;
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    std::vector<std::thread> threads;
+    for (unsigned worker = 0; worker < std::max(1u, workers); worker++)
+    {
+        threads.emplace_back([&, worker]() {
+            PinCurrentThread(worker);
+            for (size_t i = next++; i < passwords.size(); i = next++)
+            {
+                try
+                {
+                    hashedPasswords[i] = generator.HashPasswordSafe(std::move(passwords[i]));
+                }
+                catch (...)
+                {
+                    std::lock_guard lock(errorMutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+    return hashedPasswords;
+}
+
+Generator::WorkerPlacement::Calibration Generator::WorkerPlacement::CalibrateWorkers(const PasswordGenerator& generator,
+                                                                                     unsigned maxWorkers,
+                                                                                     std::chrono::milliseconds perStep) const
+{
+    Calibration calibration;
+    double best = 0.0;
+
+    maxWorkers = std::max(1u, maxWorkers);
+    std::vector<unsigned> steps;
+    for (unsigned workers = 1; workers < maxWorkers; workers *= 2)
+        steps.push_back(workers);
+    steps.push_back(maxWorkers);
+
+    for (const unsigned workers : steps)
+    {
+        std::atomic<bool> stop = false;
+        std::atomic<uint64_t> hashes = 0;
+        std::exception_ptr firstError;
+        std::mutex errorMutex;
+        std::vector<std::thread> threads;
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned worker = 0; worker < workers; worker++)
+        {
+            threads.emplace_back([&, worker]() {
+                try
+                {
+                    PinCurrentThread(worker);
+                    while (!stop)
+                    {
+                        (void)generator.HashPassword("calibration-password");
+                        hashes++;
+                    }
+                }
+                catch (...)
+                {
+                    std::lock_guard lock(errorMutex);
+                    if (!firstError)
+                        firstError = std::current_exception();
+                    stop = true;
+                }
+            });
+        }
+        // wake up early once a worker failed, the step is useless then
+        const auto deadline = start + perStep;
+        while (!stop && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(deadline - std::chrono::steady_clock::now(),
+                                                                                      std::chrono::milliseconds(10)));
+        stop = true;
+        for (auto& thread : threads)
+            thread.join();
+        if (firstError)
+            std::rethrow_exception(firstError);
+
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double rate = (double)hashes / seconds;
+        calibration.samples.emplace_back(workers, rate);
+        best = std::max(best, rate);
+    }
+
+    for (const auto& [workers, rate] : calibration.samples)
+    {
+        if (rate >= best * 0.95)
+        {
+            calibration.recommendedWorkers = workers;
+            break;
+        }
+    }
+    return calibration;
+}
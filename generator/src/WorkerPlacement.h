@@ -0,0 +1,82 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Generator.h"
+
+namespace Generator
+{
+    struct CpuTopology;
+    class WorkerPlacement;
+
+    /// Parses a sysfs CPU list such as "0-3,8,10-11".
+    [[nodiscard]] std::vector<int> ParseCpuList(const std::string& list);
+}
+
+/// NUMA nodes and CPUs as Linux reports them under /sys. Elsewhere (or if /sys can't be read) it describes one node
+/// holding std::thread::hardware_concurrency() CPUs.
+struct Generator::CpuTopology
+{
+    struct Cpu
+    {
+        int id = 0;
+        int node = 0;
+        /// First CPU of this CPU's SMT sibling group. Equal to id for the "main" hardware thread of a core.
+        int coreLeader = 0;
+    };
+
+    std::vector<Cpu> cpus;
+    int nodeCount = 1;
+
+    /// @param sysRoot Root of the sysfs tree, overridable for tests.
+    [[nodiscard]] static CpuTopology Detect(const std::string& sysRoot = "/sys");
+
+    [[nodiscard]] unsigned PhysicalCores() const;
+};
+
+/// Decides which CPU each hashing worker runs on. Argon2 at Medium/High strength is bound by memory bandwidth, so
+/// workers are spread one per physical core, round-robin across NUMA nodes, before any SMT sibling is used.
+/// Pinned workers also get node-local Argon2 memory: libsodium allocates and first touches its scratch memory on the
+/// hashing thread, and Linux places first-touched pages on the node of the CPU that touched them.
+class Generator::WorkerPlacement
+{
+public:
+    explicit WorkerPlacement(CpuTopology topology = CpuTopology::Detect());
+
+    /// CPU worker n should run on, wrapping around when there are more workers than CPUs.
+    [[nodiscard]] int CpuForWorker(unsigned worker) const;
+    [[nodiscard]] int NodeForWorker(unsigned worker) const;
+
+    /// Pins the calling thread to worker n's CPU. Returns false where pinning isn't supported.
+    bool PinCurrentThread(unsigned worker) const;
+
+    [[nodiscard]] const CpuTopology& Topology() const { return topology; }
+
+    /// Hashes passwords on pinned workers. Same result as PasswordGenerator::HashPasswordsSafe(), passwords vector will be erased.
+    [[nodiscard]] std::vector<std::string> HashPasswordsSafe(const PasswordGenerator& generator, std::vector<std::string> passwords,
+                                                             unsigned workers) const;
+
+    struct Calibration
+    {
+        unsigned recommendedWorkers = 1;
+        /// (workers, hashes per second) for every measured worker count.
+        std::vector<std::pair<unsigned, double>> samples;
+    };
+
+    /**
+     * Measures hash throughput with 1, 2, 4, ... up to maxWorkers pinned workers under the generator's policy, and
+     * recommends the smallest worker count within 5% of the best. Past that point extra workers only fight over memory
+     * bandwidth and cache.
+     * @throws The first exception a calibration thread hit, e.g. from hashing, once every thread has stopped.
+     */
+    [[nodiscard]] Calibration CalibrateWorkers(const PasswordGenerator& generator, unsigned maxWorkers,
+                                               std::chrono::milliseconds perStep = std::chrono::milliseconds(1000)) const;
+
+private:
+    CpuTopology topology;
+    /// CPUs in the order workers are placed on them
+    std::vector<CpuTopology::Cpu> order;
+};
@@ -0,0 +1,311 @@
+#include "BulkPanel.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include <HashPipeline.h>
+#include <SQLiteCpp/SQLiteCpp.h>
+
+namespace
+{
+    /// Room for the largest packed hash of any backend (scrypt, 72 bytes) plus a few bytes of larger cost varints.
+    constexpr size_t s_HashSlotBytes = 80;
+    /// Rows inserted per transaction when saving, so a million hashes take a hundred commits instead of a million.
+    constexpr size_t s_SaveBatchRows = 10000;
+    constexpr int s_GaugeRange = 1000;
+    constexpr int s_MaxBatch = 10000000;
+
+    /// Thrown from a job's progress callback to unwind it when the user cancels.
+    struct Cancelled : std::runtime_error
+    {
+        Cancelled() : std::runtime_error("Cancelled") {}
+    };
+}
+
+BulkResultsList::BulkResultsList(wxWindow* parent, const BulkResults& results)
+    :
+    wxListCtrl(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_VIRTUAL | wxLC_HRULES),
+    results(results)
+{
+    AppendColumn("#", wxLIST_FORMAT_RIGHT, 90);
+    AppendColumn("Password", wxLIST_FORMAT_LEFT, 220);
+    AppendColumn("Hash", wxLIST_FORMAT_LEFT, 620);
+}
+
+void BulkResultsList::SetShowPasswords(bool show)
+{
+    showPasswords = show;
+    RefreshVisibleRows();
+}
+
+void BulkResultsList::RefreshVisibleRows()
+{
+    if (GetItemCount() == 0)
+        return;
+    const long top = std::max(0L, GetTopItem());
+    const long bottom = std::min((long)GetItemCount() - 1, top + GetCountPerPage());
+    RefreshItems(top, bottom);
+}
+
+wxString BulkResultsList::OnGetItemText(long item, long column) const
+{
+    const auto row = (size_t)item;
+    if (column == 0)
+        return wxString::Format("%ld", item + 1);
+    if (row >= results.Size() || !results.IsDone(row))
+        return column == 2 ? "hashing..." : "";
+    if (column == 1)
+        return showPasswords ? wxString(results.Password(row)) : wxString(wxUniChar(0x2022), 8);
+    return results.Hash(row);
+}
+
+BulkPanel::BulkPanel(wxWindow* parent, const Generator::PasswordPolicy& policy, std::string databasePath,
+                     const BulkPanelColours& colours)
+    :
+    wxPanel(parent, wxID_ANY),
+    policy(policy),
+    databasePath(std::move(databasePath)),
+    refreshTimer(this)
+{
+    SetBackgroundColour(colours.background);
+    const auto style = [&colours](wxWindow* control)
+    {
+        control->SetBackgroundColour(colours.control);
+        control->SetForegroundColour(colours.text);
+    };
+
+    wxBoxSizer* mainSizer = new wxBoxSizer(wxVERTICAL);
+
+    // --- Row for the batch size and the job buttons ---
+    wxBoxSizer* controlsSizer = new wxBoxSizer(wxHORIZONTAL);
+    wxStaticText* countLabel = new wxStaticText(this, wxID_ANY, "Passwords:");
+    countLabel->SetForegroundColour(colours.text);
+    controlsSizer->Add(countLabel, 0, wxALL | wxALIGN_CENTER, 5);
+
+    countSpin = new wxSpinCtrl(this, wxID_ANY, "10000", wxDefaultPosition, wxSize(130, -1), wxSP_ARROW_KEYS,
+                               1, s_MaxBatch, 10000);
+    style(countSpin);
+    controlsSizer->Add(countSpin, 0, wxALL, 5);
+
+    startButton = new wxButton(this, wxID_ANY, "Generate && Hash");
+    cancelButton = new wxButton(this, wxID_ANY, "Cancel");
+    exportButton = new wxButton(this, wxID_ANY, "Export to File...");
+    saveButton = new wxButton(this, wxID_ANY, "Save Hashes to Database");
+    for (wxButton* button : {startButton, cancelButton, exportButton, saveButton})
+    {
+        style(button);
+        controlsSizer->Add(button, 0, wxALL, 5);
+    }
+
+    showPasswordsCheck = new wxCheckBox(this, wxID_ANY, "Show passwords");
+    showPasswordsCheck->SetForegroundColour(colours.text);
+    controlsSizer->Add(showPasswordsCheck, 0, wxALL | wxALIGN_CENTER, 5);
+    mainSizer->Add(controlsSizer, 0, wxALIGN_CENTER);
+
+    // --- Row for progress ---
+    wxBoxSizer* progressSizer = new wxBoxSizer(wxHORIZONTAL);
+    progressGauge = new wxGauge(this, wxID_ANY, s_GaugeRange, wxDefaultPosition, wxSize(350, 15));
+    progressSizer->Add(progressGauge, 0, wxALL | wxALIGN_CENTER, 5);
+    statusText = new wxStaticText(this, wxID_ANY, wxEmptyString);
+    statusText->SetForegroundColour(colours.text);
+    progressSizer->Add(statusText, 1, wxALL | wxALIGN_CENTER, 5);
+    mainSizer->Add(progressSizer, 0, wxEXPAND);
+
+    list = new BulkResultsList(this, results);
+    style(list);
+    mainSizer->Add(list, 1, wxEXPAND | wxALL, 5);
+
+    SetSizer(mainSizer);
+
+    startButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { OnStart(); });
+    cancelButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { cancelRequested = true; });
+    exportButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { OnExport(); });
+    saveButton->Bind(wxEVT_BUTTON, [this](wxCommandEvent&) { OnSave(); });
+    showPasswordsCheck->Bind(wxEVT_CHECKBOX, [this](wxCommandEvent& event) { list->SetShowPasswords(event.IsChecked()); });
+    Bind(wxEVT_TIMER, [this](wxTimerEvent&) { OnRefreshTimer(); });
+
+    UpdateButtons();
+}
+
+BulkPanel::~BulkPanel()
+{
+    refreshTimer.Stop();
+    cancelRequested = true;
+    if (worker.joinable())
+        worker.join();
+}
+
+void BulkPanel::OnStart()
+{
+    if (busy)
+        return;
+
+    const auto count = (size_t)countSpin->GetValue();
+    // the old rows are dropped on the UI thread, before anything can paint them again
+    list->SetItemCount(0);
+    try
+    {
+        results.Reset(count, policy.passwordLength, s_HashSlotBytes);
+    }
+    catch (const std::exception& ex)
+    {
+        wxLogError("Failed to allocate the results: %s", ex.what());
+        return;
+    }
+    list->SetItemCount((long)count);
+
+    const Generator::PasswordPolicy snapshot = policy;
+    RunInBackground("Hashing", count, [this, count, snapshot]()
+    {
+        const Generator::PasswordGenerator generator(snapshot);
+        Generator::HashPipeline(generator).Run(count, [this](size_t index, const std::string& password, const std::string& hash)
+        {
+            // throwing stops the pipeline; rows that are done stay usable
+            if (cancelRequested)
+                throw Cancelled();
+            results.Set(index, password, hash);
+            progressDone.fetch_add(1, std::memory_order_relaxed);
+        });
+    });
+}
+
+void BulkPanel::OnExport()
+{
+    if (busy)
+        return;
+
+    wxFileDialog dialog(this, "Export results", wxEmptyString, "passwords.txt", "Text files (*.txt)|*.txt|All files|*",
+                        wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (dialog.ShowModal() != wxID_OK)
+        return;
+    const bool includePasswords = wxMessageBox("Include the plaintext passwords next to their hashes?", "Export",
+                                               wxYES_NO | wxNO_DEFAULT | wxICON_QUESTION, this) == wxYES;
+    const std::string path = dialog.GetPath().ToStdString();
+
+    RunInBackground("Exporting", results.Completed(), [this, path, includePasswords]()
+    {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("Failed to open " + path);
+        results.Export(file, includePasswords, [this](size_t rows)
+        {
+            if (cancelRequested)
+                throw Cancelled();
+            progressDone = rows;
+        });
+        file.flush();
+        if (!file)
+            throw std::runtime_error("Failed to write " + path);
+    });
+}
+
+void BulkPanel::OnSave()
+{
+    if (busy)
+        return;
+
+    RunInBackground("Saving", results.Size(), [this]()
+    {
+        // a connection of its own: the main window keeps using its connection while this one writes
+        SQLite::Database db(databasePath, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, 5000);
+        db.exec("CREATE TABLE IF NOT EXISTS passwords (hash BLOB)");
+        SQLite::Statement insertQuery(db, "INSERT INTO passwords (hash) VALUES (?)");
+
+        for (size_t first = 0; first < results.Size(); first += s_SaveBatchRows)
+        {
+            if (cancelRequested)
+                throw Cancelled();
+
+            // batches that committed before a cancel or an error stay saved
+            const size_t last = std::min(results.Size(), first + s_SaveBatchRows);
+            SQLite::Transaction transaction(db);
+            for (size_t i = first; i < last; i++)
+            {
+                if (!results.IsDone(i))
+                    continue;
+                size_t size = 0;
+                const uint8_t* packed = results.PackedHashBytes(i, size);
+                insertQuery.bind(1, packed, (int)size);
+                insertQuery.exec();
+                insertQuery.reset();
+            }
+            transaction.commit();
+            progressDone = last;
+        }
+    });
+}
+
+void BulkPanel::RunInBackground(const wxString& newActivity, size_t total, std::function<void()> work)
+{
+    // a finished job's thread is only joined here or in OnBackgroundFinished(), never while it runs
+    if (worker.joinable())
+        worker.join();
+
+    activity = newActivity;
+    busy = true;
+    cancelRequested = false;
+    progressDone = 0;
+    progressTotal = total;
+    progressGauge->SetValue(0);
+    statusText->SetLabel(activity + "...");
+    UpdateButtons();
+    refreshTimer.Start(200);
+
+    worker = std::thread([this, work = std::move(work)]()
+    {
+        wxString error;
+        try
+        {
+            work();
+        }
+        catch (const Cancelled&)
+        {
+        }
+        catch (const std::exception& ex)
+        {
+            error = ex.what();
+        }
+        // runs on the UI thread; pending calls are dropped if the panel is destroyed first
+        CallAfter([this, error]() { OnBackgroundFinished(error); });
+    });
+}
+
+void BulkPanel::OnBackgroundFinished(const wxString& error)
+{
+    if (worker.joinable())
+        worker.join();
+    refreshTimer.Stop();
+    busy = false;
+
+    OnRefreshTimer();
+    if (!error.empty())
+    {
+        statusText->SetLabel(activity + " failed: " + error);
+        wxLogError("%s failed: %s", activity, error);
+    }
+    else
+        statusText->SetLabel(wxString::Format("%s %s, %zu of %zu rows hashed", activity,
+                                              cancelRequested ? "cancelled" : "done", results.Completed(), results.Size()));
+    UpdateButtons();
+}
+
+void BulkPanel::OnRefreshTimer()
+{
+    const size_t done = progressDone.load(std::memory_order_relaxed);
+    progressGauge->SetValue(progressTotal ? (int)(done * s_GaugeRange / progressTotal) : 0);
+    if (busy)
+        statusText->SetLabel(wxString::Format("%s... %zu / %zu", activity, done, progressTotal));
+    // only what's on screen is repainted, the list never touches the other rows
+    list->RefreshVisibleRows();
+}
+
+void BulkPanel::UpdateButtons()
+{
+    const bool haveResults = results.Completed() > 0;
+    countSpin->Enable(!busy);
+    startButton->Enable(!busy);
+    cancelButton->Enable(busy);
+    exportButton->Enable(!busy && haveResults);
+    saveButton->Enable(!busy && haveResults);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include <wx/wx.h>
+#include <wx/listctrl.h>
+#include <wx/spinctrl.h>
+
+#include <Generator.h>
+
+#include "BulkResults.h"
+
+struct BulkPanelColours
+{
+    wxColour background;
+    wxColour control;
+    wxColour text;
+};
+
+/// A virtual report list over BulkResults. wx asks for the text of the rows on screen only, so the list costs the
+/// same with ten rows as with a million.
+class BulkResultsList : public wxListCtrl
+{
+public:
+    BulkResultsList(wxWindow* parent, const BulkResults& results);
+
+    void SetShowPasswords(bool show);
+    /// Repaints the rows that are on screen, e.g. after more of them were hashed.
+    void RefreshVisibleRows();
+
+protected:
+    wxString OnGetItemText(long item, long column) const override;
+
+private:
+    const BulkResults& results;
+    bool showPasswords = false;
+};
+
+/// Generates and hashes a batch of passwords on background threads (a HashPipeline), shows them as they finish and
+/// exports them to a file or saves the hashes to the database. The UI thread only polls a progress counter on a
+/// timer and repaints the visible rows, so it stays responsive however big the batch is.
+class BulkPanel : public wxPanel
+{
+public:
+    /**
+     * @param policy The main window's policy. A copy is taken when a batch starts.
+     * @param databasePath Hashes are saved to its passwords table over a connection of their own.
+     */
+    BulkPanel(wxWindow* parent, const Generator::PasswordPolicy& policy, std::string databasePath,
+              const BulkPanelColours& colours);
+    /// Cancels a running job and waits for it.
+    ~BulkPanel() override;
+
+private:
+    void OnStart();
+    void OnExport();
+    void OnSave();
+    /// Runs work on a background thread with the buttons disabled. work reports through progressDone.
+    void RunInBackground(const wxString& activity, size_t total, std::function<void()> work);
+    void OnBackgroundFinished(const wxString& error);
+    void OnRefreshTimer();
+    void UpdateButtons();
+
+    const Generator::PasswordPolicy& policy;
+    const std::string databasePath;
+
+    BulkResults results;
+
+    wxSpinCtrl* countSpin = nullptr;
+    wxButton* startButton = nullptr;
+    wxButton* cancelButton = nullptr;
+    wxButton* exportButton = nullptr;
+    wxButton* saveButton = nullptr;
+    wxCheckBox* showPasswordsCheck = nullptr;
+    wxGauge* progressGauge = nullptr;
+    wxStaticText* statusText = nullptr;
+    BulkResultsList* list = nullptr;
+    wxTimer refreshTimer;
+
+    std::thread worker;
+    wxString activity;
+    bool busy = false;
+    std::atomic<bool> cancelRequested = false;
+    std::atomic<size_t> progressDone = 0;
+    size_t progressTotal = 0;
+};
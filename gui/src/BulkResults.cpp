@@ -0,0 +1,88 @@
+#include "BulkResults.h"
+
+#include <cstring>
+#include <stdexcept>
+
+#include <sodium.h>
+
+#include <PackedHash.h>
+
+BulkResults::~BulkResults()
+{
+    Wipe();
+}
+
+void BulkResults::Wipe()
+{
+    if (!passwords.empty())
+        sodium_memzero(passwords.data(), passwords.size());
+}
+
+void BulkResults::Reset(size_t count, size_t passwordLength, size_t hashSlotBytes)
+{
+    if (hashSlotBytes == 0 || hashSlotBytes > 255)
+        throw std::invalid_argument("Hash slots must hold between 1 and 255 bytes");
+
+    Wipe();
+    // release the old rows before allocating the new ones, a million of each doesn't need to exist twice
+    passwords = {};
+    hashes = {};
+    hashLengths.reset();
+
+    this->count = count;
+    this->passwordLength = passwordLength;
+    this->hashSlotBytes = hashSlotBytes;
+    passwords.resize(count * passwordLength);
+    hashes.resize(count * hashSlotBytes);
+    hashLengths = std::make_unique<std::atomic<uint8_t>[]>(count);
+    completed = 0;
+}
+
+void BulkResults::Set(size_t index, const std::string& password, const std::string& hash)
+{
+    if (index >= count || password.length() != passwordLength)
+        throw std::invalid_argument("Row doesn't fit the bulk results");
+    const std::vector<uint8_t> packed = Generator::PackedHash::FromString(hash).ToBytes();
+    if (packed.size() > hashSlotBytes)
+        throw std::invalid_argument("Packed hash doesn't fit its slot");
+
+    std::memcpy(passwords.data() + index * passwordLength, password.data(), passwordLength);
+    std::memcpy(hashes.data() + index * hashSlotBytes, packed.data(), packed.size());
+    hashLengths[index].store((uint8_t)packed.size(), std::memory_order_release);
+    completed.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::string BulkResults::Password(size_t index) const
+{
+    return std::string(passwords.data() + index * passwordLength, passwordLength);
+}
+
+std::string BulkResults::Hash(size_t index) const
+{
+    size_t size = 0;
+    const uint8_t* packed = PackedHashBytes(index, size);
+    return Generator::PackedHash::FromBytes(packed, size).ToString();
+}
+
+const uint8_t* BulkResults::PackedHashBytes(size_t index, size_t& size) const
+{
+    size = hashLengths[index].load(std::memory_order_acquire);
+    return hashes.data() + index * hashSlotBytes;
+}
+
+void BulkResults::Export(std::ostream& out, bool includePasswords, const std::function<void(size_t rows)>& onProgress) const
+{
+    size_t written = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (!IsDone(i))
+            continue;
+        if (includePasswords)
+            out.write(passwords.data() + i * passwordLength, (std::streamsize)passwordLength) << '\t';
+        out << Hash(i) << '\n';
+        if (++written % 10000 == 0 && onProgress)
+            onProgress(written);
+    }
+    if (onProgress)
+        onProgress(written);
+}
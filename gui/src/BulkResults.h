@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/// Backing store for the bulk panel's list: a million rows of (password, hash) without a million string pairs.
+/// Passwords (all the policy's length) sit back to back in one buffer and hashes as PackedHash bytes in fixed-size
+/// slots, under 100 bytes per row for a 16 character password instead of two strings and their heap blocks.
+/// Rows are filled concurrently by the hasher threads and read by the UI thread while that happens: a row's
+/// length byte is published last, so a reader either sees a finished row or none.
+class BulkResults
+{
+public:
+    BulkResults() = default;
+    ~BulkResults();
+    BulkResults(const BulkResults&) = delete;
+    BulkResults& operator=(const BulkResults&) = delete;
+
+    /**
+     * Wipes the old rows and makes room for count new ones.
+     * @param hashSlotBytes Room for one packed hash, at most 255. Every hash of the same policy packs to the same size.
+     */
+    void Reset(size_t count, size_t passwordLength, size_t hashSlotBytes);
+
+    /// Fills row index. Thread-safe as long as every row is set by one thread only.
+    /// @throws std::invalid_argument if the password or packed hash doesn't fit the row.
+    void Set(size_t index, const std::string& password, const std::string& hash);
+
+    [[nodiscard]] size_t Size() const { return count; }
+    [[nodiscard]] size_t Completed() const { return completed.load(std::memory_order_relaxed); }
+    [[nodiscard]] bool IsDone(size_t index) const { return hashLengths[index].load(std::memory_order_acquire) != 0; }
+
+    /// Only valid for rows that are done.
+    [[nodiscard]] std::string Password(size_t index) const;
+    /// The encoded hash string. Only valid for rows that are done.
+    [[nodiscard]] std::string Hash(size_t index) const;
+    /// The packed hash, as stored in the database. Only valid for rows that are done.
+    [[nodiscard]] const uint8_t* PackedHashBytes(size_t index, size_t& size) const;
+
+    /// Writes one finished row per line: the hash, or "password<TAB>hash".
+    /// @param onProgress Called every 10000 rows with the number written so far.
+    void Export(std::ostream& out, bool includePasswords, const std::function<void(size_t rows)>& onProgress = {}) const;
+
+private:
+    void Wipe();
+
+    size_t count = 0;
+    size_t passwordLength = 0;
+    size_t hashSlotBytes = 0;
+    std::vector<char> passwords;
+    std::vector<uint8_t> hashes;
+    /// 0 while the row isn't done.
+    std::unique_ptr<std::atomic<uint8_t>[]> hashLengths;
+    std::atomic<size_t> completed = 0;
+};
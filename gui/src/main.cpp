@@ -1,11 +1,15 @@
 #include <wx/wx.h>
 
 #include <Generator.h>
+#include <PackedHash.h>
 #include <filesystem>
 #include <wx/clipbrd.h>
+#include <wx/notebook.h>
 
 #include <SQLiteCpp/SQLiteCpp.h>
 
+#include "BulkPanel.h"
+
 enum
 {
     ID_CB_LOWERCASE,
@@ -24,7 +28,8 @@ public:
         :
         wxFrame(nullptr, wxID_ANY, "Password Generator GUI", wxDefaultPosition, wxSize(1000, 600)),
         passwordGenerator(policy),
-        db("PasswordGenDB.db", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE)
+        // the bulk panel saves through a connection of its own, so wait out its transactions instead of failing
+        db("PasswordGenDB.db", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, 5000)
     {
         if (sodium_init() < 0)
         {
@@ -33,7 +38,8 @@ public:
         }
 
         // setup database
-        db.exec("CREATE TABLE IF NOT EXISTS passwords (hash TEXT)");
+        // hashes are stored packed (see PackedHash.h); older databases declared the column TEXT, which takes BLOBs too
+        db.exec("CREATE TABLE IF NOT EXISTS passwords (hash BLOB)");
 
         // app icon shenanigans
         {
@@ -68,8 +74,12 @@ public:
         wxWindowBase::SetBackgroundColour(darkBg);
 
 
+        // single passwords on the first tab, batches on the second
+        wxNotebook* notebook = new wxNotebook(this, wxID_ANY);
+        notebook->SetBackgroundColour(darkBg);
+
         // Create a panel to hold the controls.
-        wxPanel* panel = new wxPanel(this, wxID_ANY);
+        wxPanel* panel = new wxPanel(notebook, wxID_ANY);
         panel->SetBackgroundColour(darkBg);
 
         // Create a vertical box sizer for overall layout.
@@ -185,6 +195,9 @@ public:
         // Set the main sizer for the panel.
         panel->SetSizer(mainSizer);
 
+        notebook->AddPage(panel, "Single");
+        notebook->AddPage(new BulkPanel(notebook, policy, "PasswordGenDB.db", {darkBg, darkControlBg, lightText}), "Bulk");
+
 
         // bind slider
         passwordLenSlider->Bind(wxEVT_SCROLL_THUMBTRACK, [&](wxScrollEvent& event)
@@ -314,7 +327,8 @@ public:
             {
                 SQLite::Statement insertQuery(db, "INSERT INTO passwords (hash) VALUES (?)");
 
-                insertQuery.bind(1, (std::string)hashText->GetValue());
+                const std::vector<uint8_t> packed = Generator::PackedHash::FromString((std::string)hashText->GetValue()).ToBytes();
+                insertQuery.bind(1, packed.data(), (int)packed.size());
                 insertQuery.exec();
                 insertQuery.reset();
 
@@ -322,7 +336,11 @@ public:
                 SQLite::Statement selectQuery(db, "SELECT * FROM passwords");
                 while (selectQuery.executeStep())
                 {
-                    std::cout << selectQuery.getColumn(0) << std::endl;
+                    const SQLite::Column hash = selectQuery.getColumn(0);
+                    if (hash.isBlob())
+                        std::cout << Generator::PackedHash::FromBytes((const uint8_t*)hash.getBlob(), (size_t)hash.getBytes()).ToString() << std::endl;
+                    else
+                        std::cout << hash << std::endl;
                 }
                 selectQuery.reset();
             }
@@ -0,0 +1,358 @@
+#include "Daemon.h"
+
+#include <cerrno>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using Protocol::Opcode;
+using Protocol::Status;
+namespace Wire = Generator::Wire;
+
+Daemon::Connection::~Connection()
+{
+    ::close(fd);
+}
+
+Daemon::Daemon(DaemonOptions options)
+    :
+    options(std::move(options)),
+    generator(this->options.policy),
+    budget(this->options.memoryBudgetBytes)
+{
+}
+
+Daemon::~Daemon()
+{
+    Shutdown();
+}
+
+void Daemon::Run(const std::atomic<bool>& stopRequested)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (options.socketPath.length() >= sizeof(address.sun_path))
+        throw std::invalid_argument("Socket path is too long");
+    std::copy(options.socketPath.begin(), options.socketPath.end(), address.sun_path);
+
+    RemoveStaleSocket(address);
+
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        throw std::runtime_error("Failed to create socket");
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 || ::listen(fd, SOMAXCONN) < 0)
+    {
+        // listenFd stays unset, so Shutdown() doesn't unlink a socket file this daemon never bound
+        ::close(fd);
+        throw std::runtime_error("Failed to bind " + options.socketPath);
+    }
+    listenFd = fd;
+
+    for (unsigned i = 0; i < options.workers; i++)
+        workers.emplace_back(&Daemon::WorkerLoop, this);
+
+    std::cout << "Listening on " << options.socketPath << " with " << options.workers << " workers" << std::endl;
+
+    while (!stopRequested)
+    {
+        // poll with a timeout so a stop request is noticed without needing another connection
+        pollfd listener{listenFd, POLLIN, 0};
+        if (::poll(&listener, 1, 250) <= 0)
+            continue;
+
+        const int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0)
+            continue;
+
+        auto connection = std::make_shared<Connection>(fd);
+        {
+            std::lock_guard lock(connectionsMutex);
+            std::erase_if(connections, [](const std::weak_ptr<Connection>& c) { return c.expired(); });
+            connections.push_back(connection);
+            activeConnections++;
+        }
+
+        std::thread([this, connection]() {
+            ServeConnection(connection);
+            {
+                std::lock_guard lock(connectionsMutex);
+                activeConnections--;
+            }
+            connectionClosed.notify_all();
+        }).detach();
+    }
+
+    Shutdown();
+}
+
+void Daemon::RemoveStaleSocket(const sockaddr_un& address)
+{
+    const int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe < 0)
+        throw std::runtime_error("Failed to create socket");
+    const int result = ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+    const int error = errno;
+    ::close(probe);
+
+    if (result == 0)
+        throw std::runtime_error("Another daemon is already listening on " + options.socketPath);
+    // nobody accepts on the file: a previous run crashed without cleaning up. Anything else is left for bind() to report
+    if (error == ECONNREFUSED)
+        ::unlink(options.socketPath.c_str());
+}
+
+void Daemon::ServeConnection(const std::shared_ptr<Connection>& connection)
+{
+    std::vector<uint8_t> payload;
+    while (Wire::ReadFrame(connection->fd, payload))
+    {
+        Job job;
+        job.connection = connection;
+        try
+        {
+            Wire::Reader reader(payload);
+            job.opcode = static_cast<Opcode>(reader.U8());
+            job.requestId = reader.U64();
+
+            switch (job.opcode)
+            {
+                case Opcode::Generate:
+                    job.count = reader.U32();
+                    if (job.count == 0 || job.count > Protocol::MaxGenerateCount)
+                        throw std::invalid_argument("Invalid password count");
+                    break;
+                case Opcode::Hash:
+                    job.password = reader.String();
+                    job.memoryBytes = options.policy.GetHashCost().memLimit;
+                    break;
+                case Opcode::Verify:
+                    job.password = reader.String();
+                    job.hash = reader.String();
+                    job.memoryBytes = Generator::MemoryCostOfHash(job.hash);
+                    break;
+                default:
+                    throw std::invalid_argument("Unknown opcode");
+            }
+        }
+        catch (const std::exception& ex)
+        {
+            sodium_memzero(payload.data(), payload.size());
+            Reject(job, Status::Error, ex.what());
+            continue;
+        }
+
+        // the payload held a plaintext password, which now only lives in the job
+        sodium_memzero(payload.data(), payload.size());
+        Submit(std::move(job));
+    }
+}
+
+void Daemon::Submit(Job job)
+{
+    // Admission control: refuse work up front rather than letting latency grow without bound.
+    if (job.memoryBytes > budget.Capacity())
+    {
+        Reject(job, Status::Error, "Request needs more memory than the server's budget");
+        return;
+    }
+
+    {
+        std::unique_lock lock(queueMutex);
+        if (queue.size() >= options.maxQueueDepth)
+        {
+            lock.unlock();
+            Reject(job, Status::Busy, "Server is overloaded");
+            return;
+        }
+        queue.push_back(std::move(job));
+    }
+    queueChanged.notify_one();
+}
+
+void Daemon::WorkerLoop()
+{
+    while (true)
+    {
+        std::vector<Job> batch = NextBatch();
+        if (batch.empty())
+            return;
+        ExecuteBatch(batch);
+    }
+}
+
+std::vector<Daemon::Job> Daemon::NextBatch()
+{
+    const auto isGenerate = [](const Job& job) { return job.opcode == Opcode::Generate; };
+    const auto queuedGenerates = [&]() { return (size_t)std::count_if(queue.begin(), queue.end(), isGenerate); };
+
+    std::unique_lock lock(queueMutex);
+    std::vector<Job> batch;
+    while (batch.empty())
+    {
+        queueChanged.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (queue.empty())
+            return {};
+
+        if (!isGenerate(queue.front()))
+        {
+            // one Argon2 call per worker: batching them would run them serially while the other workers idle
+            batch.push_back(std::move(queue.front()));
+            queue.pop_front();
+            break;
+        }
+
+        // give concurrent Generate requests a short window to coalesce into the same batch
+        if (!stopping && queuedGenerates() < options.maxBatchSize)
+            queueChanged.wait_for(lock, options.batchWindow, [&]() { return stopping || queuedGenerates() >= options.maxBatchSize; });
+
+        // another worker may have taken them during the window, then this one goes back to waiting
+        size_t generateCount = 0;
+        for (auto it = queue.begin(); it != queue.end() && batch.size() < options.maxBatchSize;)
+        {
+            // the total stays within one maximal request, so it can't overflow and one call stays bounded
+            if (!isGenerate(*it) || (!batch.empty() && generateCount + it->count > Protocol::MaxGenerateCount))
+            {
+                ++it;
+                continue;
+            }
+            generateCount += it->count;
+            batch.push_back(std::move(*it));
+            it = queue.erase(it);
+        }
+    }
+
+    const bool moreQueued = !queue.empty();
+    lock.unlock();
+    if (moreQueued)
+        queueChanged.notify_one();
+
+    return batch;
+}
+
+void Daemon::ExecuteBatch(std::vector<Job>& batch)
+{
+    if (batch.front().opcode == Opcode::Generate)
+    {
+        ExecuteGenerate(batch);
+        return;
+    }
+
+    Job& job = batch.front();
+    Wire::Writer frame;
+    try
+    {
+        auto reservation = budget.Acquire(job.memoryBytes);
+        if (job.opcode == Opcode::Hash)
+        {
+            const std::string hash = generator.HashPasswordSafe(std::move(job.password));
+            frame.U8((uint8_t)Status::Ok);
+            frame.U64(job.requestId);
+            frame.String(hash);
+        }
+        else
+        {
+            const bool matches = generator.VerifyPasswordSafe(std::move(job.password), job.hash);
+            frame.U8((uint8_t)Status::Ok);
+            frame.U64(job.requestId);
+            frame.U8(matches ? 1 : 0);
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        frame.Wipe();
+        frame.U8((uint8_t)Status::Error);
+        frame.U64(job.requestId);
+        frame.String(ex.what());
+    }
+    Respond(job, frame);
+}
+
+void Daemon::ExecuteGenerate(std::vector<Job>& batch)
+{
+    // every Generate request in the batch is served from a single generator call
+    size_t generateCount = 0;
+    for (const Job& job : batch)
+        generateCount += job.count;
+
+    std::vector<std::string> generated;
+    try
+    {
+        generated = generator.GenerateAdvancedPasswords((int)generateCount);
+    }
+    catch (const std::exception& ex)
+    {
+        for (const Job& job : batch)
+            Reject(job, Status::Error, ex.what());
+        return;
+    }
+
+    // each response goes out as soon as it's framed, not after the whole batch
+    Wire::Writer frame;
+    size_t nextGenerated = 0;
+    for (const Job& job : batch)
+    {
+        frame.U8((uint8_t)Status::Ok);
+        frame.U64(job.requestId);
+        frame.U32(job.count);
+        for (uint32_t i = 0; i < job.count; i++, nextGenerated++)
+        {
+            frame.String(generated[nextGenerated]);
+            sodium_memzero(generated[nextGenerated].data(), generated[nextGenerated].length());
+        }
+        Respond(job, frame);
+    }
+}
+
+void Daemon::Respond(const Job& job, Wire::Writer& frame)
+{
+    {
+        std::lock_guard lock(job.connection->writeMutex);
+        Wire::WriteFrame(job.connection->fd, frame);
+    }
+    // the frame may hold plaintext passwords
+    frame.Wipe();
+}
+
+void Daemon::Reject(const Job& job, Status status, const std::string& message)
+{
+    Wire::Writer frame;
+    frame.U8((uint8_t)status);
+    frame.U64(job.requestId);
+    frame.String(message);
+
+    std::lock_guard lock(job.connection->writeMutex);
+    Wire::WriteFrame(job.connection->fd, frame);
+}
+
+void Daemon::Shutdown()
+{
+    if (listenFd < 0)
+        return;
+
+    ::close(listenFd);
+    listenFd = -1;
+    ::unlink(options.socketPath.c_str());
+
+    // stop reading new requests, but leave the write side open so queued work still gets its responses
+    {
+        std::unique_lock lock(connectionsMutex);
+        for (const auto& weakConnection : connections)
+        {
+            if (auto connection = weakConnection.lock())
+                ::shutdown(connection->fd, SHUT_RD);
+        }
+        connectionClosed.wait(lock, [this]() { return activeConnections == 0; });
+    }
+
+    {
+        std::lock_guard lock(queueMutex);
+        stopping = true;
+    }
+    queueChanged.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+    workers.clear();
+}
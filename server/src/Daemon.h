@@ -0,0 +1,104 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/un.h>
+
+#include <Generator.h>
+#include <MemoryBudget.h>
+
+#include "Protocol.h"
+
+struct DaemonOptions
+{
+    std::string socketPath = Protocol::DefaultSocketPath;
+    unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+    /// Total Argon2 memory all in-flight hashes and verifications may use at once.
+    size_t memoryBudgetBytes = 1024ull * 1024 * 1024;
+    /// Requests beyond this many queued ones are answered with Status::Busy instead of piling up.
+    size_t maxQueueDepth = 4096;
+    /// A worker serves up to this many queued Generate requests from one generator call...
+    size_t maxBatchSize = 32;
+    /// ...and waits at most this long for a partial batch to fill up. Hash and Verify requests aren't batched: each one
+    /// goes to its own worker, so Argon2 calls run in parallel.
+    std::chrono::microseconds batchWindow{200};
+    Generator::PasswordPolicy policy;
+};
+
+/// Serves generate/hash/verify for local processes over a Unix domain socket. Every client shares one worker pool
+/// and one Argon2 memory budget, instead of each service sizing its own.
+class Daemon
+{
+public:
+    explicit Daemon(DaemonOptions options);
+    ~Daemon();
+    Daemon(const Daemon&) = delete;
+    Daemon& operator=(const Daemon&) = delete;
+
+    /// Binds the socket and serves until stopRequested becomes true.
+    void Run(const std::atomic<bool>& stopRequested);
+
+private:
+    struct Connection
+    {
+        explicit Connection(int fd) : fd(fd) {}
+        ~Connection();
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        int fd;
+        std::mutex writeMutex;
+    };
+
+    struct Job
+    {
+        std::shared_ptr<Connection> connection;
+        Protocol::Opcode opcode = Protocol::Opcode::Generate;
+        uint64_t requestId = 0;
+        uint32_t count = 0;
+        std::string password;
+        std::string hash;
+        size_t memoryBytes = 0;
+    };
+
+    void ServeConnection(const std::shared_ptr<Connection>& connection);
+    void Submit(Job job);
+    void WorkerLoop();
+    /// The next Hash or Verify job on its own, or a batch of Generate jobs. Empty once the daemon stops.
+    [[nodiscard]] std::vector<Job> NextBatch();
+    void ExecuteBatch(std::vector<Job>& batch);
+    void ExecuteGenerate(std::vector<Job>& batch);
+    void Respond(const Job& job, Generator::Wire::Writer& frame);
+    void Reject(const Job& job, Protocol::Status status, const std::string& message);
+    /// Removes a socket file left behind by a daemon that is gone. Throws if another daemon is still listening on it.
+    void RemoveStaleSocket(const sockaddr_un& address);
+    void Shutdown();
+
+    DaemonOptions options;
+    Generator::PasswordGenerator generator;
+    Generator::MemoryBudget budget;
+
+    std::deque<Job> queue;
+    std::mutex queueMutex;
+    std::condition_variable queueChanged;
+    bool stopping = false;
+
+    int listenFd = -1;
+    std::vector<std::thread> workers;
+
+    // connection threads are detached, so track them well enough to shut them down and wait for them.
+    std::vector<std::weak_ptr<Connection>> connections;
+    size_t activeConnections = 0;
+    std::mutex connectionsMutex;
+    std::condition_variable connectionClosed;
+};
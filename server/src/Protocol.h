@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+#include <WireFormat.h>
+
+/// The daemon's request/response protocol, layered on Generator::Wire frames.
+///
+/// request:  u8 opcode, u64 requestId, body
+///     Generate: u32 count
+///     Hash:     string password
+///     Verify:   string password, string hash
+/// response: u8 status, u64 requestId, body
+///     Ok + Generate: u32 count, count * string password
+///     Ok + Hash:     string hash
+///     Ok + Verify:   u8 matches
+///     Busy / Error:  string message
+///
+/// A connection may pipeline requests. Responses can come back out of order, so clients match them on requestId.
+namespace Protocol
+{
+    constexpr const char* DefaultSocketPath = "/tmp/passwordgen.sock";
+
+    /// Upper bound for a single Generate request, keeps one client from monopolising a batch.
+    constexpr uint32_t MaxGenerateCount = 4096;
+
+    enum class Opcode : uint8_t
+    {
+        Generate = 1,
+        Hash = 2,
+        Verify = 3
+    };
+
+    enum class Status : uint8_t
+    {
+        Ok = 0,
+        Busy = 1,   // rejected by admission control, retry later
+        Error = 2
+    };
+}
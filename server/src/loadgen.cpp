@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "Protocol.h"
+
+// Closed-loop load generator for the server: each client keeps one request in flight and records its latency.
+
+using Protocol::Opcode;
+using Protocol::Status;
+using Clock = std::chrono::steady_clock;
+namespace Wire = Generator::Wire;
+
+namespace
+{
+    struct LoadOptions
+    {
+        std::string socketPath = Protocol::DefaultSocketPath;
+        int clients = 8;
+        int requestsPerClient = 200;
+        std::string operation = "verify";
+        uint32_t generateCount = 16;
+    };
+
+    struct ClientResult
+    {
+        std::vector<double> latenciesUs;
+        size_t busy = 0;
+        size_t errors = 0;
+    };
+
+    int Connect(const std::string& socketPath)
+    {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        if (socketPath.length() >= sizeof(address.sun_path))
+            return -1;
+        std::copy(socketPath.begin(), socketPath.end(), address.sun_path);
+
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    /// Sends one request and waits for its response. Returns the response status, or Error on a broken connection.
+    Status RoundTrip(int fd, Wire::Writer& request, std::vector<uint8_t>& response)
+    {
+        if (!Wire::WriteFrame(fd, request) || !Wire::ReadFrame(fd, response))
+            return Status::Error;
+        Wire::Reader reader(response);
+        return static_cast<Status>(reader.U8());
+    }
+
+    void BuildRequest(Wire::Writer& request, const LoadOptions& options, const std::string& operation, uint64_t requestId,
+                      const std::string& hash)
+    {
+        request.Wipe();
+        if (operation == "generate")
+        {
+            request.U8((uint8_t)Opcode::Generate);
+            request.U64(requestId);
+            request.U32(options.generateCount);
+        }
+        else if (operation == "hash")
+        {
+            request.U8((uint8_t)Opcode::Hash);
+            request.U64(requestId);
+            request.String("loadgen-password");
+        }
+        else
+        {
+            request.U8((uint8_t)Opcode::Verify);
+            request.U64(requestId);
+            request.String("loadgen-password");
+            request.String(hash);
+        }
+    }
+
+    ClientResult RunClient(const LoadOptions& options, int clientIndex, const std::string& hash)
+    {
+        ClientResult result;
+        result.latenciesUs.reserve(options.requestsPerClient);
+
+        const int fd = Connect(options.socketPath);
+        if (fd < 0)
+        {
+            result.errors = options.requestsPerClient;
+            return result;
+        }
+
+        static const char* mixedOperations[] = { "verify", "verify", "verify", "hash", "generate" };
+        Wire::Writer request;
+        std::vector<uint8_t> response;
+        for (int i = 0; i < options.requestsPerClient; i++)
+        {
+            const std::string operation = options.operation == "mix" ? mixedOperations[(clientIndex + i) % 5] : options.operation;
+            BuildRequest(request, options, operation, (uint64_t)i, hash);
+
+            const auto start = Clock::now();
+            const Status status = RoundTrip(fd, request, response);
+            const auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+
+            if (status == Status::Ok)
+                result.latenciesUs.push_back(elapsed);
+            else if (status == Status::Busy)
+                result.busy++;
+            else
+                result.errors++;
+        }
+
+        ::close(fd);
+        return result;
+    }
+
+    double Percentile(const std::vector<double>& sorted, double percentile)
+    {
+        if (sorted.empty())
+            return 0.0;
+        const size_t index = std::min(sorted.size() - 1, (size_t)(percentile / 100.0 * (double)sorted.size()));
+        return sorted[index];
+    }
+}
+
+int main(int argc, char** argv)
+{
+    LoadOptions options;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string arg = argv[i];
+        const std::string value = argv[i + 1];
+        if (arg == "--socket")
+            options.socketPath = value;
+        else if (arg == "--clients")
+            options.clients = std::max(1, std::stoi(value));
+        else if (arg == "--requests")
+            options.requestsPerClient = std::max(1, std::stoi(value));
+        else if (arg == "--op")
+            options.operation = value;
+        else if (arg == "--generate-count")
+            options.generateCount = (uint32_t)std::stoul(value);
+        else
+        {
+            std::cout << "usage: loadgen [--socket path] [--clients n] [--requests n] [--op verify|hash|generate|mix]"
+                         " [--generate-count n]" << std::endl;
+            return -1;
+        }
+    }
+
+    // verification needs a hash produced by the server's own policy
+    std::string hash;
+    {
+        const int fd = Connect(options.socketPath);
+        if (fd < 0)
+        {
+            std::cerr << "Failed to connect to " << options.socketPath << std::endl;
+            return -1;
+        }
+        Wire::Writer request;
+        BuildRequest(request, options, "hash", 0, hash);
+        std::vector<uint8_t> response;
+        if (RoundTrip(fd, request, response) != Status::Ok)
+        {
+            std::cerr << "Failed to hash the load test password" << std::endl;
+            ::close(fd);
+            return -1;
+        }
+        Wire::Reader reader(response);
+        reader.U8();
+        reader.U64();
+        hash = reader.String();
+        ::close(fd);
+    }
+
+    std::vector<ClientResult> results(options.clients);
+    std::vector<std::thread> clients;
+    const auto start = Clock::now();
+    for (int i = 0; i < options.clients; i++)
+        clients.emplace_back([&, i]() { results[i] = RunClient(options, i, hash); });
+    for (auto& client : clients)
+        client.join();
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latencies;
+    size_t busy = 0;
+    size_t errors = 0;
+    for (const auto& result : results)
+    {
+        latencies.insert(latencies.end(), result.latenciesUs.begin(), result.latenciesUs.end());
+        busy += result.busy;
+        errors += result.errors;
+    }
+    std::ranges::sort(latencies);
+
+    std::cout << "op: " << options.operation << ", clients: " << options.clients << "\n"
+              << "ok: " << latencies.size() << ", busy: " << busy << ", errors: " << errors << "\n"
+              << "throughput: " << (double)latencies.size() / seconds << " req/s\n"
+              << "p50: " << Percentile(latencies, 50.0) << " us\n"
+              << "p99: " << Percentile(latencies, 99.0) << " us\n"
+              << "max: " << (latencies.empty() ? 0.0 : latencies.back()) << " us" << std::endl;
+    return errors > 0 ? -1 : 0;
+}
@@ -0,0 +1,93 @@
+#include <atomic>
+#include <csignal>
+#include <iostream>
+#include <string>
+
+#include <sodium.h>
+
+#include "Daemon.h"
+
+namespace
+{
+    std::atomic<bool> s_StopRequested = false;
+
+    void RequestStop(int)
+    {
+        s_StopRequested = true;
+    }
+
+    Generator::EncryptionStrength ParseStrength(const std::string& value)
+    {
+        if (value == "low")
+            return Generator::EncryptionStrength::Low;
+        if (value == "high")
+            return Generator::EncryptionStrength::High;
+        return Generator::EncryptionStrength::Medium;
+    }
+
+    void PrintUsage()
+    {
+        std::cout << "usage: server [--socket path] [--workers n] [--memory-mib n] [--queue-depth n]\n"
+                     "              [--batch-size n] [--batch-window-us n] [--length n] [--strength low|medium|high]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (sodium_init() == -1)
+    {
+        std::cerr << "Failed to initialize libsodium" << std::endl;
+        return -1;
+    }
+
+    DaemonOptions options;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--help" || i + 1 >= argc)
+        {
+            PrintUsage();
+            return arg == "--help" ? 0 : -1;
+        }
+
+        const std::string value = argv[++i];
+        if (arg == "--socket")
+            options.socketPath = value;
+        else if (arg == "--workers")
+            options.workers = std::max(1, std::stoi(value));
+        else if (arg == "--memory-mib")
+            options.memoryBudgetBytes = std::stoull(value) * 1024 * 1024;
+        else if (arg == "--queue-depth")
+            options.maxQueueDepth = std::stoull(value);
+        else if (arg == "--batch-size")
+            options.maxBatchSize = std::max<size_t>(1, std::stoull(value));
+        else if (arg == "--batch-window-us")
+            options.batchWindow = std::chrono::microseconds(std::stoll(value));
+        else if (arg == "--length")
+            options.policy.passwordLength = std::stoull(value);
+        else if (arg == "--strength")
+            options.policy.encryptionStrength = ParseStrength(value);
+        else
+        {
+            PrintUsage();
+            return -1;
+        }
+    }
+
+    std::signal(SIGINT, RequestStop);
+    std::signal(SIGTERM, RequestStop);
+    // a client hanging up mid-response must not kill the daemon
+    std::signal(SIGPIPE, SIG_IGN);
+
+    try
+    {
+        Daemon daemon(options);
+        daemon.Run(s_StopRequested);
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << "Server error: " << ex.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
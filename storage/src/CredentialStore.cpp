@@ -0,0 +1,180 @@
+#include "CredentialStore.h"
+
+#include <utility>
+#include <vector>
+
+#include <Trace.h>
+
+#include "StoredHash.h"
+
+using Storage::StoredHash::IsPacked;
+using Storage::StoredHash::ToEncodedHash;
+using Storage::StoredHash::Unpack;
+
+Storage::CredentialStore::CredentialStore(const std::string& path, const Generator::PasswordGenerator& generator,
+                                          CredentialStoreOptions options)
+    :
+    generator(generator),
+    options(options),
+    db(path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE),
+    cache(options.cacheCapacity)
+{
+    // WAL lets readers (verification) carry on while a writer commits
+    db.exec("PRAGMA journal_mode=WAL");
+    db.exec("PRAGMA synchronous=NORMAL");
+
+    // the primary key is the index on account_id; WITHOUT ROWID stores rows in that index directly.
+    // hash holds either a packed BLOB or the encoded TEXT. Tables created as "hash TEXT" take BLOBs unchanged too.
+    db.exec("CREATE TABLE IF NOT EXISTS credentials ("
+            "account_id TEXT PRIMARY KEY NOT NULL, "
+            "hash BLOB NOT NULL, "
+            "updated_at INTEGER NOT NULL"
+            ") WITHOUT ROWID");
+
+    selectHash = std::make_unique<SQLite::Statement>(db, "SELECT hash FROM credentials WHERE account_id = ?");
+    upsertHash = std::make_unique<SQLite::Statement>(db,
+        "INSERT INTO credentials (account_id, hash, updated_at) VALUES (?, ?, strftime('%s', 'now')) "
+        "ON CONFLICT(account_id) DO UPDATE SET hash = excluded.hash, updated_at = excluded.updated_at");
+    deleteAccount = std::make_unique<SQLite::Statement>(db, "DELETE FROM credentials WHERE account_id = ?");
+    auditPage = std::make_unique<SQLite::Statement>(db,
+        "SELECT account_id, hash FROM credentials WHERE account_id > ? ORDER BY account_id LIMIT ?");
+}
+
+void Storage::CredentialStore::StoreHash(const std::string& accountId, const std::string& hash)
+{
+    std::string stored = StoredHash::FromEncodedHash(hash, options.packHashes);
+
+    const Generator::Trace::Span span("storage", "CredentialStore::StoreHash");
+    std::lock_guard lock(mutex);
+    upsertHash->bind(1, accountId);
+    if (IsPacked(stored))
+        upsertHash->bind(2, stored.data(), (int)stored.size());
+    else
+        upsertHash->bind(2, stored);
+    upsertHash->exec();
+    upsertHash->reset();
+    cache.Put(accountId, std::move(stored));
+}
+
+void Storage::CredentialStore::SetPassword(const std::string& accountId, std::string password)
+{
+    StoreHash(accountId, generator.HashPasswordSafe(std::move(password)));
+}
+
+std::optional<std::string> Storage::CredentialStore::FindHash(const std::string& accountId)
+{
+    std::optional<std::string> stored = FindStoredHash(accountId);
+    if (stored)
+        return ToEncodedHash(*stored);
+    return stored;
+}
+
+std::optional<std::string> Storage::CredentialStore::FindStoredHash(const std::string& accountId)
+{
+    const Generator::Trace::Span span("storage", "CredentialStore::FindHash");
+    std::lock_guard lock(mutex);
+    if (auto cached = cache.Get(accountId))
+        return cached;
+
+    std::optional<std::string> hash;
+    selectHash->bind(1, accountId);
+    if (selectHash->executeStep())
+        hash = selectHash->getColumn(0).getString();
+    selectHash->reset();
+
+    if (hash)
+        cache.Put(accountId, *hash);
+    return hash;
+}
+
+bool Storage::CredentialStore::VerifyAccount(const std::string& accountId, std::string password)
+{
+    if (password.empty())
+    {
+        throw std::invalid_argument("Password cannot be empty");
+    }
+
+    const std::optional<std::string> stored = FindStoredHash(accountId);
+    if (!stored)
+        return false;
+
+    // same handling as VerifyPasswordSafe(), but the plaintext is still needed if the hash has to be upgraded
+    {
+        const Generator::Trace::Span span("memory", "sodium_mlock");
+        sodium_mlock(&password[0], password.length());
+    }
+    bool verified = false;
+    try
+    {
+        // packed hashes are checked from their raw salt and tag, without rebuilding the string
+        if (IsPacked(*stored))
+            verified = Unpack(*stored).Verify(password);
+        else
+            verified = generator.VerifyPassword(password, *stored);
+
+        if (verified && options.rehashOnVerify && generator.NeedsRehash(ToEncodedHash(*stored)))
+            StoreHash(accountId, generator.HashPassword(password));
+    }
+    catch (...)
+    {
+        sodium_munlock(&password[0], password.length());
+        throw;
+    }
+    sodium_munlock(&password[0], password.length());
+    return verified;
+}
+
+bool Storage::CredentialStore::RemoveAccount(const std::string& accountId)
+{
+    const Generator::Trace::Span span("storage", "CredentialStore::RemoveAccount");
+    std::lock_guard lock(mutex);
+    deleteAccount->bind(1, accountId);
+    const int removed = deleteAccount->exec();
+    deleteAccount->reset();
+    cache.Erase(accountId);
+    return removed > 0;
+}
+
+size_t Storage::CredentialStore::AuditRehash(const std::function<void(const std::string& accountId)>& onNeedsRehash, size_t pageSize)
+{
+    size_t reported = 0;
+    std::string lastAccountId; // every id sorts after the empty string
+    std::vector<std::pair<std::string, std::string>> page;
+    page.reserve(pageSize);
+
+    while (true)
+    {
+        page.clear();
+        {
+            const Generator::Trace::Span span("storage", "CredentialStore::AuditPage");
+            std::lock_guard lock(mutex);
+            auditPage->bind(1, lastAccountId);
+            auditPage->bind(2, (int64_t)pageSize);
+            while (auditPage->executeStep())
+                page.emplace_back(auditPage->getColumn(0).getString(), auditPage->getColumn(1).getString());
+            auditPage->reset();
+        }
+
+        // the checks and callbacks run without the lock, so lookups aren't stalled by the audit
+        for (const auto& [accountId, hash] : page)
+        {
+            if (generator.NeedsRehash(ToEncodedHash(hash)))
+            {
+                onNeedsRehash(accountId);
+                reported++;
+            }
+        }
+
+        if (page.size() < pageSize)
+            return reported;
+        lastAccountId = page.back().first;
+    }
+}
+
+size_t Storage::CredentialStore::AccountCount()
+{
+    std::lock_guard lock(mutex);
+    SQLite::Statement count(db, "SELECT COUNT(*) FROM credentials");
+    count.executeStep();
+    return (size_t)count.getColumn(0).getInt64();
+}
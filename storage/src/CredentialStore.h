@@ -0,0 +1,87 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <Generator.h>
+
+#include "LruCache.h"
+
+namespace Storage
+{
+    struct CredentialStoreOptions
+    {
+        /// Hash rows kept in memory for repeated lookups of the same accounts.
+        size_t cacheCapacity = 4096;
+        /// Replace a hash that no longer matches the generator's policy after a successful VerifyAccount().
+        bool rehashOnVerify = true;
+        /// Store hashes in PackedHash's binary form, a BLOB about 40% smaller than the encoded string.
+        /// Rows already stored as text keep working either way.
+        bool packHashes = true;
+    };
+
+    class CredentialStore;
+}
+
+/// Stores one password hash per account id in SQLite and verifies passwords against it.
+/// The table is keyed (and therefore indexed) by account id. The hot statements are prepared once and reused, and
+/// recently read hash rows are kept in a bounded LRU cache. Safe to share between threads.
+class Storage::CredentialStore
+{
+public:
+    /**
+     * Opens (or creates) the credential database.
+     * @param path SQLite file path, or ":memory:".
+     * @param generator Used for hashing and verification. Must outlive the store.
+     */
+    CredentialStore(const std::string& path, const Generator::PasswordGenerator& generator, CredentialStoreOptions options = {});
+
+    /// Inserts or replaces the hash for an account.
+    void StoreHash(const std::string& accountId, const std::string& hash);
+
+    /// Hashes the password with the generator's policy and stores it. The password is erased (see HashPasswordSafe()).
+    void SetPassword(const std::string& accountId, std::string password);
+
+    /// Returns the stored hash as an encoded string, from the cache when possible.
+    [[nodiscard]] std::optional<std::string> FindHash(const std::string& accountId);
+
+    /// Verifies a password against the account's stored hash. Unknown accounts simply don't verify.
+    /// The password is erased, like VerifyPasswordSafe().
+    [[nodiscard]] bool VerifyAccount(const std::string& accountId, std::string password);
+
+    /// Returns true if the account existed.
+    bool RemoveAccount(const std::string& accountId);
+
+    /**
+     * Walks the whole table and reports every account whose hash no longer matches the generator's policy.
+     * Rows are read in key order one page at a time (a keyset cursor), so memory stays flat and no read transaction
+     * is held across pages, however many rows there are.
+     * @returns The number of accounts reported.
+     */
+    size_t AuditRehash(const std::function<void(const std::string& accountId)>& onNeedsRehash, size_t pageSize = 1000);
+
+    [[nodiscard]] size_t AccountCount();
+
+private:
+    /// The stored column value, either an encoded hash string or PackedHash bytes.
+    std::optional<std::string> FindStoredHash(const std::string& accountId);
+
+    const Generator::PasswordGenerator& generator;
+    const CredentialStoreOptions options;
+
+    SQLite::Database db;
+    // prepared once, reset after every use
+    std::unique_ptr<SQLite::Statement> selectHash;
+    std::unique_ptr<SQLite::Statement> upsertHash;
+    std::unique_ptr<SQLite::Statement> deleteAccount;
+    std::unique_ptr<SQLite::Statement> auditPage;
+
+    // keyed by account id, holds the stored column value
+    LruCache<std::string, std::string> cache;
+    std::mutex mutex;
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace Storage
+{
+    template<typename Key, typename Value>
+    class LruCache;
+}
+
+/// Bounded least-recently-used cache. Not thread-safe, callers lock around it.
+template<typename Key, typename Value>
+class Storage::LruCache
+{
+public:
+    explicit LruCache(size_t capacity) : capacity(capacity) {}
+
+    /// Returns the cached value and marks it as most recently used.
+    std::optional<Value> Get(const Key& key)
+    {
+        auto it = index.find(key);
+        if (it == index.end())
+            return std::nullopt;
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+    }
+
+    void Put(const Key& key, Value value)
+    {
+        if (capacity == 0)
+            return;
+
+        auto it = index.find(key);
+        if (it != index.end())
+        {
+            it->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+
+        if (entries.size() >= capacity)
+        {
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+        entries.emplace_front(key, std::move(value));
+        index.emplace(key, entries.begin());
+    }
+
+    void Erase(const Key& key)
+    {
+        auto it = index.find(key);
+        if (it == index.end())
+            return;
+        entries.erase(it->second);
+        index.erase(it);
+    }
+
+    void Clear()
+    {
+        entries.clear();
+        index.clear();
+    }
+
+    [[nodiscard]] size_t Size() const { return entries.size(); }
+
+private:
+    using Entry = std::pair<Key, Value>;
+
+    const size_t capacity;
+    std::list<Entry> entries;
+    std::unordered_map<Key, typename std::list<Entry>::iterator> index;
+};
@@ -0,0 +1,415 @@
+#include "ShardedCredentialStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#include <Trace.h>
+
+#include "StoredHash.h"
+
+using Storage::StoredHash::IsPacked;
+using Storage::StoredHash::ToEncodedHash;
+using Storage::StoredHash::Unpack;
+
+namespace
+{
+    // readers and the writer of a shard only contend during WAL checkpoints, so this is rarely waited out
+    constexpr int s_BusyTimeoutMs = 5000;
+}
+
+Storage::ShardedCredentialStore::Shard::Shard(const std::string& path)
+    :
+    writeDb(path, SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE, s_BusyTimeoutMs),
+    readDb(path, SQLite::OPEN_READWRITE, s_BusyTimeoutMs)
+{
+    // same table as CredentialStore, so a single shard file can be opened by it too
+    writeDb.exec("PRAGMA journal_mode=WAL");
+    writeDb.exec("PRAGMA synchronous=NORMAL");
+    writeDb.exec("CREATE TABLE IF NOT EXISTS credentials ("
+                 "account_id TEXT PRIMARY KEY NOT NULL, "
+                 "hash BLOB NOT NULL, "
+                 "updated_at INTEGER NOT NULL"
+                 ") WITHOUT ROWID");
+    writeDb.exec("CREATE TABLE IF NOT EXISTS shard_info (shard_index INTEGER NOT NULL, shard_count INTEGER NOT NULL)");
+
+    selectHash = std::make_unique<SQLite::Statement>(readDb, "SELECT hash FROM credentials WHERE account_id = ?");
+}
+
+Storage::ShardedCredentialStore::ShardedCredentialStore(const std::string& directory,
+                                                        const Generator::PasswordGenerator& generator,
+                                                        ShardedCredentialStoreOptions options)
+    :
+    generator(generator),
+    options(options)
+{
+    if (options.shards == 0)
+        throw std::invalid_argument("A sharded store needs at least one shard");
+    if (options.maxBatchSize == 0 || options.maxQueueDepth == 0)
+        throw std::invalid_argument("Batch size and queue depth must be at least 1");
+
+    std::filesystem::create_directories(directory);
+    for (size_t i = 0; i < options.shards; i++)
+    {
+        const std::string path = (std::filesystem::path(directory) / ("credentials-" + std::to_string(i) + ".db")).string();
+        auto shard = std::make_unique<Shard>(path);
+
+        // accounts are placed by shard count, opening with another count would look in the wrong files
+        SQLite::Statement info(shard->writeDb, "SELECT shard_index, shard_count FROM shard_info");
+        if (info.executeStep())
+        {
+            if ((size_t)info.getColumn(0).getInt64() != i || (size_t)info.getColumn(1).getInt64() != options.shards)
+                throw std::invalid_argument(path + " belongs to a store with " +
+                                            std::to_string(info.getColumn(1).getInt64()) + " shards, not " +
+                                            std::to_string(options.shards));
+        }
+        else
+        {
+            SQLite::Statement insert(shard->writeDb, "INSERT INTO shard_info (shard_index, shard_count) VALUES (?, ?)");
+            insert.bind(1, (int64_t)i);
+            insert.bind(2, (int64_t)options.shards);
+            insert.exec();
+        }
+        shards.push_back(std::move(shard));
+    }
+
+    for (auto& shard : shards)
+        shard->writer = std::thread(&ShardedCredentialStore::WriterLoop, this, std::ref(*shard));
+}
+
+Storage::ShardedCredentialStore::~ShardedCredentialStore()
+{
+    for (auto& shard : shards)
+    {
+        {
+            std::lock_guard lock(shard->queueMutex);
+            shard->stopping = true;
+        }
+        shard->queueChanged.notify_all();
+    }
+    for (auto& shard : shards)
+    {
+        if (shard->writer.joinable())
+            shard->writer.join();
+    }
+}
+
+size_t Storage::ShardedCredentialStore::ShardOf(std::string_view accountId) const
+{
+    // spelled out rather than std::hash, whose values may change between standard libraries
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (const char c : accountId)
+    {
+        hash ^= (uint8_t)c;
+        hash *= 0x100000001b3ull;
+    }
+    return (size_t)(hash % shards.size());
+}
+
+void Storage::ShardedCredentialStore::StoreHash(const std::string& accountId, const std::string& hash)
+{
+    Enqueue(accountId, StoredHash::FromEncodedHash(hash, options.packHashes));
+}
+
+void Storage::ShardedCredentialStore::SetPassword(const std::string& accountId, std::string password)
+{
+    StoreHash(accountId, generator.HashPasswordSafe(std::move(password)));
+}
+
+void Storage::ShardedCredentialStore::RemoveAccount(const std::string& accountId)
+{
+    Enqueue(accountId, std::nullopt);
+}
+
+void Storage::ShardedCredentialStore::Enqueue(const std::string& accountId, std::optional<std::string> stored)
+{
+    Shard& shard = *shards[ShardOf(accountId)];
+    {
+        // only slow when the shard's queue is full and the caller waits for the writer
+        const Generator::Trace::Span span("storage", "ShardedCredentialStore::Enqueue");
+        std::unique_lock lock(shard.queueMutex);
+        shard.committedChanged.wait(lock, [&]()
+        {
+            return !shard.failure.empty() || shard.queue.size() < options.maxQueueDepth;
+        });
+        if (!shard.failure.empty())
+            throw std::runtime_error(shard.failure);
+
+        Write write{accountId, std::move(stored), ++shard.lastQueued};
+        shard.uncommitted[accountId] = write;
+        shard.queue.push_back(std::move(write));
+    }
+    shard.queueChanged.notify_one();
+}
+
+void Storage::ShardedCredentialStore::WriterLoop(Shard& shard)
+{
+    SQLite::Statement upsertHash(shard.writeDb,
+        "INSERT INTO credentials (account_id, hash, updated_at) VALUES (?, ?, strftime('%s', 'now')) "
+        "ON CONFLICT(account_id) DO UPDATE SET hash = excluded.hash, updated_at = excluded.updated_at");
+    SQLite::Statement deleteAccount(shard.writeDb, "DELETE FROM credentials WHERE account_id = ?");
+    std::vector<Write> batch;
+    batch.reserve(options.maxBatchSize);
+
+    while (true)
+    {
+        batch.clear();
+        {
+            std::unique_lock lock(shard.queueMutex);
+            shard.queueChanged.wait(lock, [&]() { return shard.stopping || !shard.queue.empty(); });
+            // the queue is drained before stopping, so the destructor doesn't drop writes
+            if (shard.queue.empty())
+                return;
+
+            // no batching window: whatever piled up during the last commit goes into the next one
+            const size_t batchSize = std::min(shard.queue.size(), options.maxBatchSize);
+            for (size_t i = 0; i < batchSize; i++)
+            {
+                batch.push_back(std::move(shard.queue.front()));
+                shard.queue.pop_front();
+            }
+        }
+
+        std::string error;
+        try
+        {
+            // one transaction (and one WAL sync) per batch instead of per row
+            const Generator::Trace::Span span("storage", "ShardedCredentialStore::CommitBatch");
+            SQLite::Transaction transaction(shard.writeDb);
+            for (const Write& write : batch)
+            {
+                if (write.stored)
+                {
+                    upsertHash.bind(1, write.accountId);
+                    if (IsPacked(*write.stored))
+                        upsertHash.bind(2, write.stored->data(), (int)write.stored->size());
+                    else
+                        upsertHash.bind(2, *write.stored);
+                    upsertHash.exec();
+                    upsertHash.reset();
+                }
+                else
+                {
+                    deleteAccount.bind(1, write.accountId);
+                    deleteAccount.exec();
+                    deleteAccount.reset();
+                }
+            }
+            transaction.commit();
+        }
+        catch (const std::exception& ex)
+        {
+            upsertHash.reset();
+            deleteAccount.reset();
+            error = ex.what();
+        }
+
+        {
+            std::lock_guard lock(shard.queueMutex);
+            if (error.empty())
+            {
+                shard.lastCommitted = batch.back().sequence;
+                for (const Write& write : batch)
+                {
+                    // a newer write of the same account is still queued, keep serving that one
+                    auto it = shard.uncommitted.find(write.accountId);
+                    if (it != shard.uncommitted.end() && it->second.sequence == write.sequence)
+                        shard.uncommitted.erase(it);
+                }
+            }
+            else
+            {
+                shard.failure = "Shard writer failed: " + error;
+                shard.queue.clear();
+                shard.uncommitted.clear();
+                shard.lastCommitted = shard.lastQueued;
+            }
+        }
+        shard.committedChanged.notify_all();
+        if (!error.empty())
+            return;
+    }
+}
+
+void Storage::ShardedCredentialStore::Flush()
+{
+    const Generator::Trace::Span span("storage", "ShardedCredentialStore::Flush");
+    for (auto& shard : shards)
+    {
+        std::unique_lock lock(shard->queueMutex);
+        const uint64_t target = shard->lastQueued;
+        shard->committedChanged.wait(lock, [&]() { return shard->lastCommitted >= target || !shard->failure.empty(); });
+        if (!shard->failure.empty())
+            throw std::runtime_error(shard->failure);
+    }
+}
+
+std::optional<std::string> Storage::ShardedCredentialStore::FindHash(const std::string& accountId)
+{
+    std::optional<std::string> stored = FindStoredHash(accountId);
+    if (stored)
+        return ToEncodedHash(*stored);
+    return stored;
+}
+
+std::optional<std::string> Storage::ShardedCredentialStore::FindStoredHash(const std::string& accountId)
+{
+    Shard& shard = *shards[ShardOf(accountId)];
+    {
+        std::lock_guard lock(shard.queueMutex);
+        auto it = shard.uncommitted.find(accountId);
+        if (it != shard.uncommitted.end())
+            return it->second.stored;
+    }
+
+    // the writer erases an uncommitted entry only after its commit, so the row is readable by now
+    const Generator::Trace::Span span("storage", "ShardedCredentialStore::FindHash");
+    std::lock_guard lock(shard.readMutex);
+    std::optional<std::string> hash;
+    shard.selectHash->bind(1, accountId);
+    if (shard.selectHash->executeStep())
+        hash = shard.selectHash->getColumn(0).getString();
+    shard.selectHash->reset();
+    return hash;
+}
+
+bool Storage::ShardedCredentialStore::VerifyAccount(const std::string& accountId, std::string password)
+{
+    if (password.empty())
+    {
+        throw std::invalid_argument("Password cannot be empty");
+    }
+
+    const std::optional<std::string> stored = FindStoredHash(accountId);
+    if (!stored)
+        return false;
+
+    // same handling as CredentialStore::VerifyAccount()
+    {
+        const Generator::Trace::Span span("memory", "sodium_mlock");
+        sodium_mlock(&password[0], password.length());
+    }
+    bool verified = false;
+    try
+    {
+        if (IsPacked(*stored))
+            verified = Unpack(*stored).Verify(password);
+        else
+            verified = generator.VerifyPassword(password, *stored);
+
+        if (verified && options.rehashOnVerify && generator.NeedsRehash(ToEncodedHash(*stored)))
+            StoreHash(accountId, generator.HashPassword(password));
+    }
+    catch (...)
+    {
+        sodium_munlock(&password[0], password.length());
+        throw;
+    }
+    sodium_munlock(&password[0], password.length());
+    return verified;
+}
+
+size_t Storage::ShardedCredentialStore::ScanShards(
+    const std::function<void(const std::string& accountId, const std::string& stored)>& visit, size_t pageSize)
+{
+    if (pageSize == 0)
+        throw std::invalid_argument("Page size must be at least 1");
+    Flush();
+
+    std::atomic<size_t> visited = 0;
+    std::vector<std::exception_ptr> failures(shards.size());
+    std::vector<std::thread> threads;
+    threads.reserve(shards.size());
+    for (size_t i = 0; i < shards.size(); i++)
+    {
+        threads.emplace_back([&, i]()
+        {
+            try
+            {
+                Shard& shard = *shards[i];
+                std::string lastAccountId; // every id sorts after the empty string
+                std::vector<std::pair<std::string, std::string>> page;
+                page.reserve(pageSize);
+                do
+                {
+                    page.clear();
+                    {
+                        // the read connection is only held for one page, lookups on this shard slip in between
+                        const Generator::Trace::Span span("storage", "ShardedCredentialStore::ScanPage");
+                        std::lock_guard lock(shard.readMutex);
+                        SQLite::Statement select(shard.readDb,
+                            "SELECT account_id, hash FROM credentials WHERE account_id > ? ORDER BY account_id LIMIT ?");
+                        select.bind(1, lastAccountId);
+                        select.bind(2, (int64_t)pageSize);
+                        while (select.executeStep())
+                            page.emplace_back(select.getColumn(0).getString(), select.getColumn(1).getString());
+                    }
+
+                    for (const auto& [accountId, stored] : page)
+                        visit(accountId, stored);
+                    visited += page.size();
+                    if (!page.empty())
+                        lastAccountId = page.back().first;
+                } while (page.size() == pageSize);
+            }
+            catch (...)
+            {
+                failures[i] = std::current_exception();
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (const std::exception_ptr& failure : failures)
+    {
+        if (failure)
+            std::rethrow_exception(failure);
+    }
+    return visited;
+}
+
+size_t Storage::ShardedCredentialStore::Scan(
+    const std::function<void(const std::string& accountId, const std::string& hash)>& onAccount, size_t pageSize)
+{
+    std::mutex callbackMutex;
+    return ScanShards([&](const std::string& accountId, const std::string& stored)
+    {
+        const std::string hash = ToEncodedHash(stored);
+        std::lock_guard lock(callbackMutex);
+        onAccount(accountId, hash);
+    }, pageSize);
+}
+
+size_t Storage::ShardedCredentialStore::AuditRehash(const std::function<void(const std::string& accountId)>& onNeedsRehash,
+                                                     size_t pageSize)
+{
+    std::mutex callbackMutex;
+    size_t reported = 0;
+    ScanShards([&](const std::string& accountId, const std::string& stored)
+    {
+        if (!generator.NeedsRehash(ToEncodedHash(stored)))
+            return;
+        std::lock_guard lock(callbackMutex);
+        onNeedsRehash(accountId);
+        reported++;
+    }, pageSize);
+    return reported;
+}
+
+size_t Storage::ShardedCredentialStore::AccountCount()
+{
+    Flush();
+    size_t count = 0;
+    for (auto& shard : shards)
+    {
+        std::lock_guard lock(shard->readMutex);
+        SQLite::Statement select(shard->readDb, "SELECT COUNT(*) FROM credentials");
+        select.executeStep();
+        count += (size_t)select.getColumn(0).getInt64();
+    }
+    return count;
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <SQLiteCpp/SQLiteCpp.h>
+
+#include <Generator.h>
+
+namespace Storage
+{
+    struct ShardedCredentialStoreOptions
+    {
+        /// SQLite files the accounts are spread over. Fixed once the store exists, it decides where an account lives.
+        size_t shards = 8;
+        /// Writes committed per transaction, at most. A writer commits whatever is queued, up to this many.
+        size_t maxBatchSize = 1024;
+        /// Writes queued per shard before StoreHash() blocks and waits for the writer to catch up.
+        size_t maxQueueDepth = 16384;
+        /// Replace a hash that no longer matches the generator's policy after a successful VerifyAccount().
+        bool rehashOnVerify = true;
+        /// Store hashes as PackedHash BLOBs, like CredentialStore.
+        bool packHashes = true;
+    };
+
+    class ShardedCredentialStore;
+}
+
+/// CredentialStore's table spread over several SQLite files, so hashes coming out of a parallel hashing pool aren't
+/// all committed behind one database's single writer lock. An account's shard is a stable hash of its id.
+/// Every shard has a writer thread that commits queued writes in batched transactions, and a separate WAL read
+/// connection for lookups, so reads never wait for a commit. Writes on different shards proceed in parallel.
+/// Writes are asynchronous: they are visible to FindHash()/VerifyAccount() right away and durable after Flush().
+/// Safe to share between threads.
+class Storage::ShardedCredentialStore
+{
+public:
+    /**
+     * Opens (or creates) directory/credentials-<n>.db for every shard and starts the writer threads.
+     * @param generator Used for hashing and verification. Must outlive the store.
+     * @throws std::invalid_argument if the directory holds a store with a different shard count.
+     */
+    ShardedCredentialStore(const std::string& directory, const Generator::PasswordGenerator& generator,
+                           ShardedCredentialStoreOptions options = {});
+    /// Commits everything still queued, then stops the writers.
+    ~ShardedCredentialStore();
+
+    ShardedCredentialStore(const ShardedCredentialStore&) = delete;
+    ShardedCredentialStore& operator=(const ShardedCredentialStore&) = delete;
+
+    [[nodiscard]] size_t ShardCount() const { return shards.size(); }
+    /// The shard an account lives in. The same on every platform and run (64-bit FNV-1a of the id).
+    [[nodiscard]] size_t ShardOf(std::string_view accountId) const;
+
+    /// Queues an insert or replace of the account's hash. Blocks only while the shard's queue is full.
+    /// @throws std::runtime_error if the shard's writer failed earlier.
+    void StoreHash(const std::string& accountId, const std::string& hash);
+
+    /// Hashes the password with the generator's policy and queues it. The password is erased (see HashPasswordSafe()).
+    void SetPassword(const std::string& accountId, std::string password);
+
+    /// Queues the removal of an account.
+    void RemoveAccount(const std::string& accountId);
+
+    /// Waits until every write queued before the call is committed.
+    /// @throws std::runtime_error if a writer failed; the writes it hadn't committed are lost.
+    void Flush();
+
+    /// Returns the account's hash as an encoded string, including writes that are still queued.
+    [[nodiscard]] std::optional<std::string> FindHash(const std::string& accountId);
+
+    /// Verifies a password against the account's stored hash. Unknown accounts simply don't verify.
+    /// The password is erased, like VerifyPasswordSafe().
+    [[nodiscard]] bool VerifyAccount(const std::string& accountId, std::string password);
+
+    /**
+     * Flushes, then reads every shard in parallel, one thread per shard, each with a keyset cursor like
+     * CredentialStore::AuditRehash().
+     * @param onAccount Gets the account id and encoded hash. Called one at a time, in no particular order.
+     * @returns The number of accounts visited.
+     */
+    size_t Scan(const std::function<void(const std::string& accountId, const std::string& hash)>& onAccount,
+                size_t pageSize = 1000);
+
+    /// Scan() that reports every account whose hash no longer matches the generator's policy. The checks run on the
+    /// shard threads, the callback one call at a time.
+    size_t AuditRehash(const std::function<void(const std::string& accountId)>& onNeedsRehash, size_t pageSize = 1000);
+
+    /// Flushes, then counts the accounts of all shards.
+    [[nodiscard]] size_t AccountCount();
+
+private:
+    struct Write
+    {
+        std::string accountId;
+        /// The column value, or nullopt to remove the account.
+        std::optional<std::string> stored;
+        uint64_t sequence = 0;
+    };
+
+    struct Shard
+    {
+        explicit Shard(const std::string& path);
+
+        /// Only used by the writer thread once it runs.
+        SQLite::Database writeDb;
+        /// Lookups and scans. WAL lets it read while the writer commits.
+        SQLite::Database readDb;
+        std::unique_ptr<SQLite::Statement> selectHash;
+        std::mutex readMutex;
+
+        std::mutex queueMutex;
+        /// Signalled when writes are queued or the store shuts down.
+        std::condition_variable queueChanged;
+        /// Signalled after every commit, which also makes room in the queue.
+        std::condition_variable committedChanged;
+        std::deque<Write> queue;
+        /// The newest queued, not yet committed value of each account, so lookups see their own writes.
+        std::unordered_map<std::string, Write> uncommitted;
+        uint64_t lastQueued = 0;
+        uint64_t lastCommitted = 0;
+        std::string failure;
+        bool stopping = false;
+
+        std::thread writer;
+    };
+
+    void Enqueue(const std::string& accountId, std::optional<std::string> stored);
+    void WriterLoop(Shard& shard);
+    /// The column value, either an encoded hash string or PackedHash bytes.
+    std::optional<std::string> FindStoredHash(const std::string& accountId);
+    /// Runs visit on one thread per shard, concurrently. Returns the number of rows visited.
+    size_t ScanShards(const std::function<void(const std::string& accountId, const std::string& stored)>& visit,
+                      size_t pageSize);
+
+    const Generator::PasswordGenerator& generator;
+    const ShardedCredentialStoreOptions options;
+    std::vector<std::unique_ptr<Shard>> shards;
+};
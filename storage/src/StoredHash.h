@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <PackedHash.h>
+
+/// How the stores keep a hash in their hash column: PackedHash bytes, or the encoded string for formats PackedHash
+/// doesn't know (and for rows written before hashes were packed).
+namespace Storage::StoredHash
+{
+    /// Encoded hashes always start with '$', packed ones with their format version byte
+    inline bool IsPacked(const std::string& stored)
+    {
+        return !stored.empty() && stored[0] != '$';
+    }
+
+    inline Generator::PackedHash Unpack(const std::string& stored)
+    {
+        return Generator::PackedHash::FromBytes((const uint8_t*)stored.data(), stored.size());
+    }
+
+    inline std::string ToEncodedHash(const std::string& stored)
+    {
+        return IsPacked(stored) ? Unpack(stored).ToString() : stored;
+    }
+
+    /// The column value for an encoded hash.
+    inline std::string FromEncodedHash(const std::string& hash, bool pack)
+    {
+        if (!pack)
+            return hash;
+        try
+        {
+            const std::vector<uint8_t> packed = Generator::PackedHash::FromString(hash).ToBytes();
+            return std::string(packed.begin(), packed.end());
+        }
+        catch (const std::invalid_argument&)
+        {
+            // a format PackedHash doesn't know is stored as it came
+            return hash;
+        }
+    }
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <Argon2Engine.h>
+#include <Generator.h>
+
+using namespace Generator;
+
+class Argon2EngineTests : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+
+    static std::vector<Argon2Kernel> SupportedKernels()
+    {
+        std::vector<Argon2Kernel> kernels;
+        for (const Argon2Kernel kernel : {Argon2Kernel::Portable, Argon2Kernel::Sse41, Argon2Kernel::Avx2})
+            if (IsArgon2KernelSupported(kernel))
+                kernels.push_back(kernel);
+        return kernels;
+    }
+};
+
+TEST_F(Argon2EngineTests, MatchesTheRfc9106TestVector)
+{
+    // given:
+    const std::string password(32, '\x01');
+    const std::vector<uint8_t> salt(16, 0x02);
+    const std::vector<uint8_t> secret(8, 0x03);
+    const std::vector<uint8_t> associatedData(12, 0x04);
+    const std::vector<uint8_t> expected = {
+        0x0d, 0x64, 0x0d, 0xf5, 0x8d, 0x78, 0x76, 0x6c, 0x08, 0xc0, 0x37, 0xa3, 0x4a, 0x8b, 0x53, 0xc9,
+        0xd0, 0x1e, 0xf0, 0x45, 0x2d, 0x75, 0xb6, 0x5e, 0xb5, 0x25, 0x20, 0xe9, 0x6b, 0x01, 0xe6, 0x59 };
+
+    for (const Argon2Kernel kernel : SupportedKernels())
+    {
+        // when:
+        Argon2Arena arena;
+        const std::vector<uint8_t> tag = Argon2Engine(kernel).Hash(arena, password, salt, Argon2Params{3, 32, 4}, 32, secret, associatedData);
+
+        // then:
+        EXPECT_EQ(tag, expected) << Argon2KernelName(kernel);
+    }
+}
+
+TEST_F(Argon2EngineTests, MatchesLibsodiumRawOutput)
+{
+    // given:
+    const std::string password = "<PASSWORD1?2.3!4@hello>";
+    std::vector<uint8_t> salt(crypto_pwhash_SALTBYTES);
+    randombytes_buf(salt.data(), salt.size());
+    // the odd memory size gets rounded down to whole segments; the long tag exercises the chained H'
+    const Argon2Params cases[] = { {1, 8}, {2, 1024}, {3, 259} };
+    const size_t tagLengths[] = { 16, 32, 100 };
+
+    for (const Argon2Kernel kernel : SupportedKernels())
+    {
+        const Argon2Engine engine(kernel);
+        Argon2Arena arena;
+        for (const Argon2Params& params : cases)
+        {
+            for (const size_t tagLength : tagLengths)
+            {
+                // when:
+                std::vector<uint8_t> expected(tagLength);
+                ASSERT_EQ(crypto_pwhash(expected.data(), expected.size(), password.data(), password.size(), salt.data(),
+                                        params.timeCost, (size_t)params.memoryKiB * 1024, crypto_pwhash_ALG_ARGON2ID13), 0);
+                const std::vector<uint8_t> tag = engine.Hash(arena, password, salt, params, tagLength);
+
+                // then:
+                EXPECT_EQ(tag, expected) << Argon2KernelName(kernel) << " t=" << params.timeCost << " m=" << params.memoryKiB << " tag=" << tagLength;
+            }
+        }
+    }
+}
+
+TEST_F(Argon2EngineTests, StringsInteroperateWithLibsodium)
+{
+    // given:
+    const std::string password = "<PASSWORD1?2.3!4@hello>";
+    const Argon2Engine engine;
+    Argon2Arena arena;
+    const HashCost cost{2, 256 * 1024};
+
+    // when:
+    const std::string engineHash = engine.HashString(arena, password, Argon2Params::FromHashCost(cost));
+    const std::string libsodiumHash = GetHashingBackend(HashAlgorithm::Argon2id).Hash(password, cost);
+
+    // then:
+    EXPECT_TRUE(engineHash.starts_with("$argon2id$v=19$m=256,t=2,p=1$")) << engineHash;
+    EXPECT_EQ(crypto_pwhash_argon2id_str_verify(engineHash.c_str(), password.c_str(), password.size()), 0);
+    EXPECT_TRUE(engine.VerifyString(arena, password, libsodiumHash));
+    EXPECT_FALSE(engine.VerifyString(arena, "momolleh", libsodiumHash)) << "Wrong password verified";
+    EXPECT_FALSE(engine.VerifyString(arena, password, "$argon2id$garbage"));
+}
+
+TEST_F(Argon2EngineTests, ArenaIsReusedAndOnlyGrows)
+{
+    // given:
+    const Argon2Engine engine;
+    Argon2Arena arena;
+    const std::vector<uint8_t> salt(16, 7);
+    const std::vector<uint8_t> first = engine.Hash(arena, "momolleh", salt, Argon2Params{1, 512});
+    const size_t capacity = arena.Capacity();
+    const void* blocks = arena.Blocks();
+
+    // when:
+    (void)engine.Hash(arena, "momolleh", salt, Argon2Params{1, 64});
+    const std::vector<uint8_t> again = engine.Hash(arena, "momolleh", salt, Argon2Params{1, 512});
+    const void* reused = arena.Blocks();
+    (void)engine.Hash(arena, "momolleh", salt, Argon2Params{1, 1024});
+
+    // then:
+    EXPECT_GE(capacity, 512 * 1024);
+    EXPECT_EQ(reused, blocks) << "Arena was remapped although it was big enough";
+    EXPECT_EQ(again, first) << "Leftovers in the reused arena changed the result";
+    EXPECT_GE(arena.Capacity(), 1024 * 1024);
+    EXPECT_THROW((void)engine.Hash(arena, "momolleh", salt, Argon2Params{1, 8, 2}), std::invalid_argument);
+    EXPECT_THROW((void)engine.Hash(arena, "momolleh", std::vector<uint8_t>(4), Argon2Params{}), std::invalid_argument);
+}
+
+TEST_F(Argon2EngineTests, PolicyCanSwitchToTheEngine)
+{
+    // given:
+    PasswordPolicy policy{16};
+    policy.useArgon2Engine = true;
+    const PasswordGenerator engineGenerator(policy);
+    const PasswordGenerator libsodiumGenerator(PasswordPolicy{16});
+
+    // when:
+    const std::string engineHash = engineGenerator.HashPassword("momolleh");
+    const std::string libsodiumHash = libsodiumGenerator.HashPassword("momolleh");
+
+    // then:
+    EXPECT_TRUE(libsodiumGenerator.VerifyPassword("momolleh", engineHash));
+    EXPECT_TRUE(engineGenerator.VerifyPassword("momolleh", libsodiumHash));
+    EXPECT_FALSE(engineGenerator.VerifyPassword("hellomom", libsodiumHash));
+    EXPECT_FALSE(engineGenerator.NeedsRehash(libsodiumHash)) << "Switching engines shouldn't force a rehash";
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <Benchmark.h>
+
+#include <sstream>
+
+using namespace Benchmark;
+
+namespace
+{
+    std::vector<Record> Parse(const std::string& json)
+    {
+        std::istringstream in(json);
+        return ReadJson(in);
+    }
+}
+
+TEST(BenchmarkReportTests, ReadJsonReadsWhatWriteJsonWrites)
+{
+    // given:
+    const std::vector<Record> written = {
+        { "regression", { "generate length 16", 1234567.89, "pw/s" } },
+        { "hashing", { "argon2id \"low\"", 42.5, "hash/s" } },
+        { "hashing", { "peak memory", 1048576, "bytes" } } };
+    std::ostringstream out;
+    WriteJson(out, written);
+
+    // when:
+    const auto read = Parse(out.str());
+
+    // then:
+    ASSERT_EQ(read.size(), written.size());
+    for (size_t i = 0; i < read.size(); i++)
+    {
+        EXPECT_EQ(read[i].group, written[i].group);
+        EXPECT_EQ(read[i].result.name, written[i].result.name);
+        EXPECT_DOUBLE_EQ(read[i].result.value, written[i].result.value);
+        EXPECT_EQ(read[i].result.unit, written[i].result.unit);
+    }
+}
+
+TEST(BenchmarkReportTests, MalformedOrEmptyBaselinesThrow)
+{
+    EXPECT_THROW((void)Parse(""), std::runtime_error);
+    EXPECT_THROW((void)Parse("{\"records\": []}"), std::runtime_error);
+    EXPECT_THROW((void)Parse("{\"results\": [{\"group\": 1}]}"), std::runtime_error);
+    EXPECT_TRUE(Parse("{\"results\": []}").empty());
+}
+
+TEST(BenchmarkReportTests, OnlyRatesBelowTheToleranceRegress)
+{
+    // given:
+    const std::vector<Record> baseline = {
+        { "g", { "steady", 1000, "pw/s" } },
+        { "g", { "slower", 1000, "hash/s" } },
+        { "g", { "memory", 100, "bytes" } } };
+    const std::vector<Record> current = {
+        { "g", { "steady", 801, "pw/s" } },     // 19.9% slower, within 20%
+        { "g", { "slower", 799, "hash/s" } },   // 20.1% slower
+        { "g", { "memory", 1, "bytes" } },      // not a rate
+        { "g", { "new", 1, "pw/s" } } };        // not in the baseline
+
+    // when:
+    const auto regressions = FindRegressions(current, baseline, 0.2);
+
+    // then:
+    ASSERT_EQ(regressions.size(), 1);
+    EXPECT_EQ(regressions[0].rfind("g/slower:", 0), 0) << regressions[0];
+    EXPECT_TRUE(FindRegressions(current, baseline, 0.25).empty());
+}
+
+TEST(BenchmarkReportTests, BaselineEntriesMissingFromTheRunRegress)
+{
+    // given:
+    const std::vector<Record> baseline = { { "g", { "gone", 1000, "pw/s" } } };
+
+    // when:
+    const auto regressions = FindRegressions({}, baseline, 0.2);
+
+    // then:
+    ASSERT_EQ(regressions.size(), 1);
+    EXPECT_EQ(regressions[0], "g/gone: missing from this run");
+    EXPECT_TRUE(FindRegressions({ { "g", { "gone", 1000, "pw/s" } } }, {}, 0.2).empty()) << "An empty baseline checks nothing";
+}
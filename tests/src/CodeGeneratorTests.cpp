@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <CodeGenerator.h>
+
+#include <array>
+
+using namespace Generator;
+
+class CodeGeneratorTests : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST_F(CodeGeneratorTests, CheckDigitsMatchKnownValues)
+{
+    // given/when/then: the textbook examples for both schemes
+    EXPECT_EQ(LuhnCheckDigit("7992739871"), '3');
+    EXPECT_EQ(DammCheckDigit("572"), '4');
+    EXPECT_TRUE(HasValidCheckDigit("79927398713", CheckDigit::Luhn));
+    EXPECT_FALSE(HasValidCheckDigit("79927398731", CheckDigit::Luhn));
+    EXPECT_TRUE(HasValidCheckDigit("5724", CheckDigit::Damm));
+    EXPECT_FALSE(HasValidCheckDigit("7524", CheckDigit::Damm));
+}
+
+TEST_F(CodeGeneratorTests, GeneratedCodesCarryValidCheckDigits)
+{
+    for (const CheckDigit scheme : { CheckDigit::Luhn, CheckDigit::Damm })
+    {
+        // given:
+        const CodeGenerator generator(8, s_NumbersChars, scheme);
+
+        // when:
+        const auto codes = generator.Generate(1000);
+
+        // then:
+        for (const auto& code : codes)
+        {
+            EXPECT_EQ(code.length(), 9);
+            EXPECT_EQ(code.find_first_not_of(s_NumbersChars), std::string::npos);
+            EXPECT_TRUE(HasValidCheckDigit(code, scheme)) << code;
+        }
+    }
+}
+
+TEST_F(CodeGeneratorTests, DigitsAreRoughlyUniform)
+{
+    // given:
+    const CodeGenerator generator(10);
+    constexpr size_t numCodes = 100000;
+    std::vector<char> packed(numCodes * generator.CodeLength());
+
+    // when:
+    generator.Fill(packed.data(), numCodes);
+
+    // then: each digit within 5% of its expected count of 100000
+    std::array<size_t, 10> counts{};
+    for (const char c : packed)
+        counts[(size_t)(c - '0')]++;
+    for (const size_t count : counts)
+        EXPECT_NEAR((double)count, 100000.0, 5000.0);
+    EXPECT_EQ(generator.CharactersPerWord(), 18);
+}
+
+TEST_F(CodeGeneratorTests, CustomAlphabetIsRespected)
+{
+    // given: an unambiguous base-31 alphabet (no 0/O, 1/I/L), which takes the generic path
+    const std::string alphabet = "23456789ABCDEFGHJKMNPQRSTUVWXYZ";
+    const CodeGenerator generator(12, alphabet);
+
+    // when:
+    const auto codes = generator.Generate(500);
+
+    // then:
+    for (const auto& code : codes)
+    {
+        EXPECT_EQ(code.length(), 12);
+        EXPECT_EQ(code.find_first_not_of(alphabet), std::string::npos);
+    }
+}
+
+TEST_F(CodeGeneratorTests, InvalidConfigurationsThrow)
+{
+    EXPECT_THROW(CodeGenerator(0), std::invalid_argument);
+    EXPECT_THROW(CodeGenerator(6, "a"), std::invalid_argument);
+    EXPECT_THROW(CodeGenerator(6, "abca"), std::invalid_argument);
+    EXPECT_THROW(CodeGenerator(6, "ABCDEF", CheckDigit::Luhn), std::invalid_argument);
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <CompiledPolicy.h>
+
+using namespace Generator;
+
+class CompiledPolicyTests : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST_F(CompiledPolicyTests, EqualPoliciesShareOneCompiledPolicy)
+{
+    // given:
+    const PasswordPolicy policy{14, true, false, true, false, "01"};
+    PasswordPolicy other = policy;
+    other.excludedCharacters = "012";
+
+    // when:
+    const auto first = CompiledPolicy::Get(policy);
+    const auto second = CompiledPolicy::Get(PasswordPolicy{14, true, false, true, false, "01"});
+    const auto third = CompiledPolicy::Get(other);
+
+    // then:
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, third);
+    EXPECT_EQ(PasswordGenerator(policy).GetCompiledPolicy(), first);
+    EXPECT_EQ(first->AdvancedAlphabet().size(), 26 + 8);
+}
+
+TEST_F(CompiledPolicyTests, HashingFieldsDontSplitTheCache)
+{
+    // given: the same characters, hashed four different ways
+    PasswordPolicy low{20, true, true, true, false, "", EncryptionStrength::Low};
+    PasswordPolicy high = low;
+    high.encryptionStrength = EncryptionStrength::High;
+    PasswordPolicy scrypt = low;
+    scrypt.hashAlgorithm = HashAlgorithm::Scrypt;
+    PasswordPolicy explicitCost = low;
+    explicitCost.hashCost = HashCost{3, 1 << 16};
+    explicitCost.useArgon2Engine = true;
+
+    // when:
+    const auto compiled = CompiledPolicy::Get(low);
+
+    // then:
+    EXPECT_EQ(HashPolicy(low), HashPolicy(high));
+    EXPECT_EQ(CompiledPolicy::Get(high), compiled);
+    EXPECT_EQ(CompiledPolicy::Get(scrypt), compiled);
+    EXPECT_EQ(CompiledPolicy::Get(explicitCost), compiled);
+    // the generator still hashes with its own policy
+    EXPECT_EQ(PasswordGenerator(high).GetPolicy().encryptionStrength, EncryptionStrength::High);
+}
+
+TEST_F(CompiledPolicyTests, CacheStaysBounded)
+{
+    // given/when:
+    for (uint64_t length = 1; length <= 1000; length++)
+        (void)CompiledPolicy::Get(PasswordPolicy{length});
+
+    // then:
+    EXPECT_LE(CompiledPolicy::CacheSize(), 256);
+}
+
+TEST_F(CompiledPolicyTests, UnusablePoliciesAreReportedUpFront)
+{
+    // given: every enabled character excluded
+    const PasswordGenerator generator(PasswordPolicy{8, false, false, true, false, "0123456789"});
+
+    // when/then:
+    EXPECT_FALSE(generator.GetCompiledPolicy()->Error().empty());
+    EXPECT_THROW((void)generator.GenerateAdvancedPassword(), std::runtime_error);
+    EXPECT_THROW((void)generator.GenerateIntermediatePassword(), std::runtime_error);
+    EXPECT_TRUE(CompiledPolicy::Get(PasswordPolicy{8})->Error().empty());
+}
+
+TEST_F(CompiledPolicyTests, IntermediatePasswordsOnlyUseAllowedCharacters)
+{
+    // given:
+    const std::string excluded = "aeiouAEIOU01!";
+    const PasswordGenerator generator(PasswordPolicy{32, true, true, true, true, excluded});
+
+    // when/then:
+    for (int i = 0; i < 200; i++)
+    {
+        const std::string password = generator.GenerateIntermediatePassword();
+        EXPECT_EQ(password.length(), 32);
+        EXPECT_EQ(password.find_first_of(excluded), std::string::npos) << password;
+        for (const char c : password)
+            EXPECT_TRUE(c >= 33 && c <= 126) << password;
+    }
+}
+
+TEST_F(CompiledPolicyTests, AdvancedCharactersAreUniform)
+{
+    // given: 10 digits don't divide 256, the rejection threshold has to even them out
+    const CompiledPolicy compiled(PasswordPolicy{1000, false, false, true, false});
+    std::array<size_t, 10> counts{};
+
+    // when:
+    std::string buffer(1000, '\0');
+    for (int i = 0; i < 200; i++)
+    {
+        compiled.FillAdvanced(buffer.data());
+        for (const char c : buffer)
+            counts[(size_t)(c - '0')]++;
+    }
+
+    // then:
+    for (const size_t count : counts)
+        EXPECT_NEAR((double)count, 20000.0, 1000.0);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include <CredentialStore.h>
+
+using namespace Generator;
+using namespace Storage;
+
+class CredentialStoreTests : public testing::Test
+{
+public:
+    PasswordGenerator passwordGenerator = PasswordGenerator(PasswordPolicy{10, true, true, true, true, "", EncryptionStrength::Low});
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST(LruCacheTests, EvictsLeastRecentlyUsed)
+{
+    // given:
+    LruCache<std::string, int> cache(2);
+    cache.Put("a", 1);
+    cache.Put("b", 2);
+
+    // when:
+    (void)cache.Get("a");   // "b" is now the oldest
+    cache.Put("c", 3);
+
+    // then:
+    EXPECT_TRUE(cache.Get("a").has_value());
+    EXPECT_FALSE(cache.Get("b").has_value()) << "Wrong entry evicted";
+    EXPECT_TRUE(cache.Get("c").has_value());
+}
+
+TEST_F(CredentialStoreTests, VerifyAccountChecksTheStoredHash)
+{
+    // given:
+    CredentialStore store(":memory:", passwordGenerator);
+    store.SetPassword("alice", "<PASSWORD1?2.3!4@hello>");
+
+    // when:
+    const bool correct = store.VerifyAccount("alice", "<PASSWORD1?2.3!4@hello>");
+    const bool wrong = store.VerifyAccount("alice", "momolleh");
+    const bool unknown = store.VerifyAccount("bob", "<PASSWORD1?2.3!4@hello>");
+
+    // then:
+    EXPECT_TRUE(correct) << "Password hash verification failed";
+    EXPECT_FALSE(wrong) << "Wrong password verified";
+    EXPECT_FALSE(unknown) << "Unknown account verified";
+}
+
+TEST_F(CredentialStoreTests, RemovedAccountsNoLongerVerify)
+{
+    // given:
+    CredentialStore store(":memory:", passwordGenerator);
+    store.SetPassword("alice", "momolleh");
+    ASSERT_TRUE(store.FindHash("alice").has_value()); // now cached
+
+    // when:
+    const bool removed = store.RemoveAccount("alice");
+
+    // then:
+    EXPECT_TRUE(removed);
+    EXPECT_FALSE(store.FindHash("alice").has_value()) << "Cache served a removed account";
+    EXPECT_EQ(store.AccountCount(), 0);
+}
+
+TEST_F(CredentialStoreTests, AuditFindsHashesFromAnOlderPolicyAcrossPages)
+{
+    // given: half the accounts hashed with scrypt, which the current argon2id policy wants replaced
+    PasswordPolicy oldPolicy{10, true, true, true, true, "", EncryptionStrength::Low};
+    oldPolicy.hashAlgorithm = HashAlgorithm::Scrypt;
+    const std::string oldHash = PasswordGenerator(oldPolicy).HashPassword("momolleh");
+    const std::string currentHash = passwordGenerator.HashPassword("momolleh");
+
+    CredentialStore store(":memory:", passwordGenerator);
+    for (int i = 0; i < 25; i++)
+        store.StoreHash("user" + std::to_string(i), i % 2 == 0 ? oldHash : currentHash);
+
+    // when:
+    std::vector<std::string> stale;
+    const size_t reported = store.AuditRehash([&stale](const std::string& accountId) { stale.push_back(accountId); }, 4);
+
+    // then:
+    EXPECT_EQ(reported, 13);
+    EXPECT_EQ(stale.size(), 13);
+    EXPECT_TRUE(std::is_sorted(stale.begin(), stale.end())) << "Audit did not walk the table in key order";
+}
+
+TEST_F(CredentialStoreTests, SuccessfulVerifyUpgradesStaleHash)
+{
+    // given:
+    PasswordPolicy oldPolicy{10, true, true, true, true, "", EncryptionStrength::Low};
+    oldPolicy.hashAlgorithm = HashAlgorithm::Scrypt;
+    CredentialStore store(":memory:", passwordGenerator);
+    store.StoreHash("alice", PasswordGenerator(oldPolicy).HashPassword("momolleh"));
+
+    // when:
+    ASSERT_TRUE(store.VerifyAccount("alice", "momolleh"));
+
+    // then:
+    const auto upgraded = store.FindHash("alice");
+    ASSERT_TRUE(upgraded.has_value());
+    EXPECT_FALSE(passwordGenerator.NeedsRehash(*upgraded)) << "Hash was not upgraded: " << *upgraded;
+    EXPECT_TRUE(store.VerifyAccount("alice", "momolleh"));
+}
+
+TEST_F(CredentialStoreTests, StoresPackedHashesAndStillReadsTextOnes)
+{
+    // given:
+    const std::string textHash = passwordGenerator.HashPassword("momolleh");
+    CredentialStore store(":memory:", passwordGenerator, CredentialStoreOptions{.cacheCapacity = 0});
+    store.SetPassword("alice", "<PASSWORD1?2.3!4@hello>");
+    CredentialStore textStore(":memory:", passwordGenerator, CredentialStoreOptions{.cacheCapacity = 0, .packHashes = false});
+    textStore.StoreHash("bob", textHash);
+
+    // when:
+    const std::optional<std::string> aliceHash = store.FindHash("alice");
+    const std::optional<std::string> bobHash = textStore.FindHash("bob");
+
+    // then:
+    ASSERT_TRUE(aliceHash.has_value());
+    EXPECT_TRUE(aliceHash->starts_with("$argon2id$")) << "FindHash() should return the encoded string";
+    EXPECT_TRUE(passwordGenerator.VerifyPassword("<PASSWORD1?2.3!4@hello>", *aliceHash));
+    EXPECT_TRUE(store.VerifyAccount("alice", "<PASSWORD1?2.3!4@hello>"));
+    EXPECT_FALSE(store.VerifyAccount("alice", "momolleh"));
+    EXPECT_EQ(bobHash, textHash);
+    EXPECT_TRUE(textStore.VerifyAccount("bob", "momolleh"));
+}
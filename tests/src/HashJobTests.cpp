@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <HashJob.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace Generator;
+
+#if !defined(_WIN32)
+class HashJobTests : public testing::Test
+{
+public:
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 ("passwordgen-job-" + std::to_string(getpid()) + ".journal");
+    PasswordGenerator generator = PasswordGenerator(PasswordPolicy{10, true, true, true, true, "", EncryptionStrength::Low});
+    std::vector<std::string> passwords;
+
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+        std::filesystem::remove(path);
+        passwords = generator.GenerateAdvancedPasswords(10);
+    }
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+};
+
+TEST_F(HashJobTests, HashesEveryPasswordInOrder)
+{
+    // given:
+    HashJob job(generator, path.string(), HashJobOptions{3, 2});
+    std::vector<uint64_t> progress;
+
+    // when:
+    const size_t hashed = job.Run(passwords, [&](uint64_t done, uint64_t total)
+    {
+        EXPECT_EQ(total, 4);
+        progress.push_back(done);
+    });
+
+    // then:
+    EXPECT_EQ(hashed, 4);
+    EXPECT_EQ(progress, (std::vector<uint64_t>{1, 2, 3, 4}));
+    const std::vector<std::string> hashes = job.Results();
+    ASSERT_EQ(hashes.size(), passwords.size());
+    for (size_t i = 0; i < passwords.size(); i++)
+        EXPECT_TRUE(generator.VerifyPassword(passwords[i], hashes[i]));
+    EXPECT_EQ(job.Run(passwords), 0);
+}
+
+TEST_F(HashJobTests, ResumesAfterAnInterruptedRun)
+{
+    // given: a run that dies after two chunks are durable
+    HashJob job(generator, path.string(), HashJobOptions{3, 1});
+    EXPECT_THROW(job.Run(passwords, [](uint64_t done, uint64_t)
+    {
+        if (done == 2)
+            throw std::runtime_error("killed");
+    }), std::runtime_error);
+    EXPECT_THROW((void)job.Results(), std::runtime_error);
+    std::ifstream before(path, std::ios::binary);
+    const std::string partial(std::istreambuf_iterator<char>(before), {});
+
+    // when:
+    const size_t hashed = HashJob(generator, path.string(), HashJobOptions{3, 1}).Run(passwords);
+
+    // then:
+    EXPECT_EQ(hashed, 2);
+    std::ifstream file(path, std::ios::binary);
+    const std::string journal(std::istreambuf_iterator<char>(file), {});
+    // the finished chunks' hashes are kept as they were
+    EXPECT_EQ(journal.compare(0, partial.size(), partial), 0);
+    const std::vector<std::string> hashes = job.Results();
+    for (size_t i = 0; i < passwords.size(); i++)
+        EXPECT_TRUE(generator.VerifyPassword(passwords[i], hashes[i]));
+}
+
+TEST_F(HashJobTests, TornRecordIsDiscarded)
+{
+    // given: a finished chunk followed by half a record
+    HashJob job(generator, path.string(), HashJobOptions{5, 1});
+    EXPECT_THROW(job.Run(passwords, [](uint64_t, uint64_t) { throw std::runtime_error("killed"); }), std::runtime_error);
+    const uintmax_t validSize = std::filesystem::file_size(path);
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::app);
+        file << std::string("\x40\x00\x00\x00partial", 11);
+    }
+
+    // when:
+    const size_t hashed = job.Run(passwords);
+
+    // then:
+    EXPECT_EQ(hashed, 1);
+    EXPECT_GT(std::filesystem::file_size(path), validSize);
+    const std::vector<std::string> hashes = job.Results();
+    for (size_t i = 0; i < passwords.size(); i++)
+        EXPECT_TRUE(generator.VerifyPassword(passwords[i], hashes[i]));
+}
+
+TEST_F(HashJobTests, JournalOfAnotherInputIsRejected)
+{
+    // given:
+    HashJob(generator, path.string(), HashJobOptions{4, 1}).Run(passwords);
+
+    // when/then:
+    std::vector<std::string> other = passwords;
+    other.back() += "x";
+    EXPECT_THROW(HashJob(generator, path.string(), HashJobOptions{4, 1}).Run(other), std::invalid_argument);
+    EXPECT_THROW(HashJob(generator, path.string(), HashJobOptions{5, 1}).Run(passwords), std::invalid_argument);
+    EXPECT_THROW(HashJob(generator, path.string(), HashJobOptions{0, 1}), std::invalid_argument);
+}
+
+TEST_F(HashJobTests, InputOfTheSameShapeIsRejected)
+{
+    // given: the fingerprint only covers the password lengths
+    HashJob(generator, path.string(), HashJobOptions{4, 1}).Run(passwords);
+
+    // when/then: the journaled hashes don't match the new passwords
+    std::vector<std::string> other = generator.GenerateAdvancedPasswords(passwords.size());
+    EXPECT_THROW(HashJob(generator, path.string(), HashJobOptions{4, 1}).Run(other), std::invalid_argument);
+}
+
+TEST_F(HashJobTests, ChunksLargerThanAFrameAreRejected)
+{
+    // given: argon2id hash strings take about 100 bytes each, so a million of them can't be one frame
+    const HashJobOptions options{1000000, 1};
+
+    // when/then:
+    EXPECT_THROW(HashJob(generator, path.string(), options), std::invalid_argument);
+    EXPECT_NO_THROW(HashJob(generator, path.string(), HashJobOptions{100000, 1}));
+}
+#endif
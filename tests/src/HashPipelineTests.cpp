@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <HashPipeline.h>
+#include <MpmcQueue.h>
+
+#include <atomic>
+#include <mutex>
+#include <set>
+
+using namespace Generator;
+
+TEST(BoundedMpmcQueueTests, PushFailsWhenFullAndPopFailsWhenEmpty)
+{
+    // given:
+    BoundedMpmcQueue<int> queue(3); // rounded up to 4
+
+    // when:
+    int pushed = 0;
+    for (int value = 0; value < 10; value++)
+    {
+        int item = value;
+        if (queue.TryPush(item))
+            pushed++;
+    }
+
+    // then:
+    EXPECT_EQ(pushed, 4);
+    int popped;
+    for (int expected = 0; expected < 4; expected++)
+    {
+        ASSERT_TRUE(queue.TryPop(popped));
+        EXPECT_EQ(popped, expected) << "Queue is not FIFO";
+    }
+    EXPECT_FALSE(queue.TryPop(popped));
+}
+
+TEST(BoundedMpmcQueueTests, ConcurrentProducersAndConsumersSeeEveryItemOnce)
+{
+    // given:
+    BoundedMpmcQueue<int> queue(16);
+    constexpr int producers = 3;
+    constexpr int perProducer = 20000;
+    std::atomic<bool> abort = false;
+    std::atomic<int> consumed = 0;
+    std::vector<std::atomic<int>> seen(producers * perProducer);
+
+    // when:
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < perProducer; i++)
+            {
+                int item = p * perProducer + i;
+                queue.Push(item, abort);
+            }
+        });
+    }
+    for (int c = 0; c < 2; c++)
+    {
+        threads.emplace_back([&]() {
+            int item;
+            while (consumed < producers * perProducer)
+            {
+                if (queue.TryPop(item))
+                {
+                    seen[item]++;
+                    consumed++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    // then:
+    for (const auto& count : seen)
+    {
+        EXPECT_EQ(count, 1);
+    }
+}
+
+class HashPipelineTests : public testing::Test
+{
+public:
+    PasswordGenerator passwordGenerator = PasswordGenerator(PasswordPolicy{10, true, true, true, true, "cAde", EncryptionStrength::Low});
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST_F(HashPipelineTests, EveryGeneratedPasswordIsHashedOnce)
+{
+    // given:
+    constexpr size_t nPasswords = 200;
+    const HashPipeline pipeline(passwordGenerator, PipelineOptions{2, 2, 8});
+
+    // when:
+    std::mutex mutex;
+    std::set<size_t> indices;
+    bool allVerified = true;
+    pipeline.Run(nPasswords, [&](size_t index, const std::string& password, const std::string& hash) {
+        const bool verified = passwordGenerator.VerifyPassword(password, hash);
+        std::lock_guard lock(mutex);
+        indices.insert(index);
+        allVerified = allVerified && verified;
+    });
+
+    // then:
+    EXPECT_EQ(indices.size(), nPasswords);
+    EXPECT_TRUE(allVerified) << "Password hash verification failed";
+}
+
+TEST_F(HashPipelineTests, SinkErrorsAreRethrown)
+{
+    // given:
+    const HashPipeline pipeline(passwordGenerator, PipelineOptions{1, 2, 16});
+    std::atomic<size_t> calls = 0;
+
+    // when/then:
+    EXPECT_THROW(pipeline.Run(50, [&](size_t, const std::string&, const std::string&)
+    {
+        calls++;
+        throw std::runtime_error("sink failed");
+    }), std::runtime_error);
+    // the queued passwords aren't hashed after the first error, each hasher finishes at most the one it holds
+    EXPECT_LE(calls, 2);
+}
+
+TEST_F(HashPipelineTests, GenerateHashesReturnsOneHashPerPassword)
+{
+    const auto hashes = HashPipeline(passwordGenerator).GenerateHashes(25);
+    ASSERT_EQ(hashes.size(), 25);
+    for (const auto& hash : hashes)
+    {
+        EXPECT_TRUE(hash.starts_with("$argon2id$"));
+    }
+}
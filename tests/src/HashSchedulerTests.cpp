@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <HashScheduler.h>
+
+using namespace Generator;
+
+class HashSchedulerTests : public testing::Test
+{
+public:
+    PasswordGenerator passwordGenerator = PasswordGenerator(PasswordPolicy{10, true, true, true, true, "", EncryptionStrength::Low});
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST_F(HashSchedulerTests, InteractiveVerifyMatchesBulkHash)
+{
+    // given:
+    HashScheduler scheduler(passwordGenerator);
+    const std::string password = "<PASSWORD1?2.3!4@hello>";
+
+    // when:
+    const std::string hash = scheduler.SubmitHash(password).get();
+    const bool matches = scheduler.SubmitVerify(password, hash).get();
+    const bool wrongMatches = scheduler.SubmitVerify("not the password", hash).get();
+
+    // then:
+    EXPECT_TRUE(matches) << "Password hash verification failed";
+    EXPECT_FALSE(wrongMatches) << "Wrong password verified";
+}
+
+TEST_F(HashSchedulerTests, HashPasswordsSafeAsyncKeepsOrder)
+{
+    // given:
+    const std::vector<std::string> passwords = { "<PASSWORD1?2.3!4@hello>", "saidjsad2813", "8213217328sdhjahdlasjlcjxz9", "asSADIJnmSD8299>.", "momolleh" };
+    SchedulerOptions options;
+    options.bulk = {2, 1}; // tiny queue, forces the submitter to wait for room
+    HashScheduler scheduler(passwordGenerator, options);
+
+    // when:
+    const auto hashes = scheduler.HashPasswordsSafeAsync(passwords).get();
+
+    // then:
+    ASSERT_EQ(hashes.size(), passwords.size());
+    for (size_t i = 0; i < passwords.size(); i++)
+    {
+        EXPECT_TRUE(passwordGenerator.VerifyPasswordSafe(passwords[i], hashes[i])) << "Password hash verification failed";
+    }
+}
+
+TEST_F(HashSchedulerTests, BulkJobsCannotUseTheInteractiveReserve)
+{
+    // given: the whole budget is reserved for interactive work
+    SchedulerOptions options;
+    options.memoryBudgetBytes = crypto_pwhash_MEMLIMIT_MIN;
+    options.interactiveReserveBytes = crypto_pwhash_MEMLIMIT_MIN;
+    HashScheduler scheduler(passwordGenerator, options);
+
+    // when:
+    auto bulkHash = scheduler.SubmitHash("momolleh", JobPriority::Bulk);
+    auto interactiveHash = scheduler.SubmitHash("momolleh", JobPriority::Interactive);
+
+    // then:
+    EXPECT_THROW(bulkHash.get(), std::invalid_argument);
+    EXPECT_NO_THROW(interactiveHash.get());
+}
+
+TEST_F(HashSchedulerTests, RateLimitedBulkJobsStillComplete)
+{
+    // given:
+    SchedulerOptions options;
+    options.bulkJobsPerSecond = 100.0;
+    HashScheduler scheduler(passwordGenerator, options);
+
+    // when:
+    const auto start = std::chrono::steady_clock::now();
+    const auto hashes = scheduler.HashPasswordsSafeAsync({ "a1", "b2", "c3", "d4", "e5" }).get();
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    // then: the first job uses the initial token, the other four wait ~10ms each
+    EXPECT_EQ(hashes.size(), 5);
+    EXPECT_GE(elapsed, std::chrono::milliseconds(35));
+}
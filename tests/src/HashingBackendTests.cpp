@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <Generator.h>
+
+using namespace Generator;
+
+class HashingBackendTests : public testing::TestWithParam<HashAlgorithm>
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST_P(HashingBackendTests, HashesVerifyThroughPrefixDispatch)
+{
+    // given:
+    PasswordPolicy policy{10, true, true, true, true, "", EncryptionStrength::Low};
+    policy.hashAlgorithm = GetParam();
+    const PasswordGenerator passwordGenerator(policy);
+    const std::string password = "<PASSWORD1?2.3!4@hello>";
+
+    // when:
+    const std::string hash = passwordGenerator.HashPassword(password);
+
+    // then:
+    EXPECT_TRUE(hash.starts_with(GetHashingBackend(GetParam()).Prefix())) << "Hash has the wrong prefix: " << hash;
+    EXPECT_TRUE(passwordGenerator.VerifyPasswordSafe(password, hash)) << "Password hash verification failed";
+    EXPECT_FALSE(passwordGenerator.VerifyPassword("wrong password", hash)) << "Wrong password verified";
+    EXPECT_FALSE(passwordGenerator.NeedsRehash(hash)) << "Fresh hash reported as stale";
+    EXPECT_GT(MemoryCostOfHash(hash), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(AllBackends, HashingBackendTests,
+                         testing::Values(HashAlgorithm::Argon2id, HashAlgorithm::Argon2i, HashAlgorithm::Scrypt));
+
+TEST(HashingBackendSelectionTests, HashesFromAnotherAlgorithmStillVerifyButNeedRehash)
+{
+    // given:
+    PasswordPolicy scryptPolicy{10, true, true, true, true, "", EncryptionStrength::Low};
+    scryptPolicy.hashAlgorithm = HashAlgorithm::Scrypt;
+    const std::string hash = PasswordGenerator(scryptPolicy).HashPassword("momolleh");
+
+    // when:
+    const PasswordGenerator argonGenerator(PasswordPolicy{10, true, true, true, true, "", EncryptionStrength::Low});
+
+    // then:
+    EXPECT_TRUE(argonGenerator.VerifyPassword("momolleh", hash));
+    EXPECT_TRUE(argonGenerator.NeedsRehash(hash)) << "Algorithm change not detected";
+}
+
+TEST(HashingBackendSelectionTests, ExplicitArgon2CostIsUsed)
+{
+    // given:
+    PasswordPolicy policy;
+    policy.hashCost = HashCost{3, 16 * 1024 * 1024};
+
+    // when:
+    const std::string hash = PasswordGenerator(policy).HashPassword("momolleh");
+
+    // then:
+    EXPECT_NE(hash.find("$m=16384,t=3,p=1$"), std::string::npos) << hash;
+    EXPECT_EQ(MemoryCostOfHash(hash), 16 * 1024 * 1024);
+}
+
+TEST(HashingBackendSelectionTests, CraftedCostsSaturateInsteadOfWrapping)
+{
+    // given: scrypt N = 2^14, r = 8, and costs far beyond what a size_t holds
+    const std::string scrypt = "$7$C6..../....salt$hash";
+    const std::string hugeScrypt = "$7$zzzzzz/....salt$hash";
+    const std::string hugeArgon2 = "$argon2id$v=19$m=999999999999999999999999,t=2,p=1$salt$hash";
+
+    // when/then:
+    EXPECT_EQ(MemoryCostOfHash(scrypt), 16 * 1024 * 1024);
+    EXPECT_EQ(MemoryCostOfHash(hugeScrypt), SIZE_MAX);
+    EXPECT_EQ(MemoryCostOfHash(hugeArgon2), SIZE_MAX);
+    EXPECT_EQ(ScryptMemoryCost(1, 56), (size_t)1 << 63);
+    EXPECT_EQ(ScryptMemoryCost(2, 56), SIZE_MAX);
+}
+
+TEST(HashingBackendSelectionTests, MultipleLanesAreRejectedByLibsodiumBackends)
+{
+    PasswordPolicy policy;
+    policy.hashCost = HashCost{crypto_pwhash_OPSLIMIT_MIN, crypto_pwhash_MEMLIMIT_MIN, 4};
+    EXPECT_THROW((void)PasswordGenerator(policy).HashPassword("momolleh"), std::invalid_argument);
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <MemoryBudget.h>
+
+#include <future>
+
+using namespace Generator;
+
+TEST(MemoryBudgetTests, ReservationsAreReturnedWhenReleased)
+{
+    // given:
+    MemoryBudget budget(1024);
+
+    // when:
+    {
+        auto reservation = budget.Acquire(1000);
+        EXPECT_EQ(budget.InUse(), 1000);
+    }
+
+    // then:
+    EXPECT_EQ(budget.InUse(), 0) << "Reservation was not released on destruction";
+}
+
+TEST(MemoryBudgetTests, TryAcquireFailsWhenBudgetIsExhausted)
+{
+    // given:
+    MemoryBudget budget(1024);
+    auto first = budget.Acquire(800);
+
+    // when:
+    auto second = budget.TryAcquire(800);
+
+    // then:
+    EXPECT_FALSE(second) << "Budget was overcommitted";
+    EXPECT_EQ(budget.InUse(), 800);
+}
+
+TEST(MemoryBudgetTests, AcquireWaitsForReleasedMemory)
+{
+    // given:
+    MemoryBudget budget(1024);
+    auto first = budget.Acquire(1024);
+
+    // when:
+    auto waiter = std::async(std::launch::async, [&budget]() { return budget.Acquire(512).Bytes(); });
+    EXPECT_EQ(waiter.wait_for(std::chrono::milliseconds(50)), std::future_status::timeout) << "Acquire did not block";
+    first.Release();
+
+    // then:
+    EXPECT_EQ(waiter.get(), 512);
+}
+
+TEST(MemoryBudgetTests, AcquireRejectsRequestsLargerThanTheBudget)
+{
+    MemoryBudget budget(1024);
+    EXPECT_THROW((void)budget.Acquire(2048), std::invalid_argument);
+}
@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include <Generator.h>
+#include <PackedHash.h>
+
+using namespace Generator;
+
+class PackedHashTests : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+
+    static std::string HashWith(HashAlgorithm algorithm, const std::string& password)
+    {
+        const HashingBackend& backend = GetHashingBackend(algorithm);
+        return backend.Hash(password, backend.CostFor(EncryptionStrength::Low));
+    }
+};
+
+TEST_F(PackedHashTests, RoundTripsEveryAlgorithmLosslessly)
+{
+    for (const HashAlgorithm algorithm : {HashAlgorithm::Argon2id, HashAlgorithm::Argon2i, HashAlgorithm::Scrypt})
+    {
+        // given:
+        const std::string encoded = HashWith(algorithm, "momolleh");
+
+        // when:
+        const PackedHash packed = PackedHash::FromString(encoded);
+        const PackedHash unpacked = PackedHash::FromBytes(packed.ToBytes());
+
+        // then:
+        EXPECT_EQ(packed.algorithm, algorithm);
+        EXPECT_EQ(unpacked, packed);
+        EXPECT_EQ(unpacked.ToString(), encoded);
+        EXPECT_EQ(unpacked.MemoryCost(), MemoryCostOfHash(encoded));
+        EXPECT_LT(packed.ToBytes().size(), encoded.size() * 3 / 4) << encoded;
+    }
+}
+
+TEST_F(PackedHashTests, DecodesArgon2Parameters)
+{
+    // given:
+    const std::string encoded = "$argon2id$v=19$m=65536,t=2,p=1$c29tZXNhbHRzb21lc2FsdA$"
+                                "Y3VVdLuR/JEvUJ8UTiiqHYlZYHSrBrSvj4Y4RUGKAUQ";
+
+    // when:
+    const PackedHash packed = PackedHash::FromString(encoded);
+
+    // then:
+    EXPECT_EQ(packed.version, 19);
+    EXPECT_EQ(packed.memoryCost, 65536);
+    EXPECT_EQ(packed.timeCost, 2);
+    EXPECT_EQ(packed.parallelism, 1);
+    EXPECT_EQ(std::string(packed.salt.begin(), packed.salt.end()), "somesaltsomesalt");
+    EXPECT_EQ(packed.tag.size(), 32);
+    EXPECT_EQ(packed.ToBytes().size(), 58);
+}
+
+TEST_F(PackedHashTests, VerifiesFromTheBinaryForm)
+{
+    for (const HashAlgorithm algorithm : {HashAlgorithm::Argon2id, HashAlgorithm::Argon2i, HashAlgorithm::Scrypt})
+    {
+        // given:
+        const std::vector<uint8_t> bytes = PackedHash::FromString(HashWith(algorithm, "<PASSWORD1?2.3!4@hello>")).ToBytes();
+
+        // when:
+        const PackedHash packed = PackedHash::FromBytes(bytes);
+
+        // then:
+        EXPECT_TRUE(packed.Verify("<PASSWORD1?2.3!4@hello>")) << "Password hash verification failed";
+        EXPECT_FALSE(packed.Verify("momolleh")) << "Wrong password verified";
+    }
+}
+
+TEST_F(PackedHashTests, RejectsMalformedInput)
+{
+    // given:
+    const std::string encoded = HashWith(HashAlgorithm::Argon2id, "momolleh");
+    std::vector<uint8_t> bytes = PackedHash::FromString(encoded).ToBytes();
+    std::string leadingZero = encoded;
+    leadingZero.replace(leadingZero.find("t="), 2, "t=0");
+
+    // when/then:
+    EXPECT_THROW((void)PackedHash::FromString("plaintext"), std::invalid_argument);
+    EXPECT_THROW((void)PackedHash::FromString(encoded.substr(0, 30)), std::invalid_argument);
+    EXPECT_THROW((void)PackedHash::FromString(leadingZero), std::invalid_argument) << "Non-canonical hash accepted";
+    EXPECT_THROW((void)PackedHash::FromBytes(bytes.data(), bytes.size() - 1), std::invalid_argument);
+    bytes.push_back(0);
+    EXPECT_THROW((void)PackedHash::FromBytes(bytes), std::invalid_argument) << "Trailing byte accepted";
+    bytes.pop_back();
+    bytes[1] = 9;
+    EXPECT_THROW((void)PackedHash::FromBytes(bytes), std::invalid_argument) << "Unknown algorithm accepted";
+}
@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <PasswordFile.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace Generator;
+
+#if !defined(_WIN32)
+class PasswordFileTests : public testing::Test
+{
+public:
+    std::filesystem::path path = std::filesystem::temp_directory_path() /
+                                 ("passwordgen-file-" + std::to_string(getpid()) + ".txt");
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+        std::filesystem::remove(path);
+    }
+    void TearDown() override
+    {
+        std::filesystem::remove(path);
+    }
+};
+
+TEST_F(PasswordFileTests, WritesOnePasswordPerLine)
+{
+    // given:
+    const PasswordGenerator generator(PasswordPolicy{12, true, true, true, false, "0Oo"});
+
+    // when:
+    WritePasswordFile(generator, path.string(), 10001, PasswordFileOptions{3});
+
+    // then:
+    EXPECT_EQ(std::filesystem::file_size(path), 10001 * 13);
+    std::ifstream file(path);
+    std::string line;
+    size_t lines = 0;
+    while (std::getline(file, line))
+    {
+        lines++;
+        ASSERT_EQ(line.length(), 12);
+        EXPECT_EQ(line.find_first_of("0Oo"), std::string::npos);
+        EXPECT_EQ(line.find_first_of(s_SymbolsChars), std::string::npos);
+    }
+    EXPECT_EQ(lines, 10001);
+}
+
+TEST_F(PasswordFileTests, ExistingFilesAreKeptUnlessOverwriting)
+{
+    // given:
+    const PasswordGenerator generator(PasswordPolicy{8});
+    WritePasswordFile(generator, path.string(), 10);
+
+    // when/then:
+    EXPECT_THROW(WritePasswordFile(generator, path.string(), 20), std::runtime_error);
+    EXPECT_EQ(std::filesystem::file_size(path), 10 * 9);
+    PasswordFileOptions options;
+    options.overwrite = true;
+    WritePasswordFile(generator, path.string(), 20, options);
+    EXPECT_EQ(std::filesystem::file_size(path), 20 * 9);
+}
+
+TEST_F(PasswordFileTests, UnusablePolicyCreatesNoFile)
+{
+    // given:
+    const PasswordGenerator generator(PasswordPolicy{8, false, false, false, false});
+
+    // when/then:
+    EXPECT_THROW(WritePasswordFile(generator, path.string(), 10), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+#endif
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+
+#include <PasswordPool.h>
+
+#include <set>
+
+using namespace Generator;
+
+class PasswordPoolTests : public testing::Test
+{
+public:
+    PasswordPolicy policy = PasswordPolicy{12, true, true, true, true, "cAde", EncryptionStrength::Low};
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+
+    static void WaitForStock(const PasswordPool& pool, size_t size)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (pool.Size() < size && std::chrono::steady_clock::now() < deadline)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+};
+
+TEST_F(PasswordPoolTests, IssuedPairsVerifyAndFollowPolicy)
+{
+    // given:
+    PasswordPool pool(policy, PoolOptions{16});
+    WaitForStock(pool, 16);
+    const PasswordGenerator verifier(policy);
+
+    // when:
+    std::set<std::string> passwords;
+    for (int i = 0; i < 16; i++)
+    {
+        const auto [password, hash] = pool.Issue();
+        EXPECT_EQ(password.length(), policy.passwordLength);
+        EXPECT_TRUE(verifier.VerifyPassword(password, hash)) << "Password hash verification failed";
+        passwords.insert(password);
+    }
+
+    // then:
+    EXPECT_EQ(passwords.size(), 16) << "Pool handed out the same password twice";
+    EXPECT_EQ(pool.Misses(), 0) << "A pool with stock fell back to inline generation";
+}
+
+TEST_F(PasswordPoolTests, CapacityIsRoundedToPowerOfTwoAndNeverExceeded)
+{
+    // given:
+    PasswordPool pool(policy, PoolOptions{5});
+
+    // when:
+    WaitForStock(pool, 8);
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    // then:
+    EXPECT_EQ(pool.Capacity(), 8);
+    EXPECT_EQ(pool.Size(), 8);
+}
+
+TEST_F(PasswordPoolTests, ConcurrentIssuersGetDistinctPairs)
+{
+    // given:
+    PasswordPool pool(policy, PoolOptions{64, 0, 2});
+    constexpr int threads = 4;
+    constexpr int perThread = 50;
+
+    // when:
+    std::vector<std::future<std::vector<std::string>>> issued;
+    for (int t = 0; t < threads; t++)
+    {
+        issued.push_back(std::async(std::launch::async, [&pool]() {
+            std::vector<std::string> hashes;
+            for (int i = 0; i < perThread; i++)
+                hashes.push_back(std::get<1>(pool.Issue()));
+            return hashes;
+        }));
+    }
+
+    // then:
+    std::set<std::string> hashes;
+    for (auto& result : issued)
+    {
+        for (auto& hash : result.get())
+            hashes.insert(hash);
+    }
+    EXPECT_EQ(hashes.size(), threads * perThread) << "A pair was issued twice";
+}
+
+TEST_F(PasswordPoolTests, UnusablePolicyIsRejectedUpFront)
+{
+    // given:
+    PasswordPolicy unusable = policy;
+    unusable.requireLowercase = unusable.requireUppercase = unusable.requireNumbers = unusable.requireSymbols = false;
+
+    // when/then:
+    EXPECT_THROW(PasswordPool(unusable, PoolOptions{4}), std::invalid_argument);
+}
+
+TEST_F(PasswordPoolTests, RefillFailureReachesTheIssuerInsteadOfTerminating)
+{
+    // given: a cost libsodium's argon2 refuses, so every hash throws
+    PasswordPolicy failing = policy;
+    failing.hashCost = HashCost{1, 8192, 2};
+    PasswordPool pool(failing, PoolOptions{4});
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    // when/then: the refill thread's error or the inline fallback's surfaces here
+    EXPECT_THROW((void)pool.Issue(), std::invalid_argument);
+    EXPECT_THROW((void)pool.Issue(), std::invalid_argument);
+    EXPECT_EQ(pool.Size(), 0);
+}
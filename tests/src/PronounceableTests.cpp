@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <Generator.h>
+#include <Pronounceable.h>
+
+#include <cmath>
+
+using namespace Generator;
+
+class PronounceableTests : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST_F(PronounceableTests, AliasTableSamplesExactProportions)
+{
+    // given: weights 1:2:3:0:6 over 5 outcomes, every draw in the range enumerated once
+    constexpr AliasTable<5> table(std::array<uint32_t, 5>{ 1, 2, 3, 0, 6 });
+    std::array<uint64_t, 5> counts{};
+
+    // when:
+    for (uint64_t draw = 0; draw < table.Range(); draw++)
+        counts[table.Sample(draw)]++;
+
+    // then: the draws split exactly by weight
+    EXPECT_EQ(counts[0], 5 * 1);
+    EXPECT_EQ(counts[1], 5 * 2);
+    EXPECT_EQ(counts[2], 5 * 3);
+    EXPECT_EQ(counts[3], 0);
+    EXPECT_EQ(counts[4], 5 * 6);
+}
+
+TEST_F(PronounceableTests, ReportedEntropyMatchesTheModel)
+{
+    // given:
+    const PasswordGenerator generator(PasswordPolicy{14});
+
+    for (int i = 0; i < 100; i++)
+    {
+        // when:
+        const auto [password, entropy] = generator.GeneratePronounceablePassword();
+
+        // then:
+        EXPECT_EQ(password.length(), 14);
+        EXPECT_EQ(password.find_first_not_of(s_LowerCaseChars), std::string::npos);
+        EXPECT_DOUBLE_EQ(entropy, PronounceableModel::English().Entropy(password));
+        EXPECT_GT(entropy, 0);
+        EXPECT_LT(entropy, 14 * std::log2(26.0));
+    }
+}
+
+TEST_F(PronounceableTests, ExcludedLettersNeverAppear)
+{
+    // given:
+    const PasswordGenerator generator(PasswordPolicy{20, true, true, true, true, "etaoin"});
+
+    // when/then:
+    for (int i = 0; i < 100; i++)
+    {
+        const auto [password, entropy] = generator.GeneratePronounceablePassword();
+        EXPECT_EQ(password.find_first_of("etaoin"), std::string::npos) << password;
+        EXPECT_TRUE(std::isfinite(entropy));
+    }
+}
+
+TEST_F(PronounceableTests, ImpossiblePasswordsHaveInfiniteEntropy)
+{
+    // given: 'q' is followed only by a handful of letters in the model
+    const PronounceableModel& model = PronounceableModel::English();
+
+    // when/then:
+    EXPECT_TRUE(std::isinf(model.Entropy("qz")));
+    EXPECT_TRUE(std::isinf(model.Entropy("Abc")));
+    EXPECT_THROW((void)model.Without(s_LowerCaseChars), std::runtime_error);
+}
@@ -0,0 +1,145 @@
+#include <gtest/gtest.h>
+
+#include <ShardedCredentialStore.h>
+
+#include <filesystem>
+#include <set>
+#include <thread>
+
+using namespace Generator;
+using namespace Storage;
+
+class ShardedCredentialStoreTests : public testing::Test
+{
+public:
+    PasswordGenerator passwordGenerator = PasswordGenerator(PasswordPolicy{10, true, true, true, true, "", EncryptionStrength::Low});
+    std::filesystem::path directory = std::filesystem::temp_directory_path() /
+                                      ("passwordgen-shards-" + std::to_string(getpid()));
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+        std::filesystem::remove_all(directory);
+    }
+    void TearDown() override
+    {
+        std::filesystem::remove_all(directory);
+    }
+};
+
+TEST_F(ShardedCredentialStoreTests, SpreadsAccountsOverShardFiles)
+{
+    // given:
+    ShardedCredentialStore store(directory.string(), passwordGenerator, ShardedCredentialStoreOptions{4});
+    const std::string hash = passwordGenerator.HashPassword("momolleh");
+
+    // when:
+    for (int i = 0; i < 200; i++)
+        store.StoreHash("user" + std::to_string(i), hash);
+
+    // then: queued writes are visible before they are committed
+    EXPECT_EQ(store.FindHash("user7"), hash);
+    EXPECT_EQ(store.AccountCount(), 200);
+    std::set<size_t> usedShards;
+    for (int i = 0; i < 200; i++)
+        usedShards.insert(store.ShardOf("user" + std::to_string(i)));
+    EXPECT_EQ(usedShards.size(), 4);
+    EXPECT_EQ(store.ShardOf("alice"), 3) << "Account placement must not change between builds";
+    for (size_t i = 0; i < 4; i++)
+        EXPECT_TRUE(std::filesystem::exists(directory / ("credentials-" + std::to_string(i) + ".db")));
+    EXPECT_TRUE(store.VerifyAccount("user199", "momolleh"));
+    EXPECT_FALSE(store.VerifyAccount("user199", "hello"));
+    EXPECT_FALSE(store.VerifyAccount("nobody", "momolleh"));
+}
+
+TEST_F(ShardedCredentialStoreTests, ConcurrentWritersAreAllCommitted)
+{
+    // given:
+    ShardedCredentialStoreOptions options;
+    options.shards = 3;
+    options.maxBatchSize = 16;
+    options.maxQueueDepth = 8; // writers have to wait for the shards
+    ShardedCredentialStore store(directory.string(), passwordGenerator, options);
+    const std::string hash = passwordGenerator.HashPassword("momolleh");
+
+    // when:
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            for (int i = 0; i < 250; i++)
+                store.StoreHash("t" + std::to_string(t) + "-" + std::to_string(i), hash);
+        });
+    }
+    for (std::thread& thread : threads)
+        thread.join();
+    store.Flush();
+
+    // then:
+    std::set<std::string> seen;
+    const size_t visited = store.Scan([&](const std::string& accountId, const std::string& stored)
+    {
+        seen.insert(accountId);
+        EXPECT_EQ(stored, hash);
+    }, 64);
+    EXPECT_EQ(visited, 1000);
+    EXPECT_EQ(seen.size(), 1000);
+}
+
+TEST_F(ShardedCredentialStoreTests, LastWriteOfAnAccountWins)
+{
+    // given:
+    ShardedCredentialStore store(directory.string(), passwordGenerator, ShardedCredentialStoreOptions{2});
+    store.SetPassword("alice", "first");
+    store.SetPassword("alice", "second");
+    store.SetPassword("bob", "momolleh");
+
+    // when:
+    store.RemoveAccount("bob");
+
+    // then:
+    EXPECT_FALSE(store.FindHash("bob").has_value());
+    EXPECT_TRUE(store.VerifyAccount("alice", "second"));
+    store.Flush();
+    EXPECT_FALSE(store.VerifyAccount("alice", "first"));
+    EXPECT_FALSE(store.FindHash("bob").has_value());
+    EXPECT_EQ(store.AccountCount(), 1);
+}
+
+TEST_F(ShardedCredentialStoreTests, ReopensOnlyWithTheSameShardCount)
+{
+    // given:
+    {
+        ShardedCredentialStore store(directory.string(), passwordGenerator, ShardedCredentialStoreOptions{4});
+        store.SetPassword("alice", "momolleh");
+    } // the destructor commits the queued write
+
+    // when/then:
+    EXPECT_THROW(ShardedCredentialStore(directory.string(), passwordGenerator, ShardedCredentialStoreOptions{2}),
+                 std::invalid_argument);
+    ShardedCredentialStore store(directory.string(), passwordGenerator, ShardedCredentialStoreOptions{4});
+    EXPECT_TRUE(store.VerifyAccount("alice", "momolleh"));
+}
+
+TEST_F(ShardedCredentialStoreTests, AuditScansEveryShard)
+{
+    // given: a third of the accounts hashed with scrypt, which the current argon2id policy wants replaced
+    PasswordPolicy oldPolicy{10, true, true, true, true, "", EncryptionStrength::Low};
+    oldPolicy.hashAlgorithm = HashAlgorithm::Scrypt;
+    const std::string oldHash = PasswordGenerator(oldPolicy).HashPassword("momolleh");
+    const std::string currentHash = passwordGenerator.HashPassword("momolleh");
+    ShardedCredentialStore store(directory.string(), passwordGenerator, ShardedCredentialStoreOptions{4});
+    for (int i = 0; i < 30; i++)
+        store.StoreHash("user" + std::to_string(i), i % 3 == 0 ? oldHash : currentHash);
+
+    // when:
+    std::set<std::string> stale;
+    const size_t reported = store.AuditRehash([&stale](const std::string& accountId) { stale.insert(accountId); }, 3);
+
+    // then:
+    EXPECT_EQ(reported, 10);
+    EXPECT_EQ(stale.size(), 10);
+    EXPECT_TRUE(stale.contains("user0"));
+    EXPECT_TRUE(stale.contains("user27"));
+}
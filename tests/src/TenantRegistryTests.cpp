@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <TenantRegistry.h>
+
+#include <thread>
+
+using namespace Generator;
+
+class TenantRegistryTests : public testing::Test
+{
+public:
+    TenantRegistry registry;
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST_F(TenantRegistryTests, EachTenantGeneratesWithItsOwnPolicy)
+{
+    // given:
+    registry.SetTenantPolicies({
+        { "digits", PasswordPolicy{6, false, false, true, false, "", EncryptionStrength::Low} },
+        { "letters", PasswordPolicy{20, true, false, false, false, "", EncryptionStrength::Low} },
+    });
+
+    // when:
+    const std::string pin = registry.GenerateAdvancedPassword("digits");
+    const std::string word = registry.GenerateAdvancedPassword("letters");
+    const auto [password, hash] = registry.GenerateHashedPassword("digits");
+
+    // then:
+    EXPECT_EQ(registry.TenantCount(), 2);
+    EXPECT_EQ(pin.length(), 6);
+    EXPECT_EQ(pin.find_first_not_of(s_NumbersChars), std::string::npos);
+    EXPECT_EQ(word.length(), 20);
+    EXPECT_EQ(word.find_first_not_of(s_LowerCaseChars), std::string::npos);
+    EXPECT_TRUE(registry.VerifyPasswordSafe("digits", password, hash));
+}
+
+TEST_F(TenantRegistryTests, UnknownAndInvalidTenantsAreRejected)
+{
+    // given:
+    registry.SetTenantPolicy("a", PasswordPolicy{8});
+
+    // when/then:
+    EXPECT_THROW((void)registry.GenerateAdvancedPassword("b"), std::out_of_range);
+    EXPECT_EQ(registry.Find("b"), nullptr);
+    EXPECT_THROW(registry.SetTenantPolicy("empty", PasswordPolicy{8, false, false, false, false}), std::invalid_argument);
+    EXPECT_THROW(registry.SetTenantPolicies({ { "ok", PasswordPolicy{8} }, { "empty", PasswordPolicy{8, false, false, false, false} } }),
+                 std::invalid_argument);
+    EXPECT_EQ(registry.TenantCount(), 1); // nothing of the failed batch was published
+    EXPECT_TRUE(registry.RemoveTenant("a"));
+    EXPECT_FALSE(registry.RemoveTenant("a"));
+    EXPECT_EQ(registry.TenantCount(), 0);
+}
+
+TEST_F(TenantRegistryTests, ReadersSeeConsistentPoliciesDuringUpdates)
+{
+    // given: the tenant flips between two lengths while readers generate
+    registry.SetTenantPolicy("flip", PasswordPolicy{8});
+    std::atomic<bool> done = false;
+    std::atomic<int> badLengths = 0;
+
+    // when:
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; r++)
+    {
+        readers.emplace_back([&]() {
+            while (!done)
+            {
+                const size_t length = registry.GenerateAdvancedPassword("flip").length();
+                if (length != 8 && length != 16)
+                    badLengths++;
+            }
+        });
+    }
+    for (int i = 0; i < 500; i++)
+    {
+        registry.SetTenantPolicy("flip", PasswordPolicy{i % 2 == 0 ? 16u : 8u});
+        registry.SetTenantPolicy("other" + std::to_string(i), PasswordPolicy{4});
+    }
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    // then:
+    EXPECT_EQ(badLengths, 0);
+    EXPECT_EQ(registry.TenantCount(), 501);
+}
+
+TEST_F(TenantRegistryTests, MoreReadersThanSlotsShareThemDuringUpdates)
+{
+    // given: more threads than the registry has reader slots
+    registry.SetTenantPolicy("shared", PasswordPolicy{12});
+    std::atomic<bool> done = false;
+    std::atomic<int> failures = 0;
+
+    // when:
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 160; r++)
+    {
+        readers.emplace_back([&]() {
+            for (int i = 0; i < 50 || !done; i++)
+            {
+                if (registry.GenerateAdvancedPassword("shared").length() != 12 || !registry.Find("shared"))
+                    failures++;
+            }
+        });
+    }
+    for (int i = 0; i < 200; i++)
+        registry.SetTenantPolicy("churn" + std::to_string(i % 10), PasswordPolicy{6});
+    done = true;
+    for (auto& reader : readers)
+        reader.join();
+
+    // then:
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(registry.TenantCount(), 11);
+}
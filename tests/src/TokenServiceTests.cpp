@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include <TokenService.h>
+
+using namespace Generator;
+
+class TokenServiceTests : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST_F(TokenServiceTests, GeneratesDistinctUrlSafeTokens)
+{
+    // given:
+    const TokenService service(TokenService::GeneratePepper());
+
+    // when:
+    const std::vector<std::string> tokens = service.GenerateTokens(1000);
+
+    // then:
+    ASSERT_EQ(tokens.size(), 1000);
+    EXPECT_EQ(std::set<std::string>(tokens.begin(), tokens.end()).size(), tokens.size()) << "Duplicate token";
+    for (const std::string& token : tokens)
+    {
+        ASSERT_EQ(token.size(), TokenService::s_TokenLength);
+        EXPECT_EQ(token.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"), std::string::npos) << token;
+    }
+}
+
+TEST_F(TokenServiceTests, DigestIsKeyedBlake2b)
+{
+    // given:
+    const std::vector<uint8_t> pepper = TokenService::GeneratePepper();
+    const TokenService service(pepper);
+    const std::string token = service.GenerateToken();
+    TokenDigest expected;
+    crypto_generichash(expected.data(), expected.size(), (const unsigned char*)token.data(), token.size(), pepper.data(), pepper.size());
+
+    // when:
+    const TokenDigest digest = service.HashToken(token);
+
+    // then:
+    EXPECT_EQ(digest, expected);
+    EXPECT_EQ(service.HashToken(token), digest) << "Reused keyed state changed the digest";
+    EXPECT_NE(TokenService(TokenService::GeneratePepper()).HashToken(token), digest) << "Pepper didn't change the digest";
+}
+
+TEST_F(TokenServiceTests, VerifiesOnlyTheMatchingToken)
+{
+    // given:
+    const TokenService service(TokenService::GeneratePepper());
+    std::vector<std::string> tokens = service.GenerateTokens(4);
+    const std::vector<TokenDigest> digests = service.HashTokens(tokens);
+    tokens[2][0] = tokens[2][0] == 'A' ? 'B' : 'A';
+
+    // when:
+    const std::vector<bool> verified = service.VerifyTokens(tokens, digests);
+
+    // then:
+    EXPECT_EQ(verified, (std::vector<bool>{true, true, false, true}));
+    EXPECT_FALSE(service.VerifyToken(tokens[0], digests[1]));
+    EXPECT_THROW((void)service.VerifyTokens(tokens, {}), std::invalid_argument);
+}
+
+TEST_F(TokenServiceTests, RejectsShortPepper)
+{
+    // given:
+    const std::vector<uint8_t> pepper(crypto_generichash_KEYBYTES_MIN - 1, 7);
+
+    // when/then:
+    EXPECT_THROW(TokenService{pepper}, std::invalid_argument);
+}
@@ -0,0 +1,144 @@
+#include <gtest/gtest.h>
+
+#include <Generator.h>
+#include <Trace.h>
+
+#include <sstream>
+#include <thread>
+
+using namespace Generator;
+
+class TraceTests : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+        Trace::Clear();
+    }
+    void TearDown() override
+    {
+        Trace::Disable();
+        Trace::Clear();
+    }
+
+    static size_t Count(const std::string& text, const std::string& needle)
+    {
+        size_t count = 0;
+        for (size_t at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1))
+            count++;
+        return count;
+    }
+};
+
+TEST_F(TraceTests, NothingIsRecordedWhileDisabled)
+{
+    // given:
+    const PasswordGenerator generator(PasswordPolicy{12});
+
+    // when:
+    (void)generator.GenerateAdvancedPassword();
+    std::ostringstream trace;
+    const size_t events = Trace::WriteChromeTrace(trace);
+
+    // then:
+    EXPECT_EQ(events, 0);
+    EXPECT_NE(trace.str().find("\"traceEvents\":["), std::string::npos);
+}
+
+TEST_F(TraceTests, LibraryOperationsShowUpAsSpans)
+{
+    // given:
+    const PasswordGenerator generator(PasswordPolicy{12});
+    Trace::Enable();
+
+    // when:
+    const std::string hash = generator.HashPasswordSafe(generator.GenerateAdvancedPassword());
+    (void)generator.VerifyPassword("momolleh", hash);
+    std::ostringstream trace;
+    const size_t events = Trace::WriteChromeTrace(trace);
+
+    // then:
+    EXPECT_EQ(events, 4);
+    const std::string json = trace.str();
+    EXPECT_EQ(Count(json, "\"ph\":\"X\""), 4);
+    EXPECT_EQ(Count(json, "\"name\":\"GenerateAdvancedPassword\",\"cat\":\"generate\""), 1);
+    EXPECT_EQ(Count(json, "\"name\":\"sodium_mlock\",\"cat\":\"memory\""), 1);
+    EXPECT_EQ(Count(json, "\"name\":\"HashPassword\",\"cat\":\"hash\""), 1);
+    EXPECT_EQ(Count(json, "\"name\":\"VerifyPassword\",\"cat\":\"verify\""), 1);
+}
+
+TEST_F(TraceTests, ThreadsGetTheirOwnTracks)
+{
+    // given:
+    Trace::Enable();
+    { const Trace::Span span("test", "main"); }
+
+    // when:
+    std::thread([]()
+    {
+        Trace::SetThreadName("worker \"1\"");
+        for (int i = 0; i < 3; i++)
+            const Trace::Span span("test", "worker");
+    }).join();
+    std::ostringstream trace;
+    const size_t events = Trace::WriteChromeTrace(trace);
+
+    // then: the exited thread's events are kept, and its name is escaped
+    EXPECT_EQ(events, 4);
+    const std::string json = trace.str();
+    EXPECT_EQ(Count(json, "\"name\":\"worker\""), 3);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"worker \\\"1\\\"\"}"), std::string::npos);
+}
+
+TEST_F(TraceTests, FullBufferKeepsTheNewestEvents)
+{
+    // given: a fresh thread, so its buffer gets the small size
+    Trace::Enable(8);
+    std::ostringstream trace;
+
+    // when:
+    std::thread([]()
+    {
+        for (int i = 0; i < 20; i++)
+            const Trace::Span span("test", i < 12 ? "old" : "new");
+    }).join();
+    const size_t events = Trace::WriteChromeTrace(trace);
+    Trace::Enable();
+
+    // then:
+    EXPECT_EQ(events, 8);
+    EXPECT_EQ(Count(trace.str(), "\"name\":\"new\""), 8);
+    EXPECT_THROW(Trace::Enable(0), std::invalid_argument);
+}
+
+TEST_F(TraceTests, ExitedThreadsPassTheirBufferOn)
+{
+    // given: a thread that exits after recording into a buffer of 4
+    Trace::Enable(4);
+    std::ostringstream trace;
+    std::thread([]()
+    {
+        Trace::SetThreadName("first");
+        for (int i = 0; i < 2; i++)
+            const Trace::Span span("test", "first");
+    }).join();
+
+    // when: the next thread takes its buffer over
+    std::thread([]()
+    {
+        for (int i = 0; i < 3; i++)
+            const Trace::Span span("test", "second");
+    }).join();
+    const size_t events = Trace::WriteChromeTrace(trace);
+    Trace::Enable();
+
+    // then: one buffer between them, and the first thread's surviving event keeps its own track and name
+    EXPECT_EQ(events, 4);
+    const std::string json = trace.str();
+    EXPECT_EQ(Count(json, "\"name\":\"first\",\"cat\""), 1);
+    EXPECT_EQ(Count(json, "\"name\":\"second\""), 3);
+    EXPECT_EQ(Count(json, "\"tid\":"), 5);
+    EXPECT_NE(json.find("\"args\":{\"name\":\"first\"}"), std::string::npos);
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <CompiledPolicy.h>
+#include <Generator.h>
+#include <UniqueSet.h>
+
+#include <cmath>
+#include <set>
+
+using namespace Generator;
+
+class UniqueGenerationTests : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+};
+
+TEST_F(UniqueGenerationTests, ExhaustingTheSpaceYieldsEveryCodeOnce)
+{
+    // given: 3-digit codes, exactly 1000 of them exist
+    const PasswordGenerator generator(PasswordPolicy{3, false, false, true, false});
+
+    // when:
+    const auto codes = generator.GenerateUniqueAdvancedPasswords(1000);
+
+    // then:
+    const std::set<std::string> distinct(codes.begin(), codes.end());
+    EXPECT_EQ(codes.size(), 1000);
+    EXPECT_EQ(distinct.size(), 1000);
+    for (const auto& code : codes)
+    {
+        EXPECT_EQ(code.length(), 3);
+        EXPECT_EQ(code.find_first_not_of(s_NumbersChars), std::string::npos);
+    }
+}
+
+TEST_F(UniqueGenerationTests, RequestingMoreThanThePolicyCanProduceThrows)
+{
+    // given:
+    const PasswordGenerator generator(PasswordPolicy{3, false, false, true, false});
+
+    // when/then:
+    EXPECT_THROW((void)generator.GenerateUniqueAdvancedPasswords(1001), std::invalid_argument);
+}
+
+TEST_F(UniqueGenerationTests, ClassRulesCountTowardsTheSpace)
+{
+    // given: 4 characters from a-z0-9, but every one of them a digit, so 10^4 passwords exist rather than 36^4
+    PasswordPolicy policy{4, true, false, true, false};
+    policy.classRules[(size_t)CharacterClass::Numbers].minCount = 4;
+    const PasswordGenerator generator(policy);
+
+    // when:
+    const auto codes = generator.GenerateUniqueAdvancedPasswords(10000);
+
+    // then:
+    EXPECT_EQ(std::set<std::string>(codes.begin(), codes.end()).size(), 10000);
+    EXPECT_THROW((void)generator.GenerateUniqueAdvancedPasswords(10001), std::invalid_argument);
+}
+
+TEST_F(UniqueGenerationTests, DistinctBitsCountEveryClassMix)
+{
+    // given: exactly one digit among four characters: 4 positions * 10 digits * 26^3 lowercase fillings
+    PasswordPolicy policy{4, true, false, true, false};
+    policy.classRules[(size_t)CharacterClass::Numbers] = CharacterClassRule{0, 1, 1};
+    const PasswordGenerator generator(policy);
+
+    // when:
+    const double bits = generator.GetCompiledPolicy()->DistinctAdvancedBits();
+
+    // then:
+    EXPECT_NEAR(bits, std::log2(4.0 * 10 * 26 * 26 * 26), 1e-9);
+}
+
+TEST_F(UniqueGenerationTests, PackedOutputIsDistinctAndRespectsExclusions)
+{
+    // given:
+    const PasswordGenerator generator(PasswordPolicy{4, true, false, false, false, "aeiou"});
+    constexpr size_t count = 20000;
+    std::vector<char> packed(count * 4);
+
+    // when:
+    generator.GenerateUniqueAdvancedPasswordsInto(packed.data(), count);
+
+    // then:
+    std::set<std::string> distinct;
+    for (size_t i = 0; i < count; i++)
+        distinct.emplace(packed.data() + i * 4, 4);
+    EXPECT_EQ(distinct.size(), count);
+    EXPECT_EQ(std::string(packed.begin(), packed.end()).find_first_of("aeiou"), std::string::npos);
+}
+
+TEST_F(UniqueGenerationTests, SetRejectsEqualRecordsOnly)
+{
+    // given:
+    const std::string records = "abcdabcdabce";
+    FixedLengthUniqueSet set(records.data(), 4, 3);
+
+    // when/then:
+    EXPECT_TRUE(set.Insert(0));
+    EXPECT_FALSE(set.Insert(1));
+    EXPECT_TRUE(set.Insert(2));
+    EXPECT_EQ(set.Size(), 2);
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+
+#include <Generator.h>
+#include <WeightedAlphabet.h>
+
+using namespace Generator;
+
+class WeightedPolicyTests : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        if (sodium_init() < 0)
+            throw std::runtime_error("Failed to initialize libsodium");
+    }
+
+    static std::array<size_t, 4> CountClasses(const std::string& password)
+    {
+        std::array<size_t, 4> counts{};
+        for (const char c : password)
+            counts[(size_t)WeightedAlphabet::ClassOf(c)]++;
+        return counts;
+    }
+};
+
+TEST_F(WeightedPolicyTests, ClassWeightsSetTheShareOfEachClass)
+{
+    // given: letters 9 parts, symbols 1 part
+    PasswordPolicy policy{20, true, false, false, true};
+    policy.GetClassRule(CharacterClass::Lowercase).weight = 9;
+    policy.GetClassRule(CharacterClass::Symbols).weight = 1;
+    const PasswordGenerator generator(policy);
+
+    // when:
+    std::array<size_t, 4> totals{};
+    for (int i = 0; i < 2000; i++)
+    {
+        const auto counts = CountClasses(generator.GenerateAdvancedPassword());
+        for (size_t k = 0; k < 4; k++)
+            totals[k] += counts[k];
+    }
+
+    // then: 40000 characters, ~10% symbols
+    EXPECT_NEAR((double)totals[(size_t)CharacterClass::Symbols] / 40000.0, 0.1, 0.01);
+    EXPECT_EQ(totals[(size_t)CharacterClass::Uppercase], 0);
+}
+
+TEST_F(WeightedPolicyTests, MinAndMaxCountsHoldInEveryPassword)
+{
+    // given:
+    PasswordPolicy policy{12};
+    policy.GetClassRule(CharacterClass::Symbols).maxCount = 2;
+    policy.GetClassRule(CharacterClass::Numbers).minCount = 3;
+    policy.GetClassRule(CharacterClass::Uppercase).minCount = 1;
+    const PasswordGenerator generator(policy);
+
+    // when/then:
+    for (int i = 0; i < 1000; i++)
+    {
+        const std::string password = generator.GenerateAdvancedPassword();
+        const auto counts = CountClasses(password);
+        EXPECT_EQ(password.length(), 12);
+        EXPECT_LE(counts[(size_t)CharacterClass::Symbols], 2);
+        EXPECT_GE(counts[(size_t)CharacterClass::Numbers], 3);
+        EXPECT_GE(counts[(size_t)CharacterClass::Uppercase], 1);
+    }
+}
+
+TEST_F(WeightedPolicyTests, CharacterWeightsAndZeroWeightsApply)
+{
+    // given: digits only, '7' never, '0' ten times as likely as the rest
+    PasswordPolicy policy{10, false, false, true, false};
+    policy.characterWeights = { { '7', 0 }, { '0', 10 } };
+    const PasswordGenerator generator(policy);
+
+    // when:
+    size_t zeros = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        const std::string password = generator.GenerateAdvancedPassword();
+        EXPECT_EQ(password.find('7'), std::string::npos);
+        zeros += (size_t)std::count(password.begin(), password.end(), '0');
+    }
+
+    // then: P('0') = 10/18
+    EXPECT_NEAR((double)zeros / 10000.0, 10.0 / 18.0, 0.03);
+}
+
+TEST_F(WeightedPolicyTests, ContradictoryRulesThrowUpFront)
+{
+    PasswordPolicy tooManyMins{4};
+    tooManyMins.GetClassRule(CharacterClass::Numbers).minCount = 3;
+    tooManyMins.GetClassRule(CharacterClass::Symbols).minCount = 2;
+    EXPECT_THROW(PasswordGenerator{tooManyMins}, std::invalid_argument);
+
+    PasswordPolicy cappedEverywhere{10, false, false, true, true};
+    cappedEverywhere.GetClassRule(CharacterClass::Numbers).maxCount = 4;
+    cappedEverywhere.GetClassRule(CharacterClass::Symbols).maxCount = 4;
+    EXPECT_THROW(PasswordGenerator{cappedEverywhere}, std::invalid_argument);
+
+    PasswordPolicy disabledMin{10, true, false, true, true};
+    disabledMin.GetClassRule(CharacterClass::Uppercase).minCount = 1;
+    PasswordGenerator generator(PasswordPolicy{10});
+    EXPECT_THROW(generator.SetPolicy(disabledMin), std::invalid_argument);
+    EXPECT_EQ(generator.GetPolicy().passwordLength, 10); // the old policy stays
+}
@@ -0,0 +1,39 @@
+#include <gtest/gtest.h>
+
+#include <WireFormat.h>
+
+using namespace Generator;
+
+TEST(WireFormatTests, FieldsRoundTrip)
+{
+    // given:
+    Wire::Writer writer;
+    writer.U8(7);
+    writer.U64(0x0123456789abcdefull);
+    writer.String("<PASSWORD1?2.3!4@hello>");
+
+    // when:
+    const auto& frame = writer.Finish();
+    uint32_t payloadBytes = 0;
+    std::memcpy(&payloadBytes, frame.data(), sizeof(payloadBytes));
+    Wire::Reader reader(frame.data() + Wire::FrameHeaderBytes, frame.size() - Wire::FrameHeaderBytes);
+
+    // then:
+    EXPECT_EQ(payloadBytes, frame.size() - Wire::FrameHeaderBytes);
+    EXPECT_EQ(reader.U8(), 7);
+    EXPECT_EQ(reader.U64(), 0x0123456789abcdefull);
+    EXPECT_EQ(reader.String(), "<PASSWORD1?2.3!4@hello>");
+    EXPECT_TRUE(reader.AtEnd());
+}
+
+TEST(WireFormatTests, TruncatedPayloadThrows)
+{
+    // given:
+    const std::vector<uint8_t> payload = { 10, 0, 0, 0, 'a', 'b' }; // claims a 10 byte string, holds 2
+
+    // when:
+    Wire::Reader reader(payload);
+
+    // then:
+    EXPECT_THROW(reader.String(), std::runtime_error);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+
+#include <WorkerPlacement.h>
+
+#include <filesystem>
+#include <fstream>
+
+using namespace Generator;
+
+namespace
+{
+    void WriteFile(const std::filesystem::path& path, const std::string& contents)
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream(path) << contents << "\n";
+    }
+
+    /// Two NUMA nodes with two cores each, every core with two hardware threads.
+    std::filesystem::path MakeFakeSysfs()
+    {
+        const auto root = std::filesystem::temp_directory_path() / "passwordgen-fake-sysfs";
+        std::filesystem::remove_all(root);
+        WriteFile(root / "devices/system/cpu/online", "0-7");
+        WriteFile(root / "devices/system/node/node0/cpulist", "0-3");
+        WriteFile(root / "devices/system/node/node1/cpulist", "4-7");
+        const char* siblings[] = { "0,2", "1,3", "0,2", "1,3", "4,6", "5,7", "4,6", "5,7" };
+        for (int cpu = 0; cpu < 8; cpu++)
+            WriteFile(root / "devices/system/cpu" / ("cpu" + std::to_string(cpu)) / "topology/thread_siblings_list", siblings[cpu]);
+        return root;
+    }
+}
+
+TEST(WorkerPlacementTests, ParsesSysfsCpuLists)
+{
+    EXPECT_EQ(ParseCpuList("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_TRUE(ParseCpuList("").empty());
+}
+
+TEST(WorkerPlacementTests, DetectsNodesAndSiblingsFromSysfs)
+{
+    // given:
+    const auto root = MakeFakeSysfs();
+
+    // when:
+    const CpuTopology topology = CpuTopology::Detect(root.string());
+
+    // then:
+    EXPECT_EQ(topology.nodeCount, 2);
+    EXPECT_EQ(topology.cpus.size(), 8);
+    EXPECT_EQ(topology.PhysicalCores(), 4);
+    std::filesystem::remove_all(root);
+}
+
+TEST(WorkerPlacementTests, SpreadsWorkersAcrossNodesAndCoresBeforeSiblings)
+{
+    // given:
+    const auto root = MakeFakeSysfs();
+    const WorkerPlacement placement(CpuTopology::Detect(root.string()));
+
+    // when:
+    std::vector<int> cpus;
+    for (unsigned worker = 0; worker < 8; worker++)
+        cpus.push_back(placement.CpuForWorker(worker));
+
+    // then:
+    EXPECT_EQ(cpus, (std::vector<int>{0, 4, 1, 5, 2, 6, 3, 7}));
+    EXPECT_EQ(placement.NodeForWorker(1), 1);
+    EXPECT_EQ(placement.CpuForWorker(8), 0) << "Placement should wrap around";
+    std::filesystem::remove_all(root);
+}
+
+TEST(WorkerPlacementTests, PinnedHashingMatchesPolicy)
+{
+    // given:
+    if (sodium_init() < 0)
+        throw std::runtime_error("Failed to initialize libsodium");
+    const PasswordGenerator passwordGenerator(PasswordPolicy{10, true, true, true, true, "", EncryptionStrength::Low});
+    const std::vector<std::string> passwords = { "<PASSWORD1?2.3!4@hello>", "saidjsad2813", "momolleh" };
+    const WorkerPlacement placement;
+
+    // when:
+    const auto hashes = placement.HashPasswordsSafe(passwordGenerator, passwords, 2);
+
+    // then:
+    ASSERT_EQ(hashes.size(), passwords.size());
+    for (size_t i = 0; i < passwords.size(); i++)
+    {
+        EXPECT_TRUE(passwordGenerator.VerifyPassword(passwords[i], hashes[i])) << "Password hash verification failed";
+    }
+}
+
+TEST(WorkerPlacementTests, CalibrationRethrowsHashingErrors)
+{
+    // given: a cost libsodium's argon2 refuses
+    if (sodium_init() < 0)
+        throw std::runtime_error("Failed to initialize libsodium");
+    PasswordPolicy policy{10, true, true, true, true, "", EncryptionStrength::Low};
+    policy.hashCost = HashCost{1, 8192, 2};
+    const PasswordGenerator passwordGenerator(policy);
+    const WorkerPlacement placement;
+
+    // when/then:
+    EXPECT_THROW((void)placement.CalibrateWorkers(passwordGenerator, 2, std::chrono::milliseconds(200)), std::invalid_argument);
+}